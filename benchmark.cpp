@@ -0,0 +1,1441 @@
+#include "inplace_string.h"
+#include "inplace_flat_map.h"
+#include "inplace_string_interner.h"
+#include "inplace_string_column.h"
+#include "inplace_string_algorithm.h"
+#include "inplace_stringbuf.h"
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <unordered_set>
+#include <unordered_map>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <memory>
+#include <stdexcept>
+#include <cstdlib>
+
+#if defined _MSC_VER
+#include <stdio.h>
+#else
+#include <stdlib.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+
+template <typename CharT>
+struct char_name;
+
+template <> struct char_name<char>     { static const char* value() { return "char"; } };
+template <> struct char_name<wchar_t>  { static const char* value() { return "wchar_t"; } };
+template <> struct char_name<char16_t> { static const char* value() { return "char16_t"; } };
+template <> struct char_name<char32_t> { static const char* value() { return "char32_t"; } };
+
+// Both implementations are driven through the same benchmark bodies; std_string<N> only carries N
+// so that the fill levels line up with the inplace_string of the same capacity.
+template <std::size_t N, typename CharT>
+struct inplace_impl
+{
+	using string_type = basic_inplace_string<N, CharT>;
+	static constexpr std::size_t capacity = N;
+	static std::string name() { return "inplace_string<" + std::to_string(N) + "," + char_name<CharT>::value() + ">"; }
+};
+
+// Same strings with another storage layout: the size in a 16-bit trailer instead of the last character, as for
+// every N > 255, or no terminator
+template <typename Policy>
+struct policy_name;
+
+template <> struct policy_name<inplace_string_size_trailer_policy> { static const char* value() { return "size_trailer"; } };
+template <> struct policy_name<inplace_string_unterminated_policy> { static const char* value() { return "unterminated"; } };
+
+template <std::size_t N, typename CharT, typename Policy>
+struct inplace_policy_impl
+{
+	using string_type = basic_inplace_string<N, CharT, std::char_traits<CharT>, Policy>;
+	static constexpr std::size_t capacity = N;
+	static std::string name() { return "inplace_string<" + std::to_string(N) + "," + char_name<CharT>::value() + "," + policy_name<Policy>::value() + ">"; }
+};
+
+template <std::size_t N, typename CharT>
+struct std_impl
+{
+	using string_type = std::basic_string<CharT>;
+	static constexpr std::size_t capacity = N;
+	static std::string name() { return "std::string<" + std::to_string(N) + "," + char_name<CharT>::value() + ">"; }
+};
+
+template <typename CharT>
+std::vector<CharT> make_chars(std::size_t count, std::size_t seed = 0)
+{
+	std::vector<CharT> chars(count + 1);
+	for (std::size_t i = 0; i < count; ++i)
+		chars[i] = static_cast<CharT>('a' + (i + seed) % 26);
+	chars[count] = CharT{};
+	return chars;
+}
+
+std::size_t fill_length(std::size_t capacity, const benchmark::State& state)
+{
+	return std::max<std::size_t>(1, capacity * static_cast<std::size_t>(state.range(0)) / 100);
+}
+
+template <typename Impl, typename CharT>
+void construct(benchmark::State& state)
+{
+	const std::size_t len = fill_length(Impl::capacity, state);
+	const auto src = make_chars<CharT>(len);
+
+	for (auto _ : state)
+	{
+		typename Impl::string_type s(src.data(), len);
+		benchmark::DoNotOptimize(s);
+	}
+}
+
+template <typename Impl, typename CharT>
+void copy(benchmark::State& state)
+{
+	const std::size_t len = fill_length(Impl::capacity, state);
+	const auto src = make_chars<CharT>(len);
+	const typename Impl::string_type s(src.data(), len);
+
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(s);
+		typename Impl::string_type copied(s);
+		benchmark::DoNotOptimize(copied);
+	}
+}
+
+template <typename Impl, typename CharT>
+void append(benchmark::State& state)
+{
+	const std::size_t len = fill_length(Impl::capacity, state);
+	const auto src = make_chars<CharT>(len);
+	const std::size_t half = len / 2;
+
+	for (auto _ : state)
+	{
+		typename Impl::string_type s;
+		s.append(src.data(), half);
+		s.append(src.data() + half, len - half);
+		benchmark::DoNotOptimize(s);
+	}
+}
+
+template <typename Impl, typename CharT>
+void insert(benchmark::State& state)
+{
+	const std::size_t len = fill_length(Impl::capacity, state);
+	const auto src = make_chars<CharT>(len);
+	const std::size_t half = len / 2;
+	const typename Impl::string_type base(src.data(), half);
+
+	for (auto _ : state)
+	{
+		typename Impl::string_type s(base);
+		s.insert(half / 2, src.data(), len - half);
+		benchmark::DoNotOptimize(s);
+	}
+}
+
+template <typename Impl, typename CharT>
+void erase(benchmark::State& state)
+{
+	const std::size_t len = fill_length(Impl::capacity, state);
+	const auto src = make_chars<CharT>(len);
+	const typename Impl::string_type base(src.data(), len);
+
+	for (auto _ : state)
+	{
+		typename Impl::string_type s(base);
+		s.erase(len / 4, len / 2);
+		benchmark::DoNotOptimize(s);
+	}
+}
+
+template <typename Impl, typename CharT>
+void replace(benchmark::State& state)
+{
+	const std::size_t len = fill_length(Impl::capacity, state);
+	const auto src = make_chars<CharT>(len, 13);
+	const auto repl = make_chars<CharT>(len / 2);
+	const typename Impl::string_type base(src.data(), len);
+
+	for (auto _ : state)
+	{
+		typename Impl::string_type s(base);
+		s.replace(len / 4, len / 4, repl.data(), len / 2 - len / 4);
+		benchmark::DoNotOptimize(s);
+	}
+}
+
+template <typename Impl, typename CharT>
+void find(benchmark::State& state)
+{
+	const std::size_t len = fill_length(Impl::capacity, state);
+	const auto src = make_chars<CharT>(len);
+	const typename Impl::string_type s(src.data(), len);
+
+	// searching for the trailing characters forces a scan of the whole string
+	const std::size_t needle_size = std::min<std::size_t>(3, len);
+	const CharT* needle = src.data() + len - needle_size;
+
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(s);
+		benchmark::DoNotOptimize(s.find(needle, 0, needle_size));
+	}
+}
+
+template <typename Impl, typename CharT>
+void find_char(benchmark::State& state)
+{
+	const std::size_t len = fill_length(Impl::capacity, state);
+	const auto src = make_chars<CharT>(len);
+	const typename Impl::string_type s(src.data(), len);
+	const CharT ch = src[len - 1];
+
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(s);
+		benchmark::DoNotOptimize(s.find(ch));
+	}
+}
+
+template <typename Impl, typename CharT>
+void find_first_of(benchmark::State& state)
+{
+	const std::size_t len = fill_length(Impl::capacity, state);
+	auto src = make_chars<CharT>(len);
+	src[len - 1] = static_cast<CharT>(';');
+	const typename Impl::string_type s(src.data(), len);
+	const CharT delimiters[] = {' ', ',', ';', '|'};
+
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(s);
+		benchmark::DoNotOptimize(s.find_first_of(delimiters, 0, 4));
+	}
+}
+
+template <typename Impl, typename CharT>
+void compare(benchmark::State& state)
+{
+	const std::size_t len = fill_length(Impl::capacity, state);
+	auto src = make_chars<CharT>(len);
+	const typename Impl::string_type lhs(src.data(), len);
+	src[len - 1] = static_cast<CharT>('z' + 1);
+	const typename Impl::string_type rhs(src.data(), len);
+
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(lhs);
+		benchmark::DoNotOptimize(lhs.compare(rhs));
+	}
+}
+
+template <typename Impl, typename CharT>
+void hash(benchmark::State& state)
+{
+	const std::size_t len = fill_length(Impl::capacity, state);
+	const auto src = make_chars<CharT>(len);
+	const typename Impl::string_type s(src.data(), len);
+	const std::hash<typename Impl::string_type> hasher;
+
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(s);
+		benchmark::DoNotOptimize(hasher(s));
+	}
+}
+
+template <typename Impl, typename CharT>
+void substr(benchmark::State& state)
+{
+	const std::size_t len = fill_length(Impl::capacity, state);
+	const auto src = make_chars<CharT>(len);
+	const typename Impl::string_type s(src.data(), len);
+
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(s);
+		auto sub = s.substr(len / 4, len / 2);
+		benchmark::DoNotOptimize(sub);
+	}
+}
+
+template <typename Impl, typename CharT>
+void register_impl()
+{
+	using function = void (*)(benchmark::State&);
+	const std::pair<const char*, function> operations[] =
+	{
+		{"construct", &construct<Impl, CharT>},
+		{"copy",      &copy<Impl, CharT>},
+		{"append",    &append<Impl, CharT>},
+		{"insert",    &insert<Impl, CharT>},
+		{"erase",     &erase<Impl, CharT>},
+		{"replace",   &replace<Impl, CharT>},
+		{"find",      &find<Impl, CharT>},
+		{"find_char", &find_char<Impl, CharT>},
+		{"find_first_of", &find_first_of<Impl, CharT>},
+		{"compare",   &compare<Impl, CharT>},
+		{"hash",      &hash<Impl, CharT>},
+		{"substr",    &substr<Impl, CharT>}
+	};
+
+	for (const auto& op : operations)
+	{
+		const std::string name = std::string(op.first) + "/" + Impl::name();
+		benchmark::RegisterBenchmark(name.c_str(), op.second)->ArgName("fill%")->Arg(25)->Arg(50)->Arg(100);
+	}
+}
+
+template <std::size_t N, typename CharT>
+void register_capacity()
+{
+	register_impl<inplace_impl<N, CharT>, CharT>();
+	register_impl<std_impl<N, CharT>, CharT>();
+}
+
+template <typename CharT>
+void register_char_type()
+{
+	register_capacity<15, CharT>();
+	register_capacity<31, CharT>();
+	register_capacity<63, CharT>();
+	register_capacity<255, CharT>();
+}
+
+// Padded fields: the first character of the needle matches almost everywhere, which is the worst case
+// for a search driven by the first character only.
+template <typename String>
+void find_padded(benchmark::State& state)
+{
+	using char_type = typename String::value_type;
+
+	const std::size_t len = static_cast<std::size_t>(state.range(0));
+	std::vector<char_type> src(len, static_cast<char_type>(' '));
+	src[len - 1] = static_cast<char_type>('X');
+	const String s(src.data(), len);
+
+	const char_type needle[] = {' ', ' ', ' ', 'X'};
+
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(s);
+		benchmark::DoNotOptimize(s.find(needle, 0, 4));
+	}
+}
+
+template <typename String>
+void find_short(benchmark::State& state)
+{
+	using char_type = typename String::value_type;
+
+	const std::size_t len = static_cast<std::size_t>(state.range(0));
+	const auto src = make_chars<char_type>(len);
+	const String s(src.data(), len);
+	const auto needle = make_chars<char_type>(2, len - 2);
+
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(s);
+		benchmark::DoNotOptimize(s.find(needle.data(), 0, 2));
+	}
+}
+
+template <typename CharT>
+void register_search()
+{
+	const std::string suffix = std::string("<") + char_name<CharT>::value() + ">";
+
+	benchmark::RegisterBenchmark(("find_padded/inplace_string" + suffix).c_str(), &find_padded<basic_inplace_string<255, CharT>>)
+		->ArgName("size")->Arg(15)->Arg(31)->Arg(63)->Arg(255);
+	benchmark::RegisterBenchmark(("find_padded/std::string" + suffix).c_str(), &find_padded<std::basic_string<CharT>>)
+		->ArgName("size")->Arg(15)->Arg(31)->Arg(63)->Arg(255);
+	benchmark::RegisterBenchmark(("find_short/inplace_string" + suffix).c_str(), &find_short<basic_inplace_string<255, CharT>>)
+		->ArgName("size")->Arg(8)->Arg(15)->Arg(23)->Arg(31);
+	benchmark::RegisterBenchmark(("find_short/std::string" + suffix).c_str(), &find_short<std::basic_string<CharT>>)
+		->ArgName("size")->Arg(8)->Arg(15)->Arg(23)->Arg(31);
+}
+
+std::vector<inplace_string<63>> make_records(std::size_t count)
+{
+	std::vector<inplace_string<63>> records;
+	records.reserve(count);
+
+	unsigned state = 1;
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		inplace_string<63> record;
+		const std::size_t size = 32 + i % 32;
+		for (std::size_t j = 0; j < size; ++j)
+		{
+			state = state * 1103515245u + 12345u;
+			record.push_back(static_cast<char>('a' + (state >> 16) % 26));
+		}
+		records.push_back(record);
+	}
+
+	return records;
+}
+
+const char* grep_pattern(const benchmark::State& state)
+{
+	return state.range(0) == 0 ? "abcdef" : "abcdefabcdefgh";
+}
+
+void grep_find(benchmark::State& state)
+{
+	const auto records = make_records(4096);
+	const char* pattern = grep_pattern(state);
+
+	for (auto _ : state)
+	{
+		std::size_t matches = 0;
+		for (const auto& record : records)
+			matches += record.find(pattern) != inplace_string<63>::npos;
+		benchmark::DoNotOptimize(matches);
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * records.size()));
+}
+
+void grep_searcher(benchmark::State& state)
+{
+	const auto records = make_records(4096);
+	const inplace_string_searcher searcher(grep_pattern(state));
+
+	for (auto _ : state)
+	{
+		std::size_t matches = 0;
+		for (const auto& record : records)
+			matches += searcher.contains(record);
+		benchmark::DoNotOptimize(matches);
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * records.size()));
+}
+
+// Keys shaped like the ones of our maps: ticker symbols, and sequential identifiers differing in a few
+// characters only.
+template <typename String>
+std::vector<String> make_keys(std::size_t count, bool sequential)
+{
+	std::vector<String> keys;
+	keys.reserve(count);
+
+	unsigned state = 1;
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		String key;
+		if (sequential)
+		{
+			const std::string id = "ORDER-" + std::to_string(100000 + i);
+			key.append(id.data(), std::min(id.size(), String::max_size()));
+		}
+		else
+		{
+			const std::size_t size = 3 + i % 6;
+			for (std::size_t j = 0; j < size; ++j)
+			{
+				state = state * 1103515245u + 12345u;
+				key.push_back(static_cast<char>('A' + (state >> 16) % 26));
+			}
+		}
+		keys.push_back(key);
+	}
+
+	return keys;
+}
+
+struct string_view_hash
+{
+	template <typename String>
+	std::size_t operator()(const String& str) const
+	{
+		using view = basic_string_view<typename String::value_type, typename String::traits_type>;
+		return std::hash<view>()(view(str.data(), str.size()));
+	}
+};
+
+// Throughput over a set of keys, plus the collisions of an open addressing table at a load factor of 1/2,
+// indexed by the low bits and by the high bits of the hash. "ideal" is the expected count for a random hash.
+template <typename String, typename Hash>
+void hash_keys(benchmark::State& state)
+{
+	const auto keys = make_keys<String>(4096, state.range(0) != 0);
+	const Hash hasher;
+
+	for (auto _ : state)
+	{
+		std::size_t acc = 0;
+		for (const auto& key : keys)
+			acc += hasher(key);
+		benchmark::DoNotOptimize(acc);
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * keys.size()));
+
+	const std::size_t bucket_bits = 13;
+	const std::size_t buckets = std::size_t{1} << bucket_bits;
+	std::vector<bool> low(buckets), high(buckets);
+	std::size_t low_collisions = 0, high_collisions = 0;
+	for (const auto& key : keys)
+	{
+		const std::uint64_t h = hasher(key);
+		const std::size_t l = static_cast<std::size_t>(h & (buckets - 1));
+		const std::size_t u = static_cast<std::size_t>(h >> (64 - bucket_bits));
+		low_collisions += low[l];
+		high_collisions += high[u];
+		low[l] = true;
+		high[u] = true;
+	}
+
+	const double n = static_cast<double>(keys.size()), m = static_cast<double>(buckets);
+	state.counters["low_bits_collisions"] = static_cast<double>(low_collisions);
+	state.counters["high_bits_collisions"] = static_cast<double>(high_collisions);
+	state.counters["ideal"] = n - m * (1.0 - std::pow(1.0 - 1.0 / m, n));
+}
+
+template <std::size_t N>
+void register_hash()
+{
+	using string_type = inplace_string<N>;
+	const std::string suffix = "<" + std::to_string(N) + ">";
+
+	benchmark::RegisterBenchmark(("hash_keys/std::hash<inplace_string" + suffix + ">").c_str(), &hash_keys<string_type, std::hash<string_type>>)
+		->ArgName("sequential")->Arg(0)->Arg(1);
+	benchmark::RegisterBenchmark(("hash_keys/std::hash<string_view>" + suffix).c_str(), &hash_keys<string_type, string_view_hash>)
+		->ArgName("sequential")->Arg(0)->Arg(1);
+	benchmark::RegisterBenchmark(("hash_keys/std::hash<zero_padded_inplace_string" + suffix + ">").c_str(), &hash_keys<zero_padded_inplace_string<N>, std::hash<zero_padded_inplace_string<N>>>)
+		->ArgName("sequential")->Arg(0)->Arg(1);
+}
+
+// Routing hot path: the same key objects are looked up again and again in several maps.
+template <typename String>
+void lookup_stable_keys(benchmark::State& state)
+{
+	const auto keys = make_keys<String>(1024, false);
+	const std::unordered_set<String> first(keys.begin(), keys.end());
+	const std::unordered_set<String> second(keys.begin(), keys.end());
+
+	for (auto _ : state)
+	{
+		std::size_t found = 0;
+		for (const auto& key : keys)
+			found += first.count(key) + second.count(key);
+		benchmark::DoNotOptimize(found);
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * keys.size() * 2));
+}
+
+struct std_sort
+{
+	template <typename It>
+	void operator()(It first, It last) const { std::sort(first, last); }
+};
+
+struct radix_sort
+{
+	template <typename It>
+	void operator()(It first, It last) const { inplace_string_sort(first, last); }
+};
+
+struct stable_radix_sort
+{
+	template <typename It>
+	void operator()(It first, It last) const { inplace_string_stable_sort(first, last); }
+};
+
+// Ticker symbols of 1 to 7 characters; the copy of the unsorted keys is part of the timing.
+template <typename String, typename Sort = std_sort>
+void sort_tickers(benchmark::State& state)
+{
+	const std::size_t count = static_cast<std::size_t>(state.range(0));
+	std::vector<String> tickers;
+	tickers.reserve(count);
+
+	unsigned seed = 1;
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		String ticker;
+		const std::size_t size = 1 + i % 7;
+		for (std::size_t j = 0; j < size; ++j)
+		{
+			seed = seed * 1103515245u + 12345u;
+			ticker.push_back(static_cast<char>('A' + (seed >> 16) % 26));
+		}
+		tickers.push_back(ticker);
+	}
+
+	for (auto _ : state)
+	{
+		std::vector<String> sorted = tickers;
+		Sort()(sorted.begin(), sorted.end());
+		benchmark::DoNotOptimize(sorted.data());
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * count));
+}
+
+// Order ids sharing a prefix, shuffled
+template <typename String, typename Sort>
+void sort_order_ids(benchmark::State& state)
+{
+	auto ids = make_keys<String>(static_cast<std::size_t>(state.range(0)), true);
+	unsigned seed = 1;
+	for (std::size_t i = ids.size(); i > 1; --i)
+	{
+		seed = seed * 1103515245u + 12345u;
+		std::swap(ids[i - 1], ids[(seed >> 8) % i]);
+	}
+
+	for (auto _ : state)
+	{
+		std::vector<String> sorted = ids;
+		Sort()(sorted.begin(), sorted.end());
+		benchmark::DoNotOptimize(sorted.data());
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * ids.size()));
+}
+
+// End-of-day keys: 4M inplace_string<23> with about 8 copies of every key, sorted, deduplicated and counted on 1 to
+// 64 threads. The copy of the unsorted keys is part of the sort timing.
+std::vector<inplace_string<23>> make_reconciliation_keys()
+{
+	std::vector<inplace_string<23>> keys;
+	const std::size_t count = 1 << 22;
+	keys.reserve(count);
+
+	unsigned seed = 1;
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		seed = seed * 1103515245u + 12345u;
+		keys.push_back(inplace_string<23>("TRADE-" + std::to_string((seed >> 4) % (count / 8))));
+	}
+
+	return keys;
+}
+
+void parallel_sort(benchmark::State& state)
+{
+	const auto keys = make_reconciliation_keys();
+	const unsigned threads = static_cast<unsigned>(state.range(0));
+
+	for (auto _ : state)
+	{
+		auto sorted = keys;
+		inplace_string_parallel_sort(threads, sorted.begin(), sorted.end());
+		benchmark::DoNotOptimize(sorted.data());
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * keys.size()));
+}
+
+void parallel_unique(benchmark::State& state)
+{
+	auto sorted = make_reconciliation_keys();
+	inplace_string_stable_sort(sorted.begin(), sorted.end());
+	const unsigned threads = static_cast<unsigned>(state.range(0));
+
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+		auto keys = sorted;
+		state.ResumeTiming();
+		benchmark::DoNotOptimize(inplace_string_parallel_unique(threads, keys.begin(), keys.end()));
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * sorted.size()));
+}
+
+void parallel_count_by_key(benchmark::State& state)
+{
+	auto keys = make_reconciliation_keys();
+	inplace_string_stable_sort(keys.begin(), keys.end());
+	const unsigned threads = static_cast<unsigned>(state.range(0));
+	std::vector<std::pair<inplace_string<23>, std::size_t>> counts;
+	counts.reserve(keys.size());
+
+	for (auto _ : state)
+	{
+		counts.clear();
+		inplace_string_parallel_count_by_key(threads, keys.begin(), keys.end(), std::back_inserter(counts));
+		benchmark::DoNotOptimize(counts.data());
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * keys.size()));
+}
+
+// Order ids built from a symbol and a venue: "ORD-" + symbol + '-' + venue
+std::vector<inplace_string<7>> make_symbols()
+{
+	std::vector<inplace_string<7>> symbols;
+	for (const char* symbol : {"AAPL", "MSFT", "GOOG", "A", "BRK.B", "TSLA", "META", "IBM"})
+		symbols.emplace_back(symbol);
+	return symbols;
+}
+
+void concat_operator(benchmark::State& state)
+{
+	const auto symbols = make_symbols();
+	std::size_t i = 0;
+
+	for (auto _ : state)
+	{
+		const inplace_string<19> id = "ORD-" + symbols[i % 8] + '-' + symbols[(i + 3) % 8];
+		benchmark::DoNotOptimize(id);
+		++i;
+	}
+}
+
+void concat_append(benchmark::State& state)
+{
+	const auto symbols = make_symbols();
+	std::size_t i = 0;
+
+	for (auto _ : state)
+	{
+		inplace_string<19> id("ORD-");
+		id.append(symbols[i % 8]).append(1, '-').append(symbols[(i + 3) % 8]);
+		benchmark::DoNotOptimize(id);
+		++i;
+	}
+}
+
+void concat_std_string(benchmark::State& state)
+{
+	std::vector<std::string> symbols;
+	for (const auto& symbol : make_symbols())
+		symbols.emplace_back(symbol);
+	std::size_t i = 0;
+
+	for (auto _ : state)
+	{
+		const std::string id = "ORD-" + symbols[i % 8] + '-' + symbols[(i + 3) % 8];
+		benchmark::DoNotOptimize(id.data());
+		++i;
+	}
+}
+
+// A message built field by field, every append checking the capacity under the overflow policy
+template <typename Policy>
+void append_fields(benchmark::State& state)
+{
+	using string_type = basic_inplace_string<63, char, std::char_traits<char>, Policy>;
+	const auto symbols = make_symbols();
+	std::size_t i = 0;
+
+	for (auto _ : state)
+	{
+		string_type msg("NEW ");
+		msg.append(symbols[i % 8]);
+		msg.push_back(' ');
+		msg.append(symbols[(i + 3) % 8]);
+		msg.append(" qty=100 px=187.25 tif=DAY");
+		msg.append(i % 4 + 1, '!');
+		benchmark::DoNotOptimize(msg);
+		++i;
+	}
+}
+
+// A field parsed character by character: one push_back per character, each of them terminating the string
+// unless the policy drops the terminator
+template <typename Policy>
+void push_back_chars(benchmark::State& state)
+{
+	using string_type = basic_inplace_string<63, char, std::char_traits<char>, Policy>;
+	const auto src = make_chars<char>(60);
+
+	for (auto _ : state)
+	{
+		string_type field;
+		for (std::size_t i = 0; i < 60; ++i)
+		{
+			benchmark::DoNotOptimize(src[i]);
+			field.push_back(src[i]);
+		}
+		benchmark::DoNotOptimize(field);
+	}
+}
+
+// "ORD-<n>" labels: the number through std::to_string, appended in place, or concatenated with a capacity
+// known at compile time
+void label_to_string(benchmark::State& state)
+{
+	std::uint32_t n = 100000;
+	for (auto _ : state)
+	{
+		inplace_string<31> label("ORD-");
+		label.append(std::to_string(n++));
+		benchmark::DoNotOptimize(label);
+	}
+}
+
+void label_append_number(benchmark::State& state)
+{
+	std::uint32_t n = 100000;
+	for (auto _ : state)
+	{
+		inplace_string<31> label("ORD-");
+		append_number(label, n++);
+		benchmark::DoNotOptimize(label);
+	}
+}
+
+void label_to_inplace_string(benchmark::State& state)
+{
+	std::uint32_t n = 100000;
+	for (auto _ : state)
+	{
+		const inplace_string<31> label = "ORD-" + to_inplace_string(n++);
+		benchmark::DoNotOptimize(label);
+	}
+}
+
+void price_append_number(benchmark::State& state)
+{
+	double px = 187.25;
+	for (auto _ : state)
+	{
+		inplace_string<31> label("px=");
+		append_number(label, px);
+		px += 0.25;
+		benchmark::DoNotOptimize(label);
+	}
+}
+
+// An order message formatted with snprintf then copied into the string, or formatted in place. With a bounded
+// format, the message is checked once against the capacity instead of piece by piece.
+void format_snprintf(benchmark::State& state)
+{
+	const auto symbols = make_symbols();
+	std::uint32_t i = 0;
+	for (auto _ : state)
+	{
+		char buf[64];
+		const int len = std::snprintf(buf, sizeof(buf), "NEW %s qty=%u px=%d.%02d", symbols[i % 8].c_str(), i % 1000, 187, 25);
+		const inplace_string<63> msg(buf, static_cast<std::size_t>(len));
+		benchmark::DoNotOptimize(msg);
+		++i;
+	}
+}
+
+void format_inplace_format(benchmark::State& state)
+{
+	const auto symbols = make_symbols();
+	std::uint32_t i = 0;
+	for (auto _ : state)
+	{
+		const auto msg = inplace_format<63>("NEW {} qty={} px={}.{}", symbols[i % 8], i % 1000, 187, 25);
+		benchmark::DoNotOptimize(msg);
+		++i;
+	}
+}
+
+void format_inplace_format_unbounded(benchmark::State& state)
+{
+	const auto symbols = make_symbols();
+	std::uint32_t i = 0;
+	for (auto _ : state)
+	{
+		const auto msg = inplace_format<63>("NEW {} qty={} px={}.{}", symbols[i % 8].c_str(), i % 1000, 187, 25);
+		benchmark::DoNotOptimize(msg);
+		++i;
+	}
+}
+
+// The same message through operator<<: a std::ostringstream copied into the string, or a stream formatting into
+// the string storage. The /reused variants clear one stream per message rather than constructing one.
+void ostream_std_ostringstream(benchmark::State& state)
+{
+	const auto symbols = make_symbols();
+	std::uint32_t i = 0;
+	for (auto _ : state)
+	{
+		std::ostringstream os;
+		os << "NEW " << symbols[i % 8] << " qty=" << i % 1000 << " px=" << 187 << '.' << 25;
+		const inplace_string<63> msg(os.str());
+		benchmark::DoNotOptimize(msg);
+		++i;
+	}
+}
+
+void ostream_inplace_ostringstream(benchmark::State& state)
+{
+	const auto symbols = make_symbols();
+	std::uint32_t i = 0;
+	for (auto _ : state)
+	{
+		inplace_ostringstream<63> os;
+		os << "NEW " << symbols[i % 8] << " qty=" << i % 1000 << " px=" << 187 << '.' << 25;
+		const inplace_string<63> msg = os.str();
+		benchmark::DoNotOptimize(msg);
+		++i;
+	}
+}
+
+void ostream_std_ostringstream_reused(benchmark::State& state)
+{
+	const auto symbols = make_symbols();
+	std::ostringstream os;
+	std::uint32_t i = 0;
+	for (auto _ : state)
+	{
+		os.str(std::string());
+		os << "NEW " << symbols[i % 8] << " qty=" << i % 1000 << " px=" << 187 << '.' << 25;
+		const inplace_string<63> msg(os.str());
+		benchmark::DoNotOptimize(msg);
+		++i;
+	}
+}
+
+void ostream_inplace_ostringstream_reused(benchmark::State& state)
+{
+	const auto symbols = make_symbols();
+	inplace_ostringstream<63> os;
+	std::uint32_t i = 0;
+	for (auto _ : state)
+	{
+		os.str(inplace_string<63>());
+		os << "NEW " << symbols[i % 8] << " qty=" << i % 1000 << " px=" << 187 << '.' << 25;
+		const inplace_string<63> msg = os.str();
+		benchmark::DoNotOptimize(msg);
+		++i;
+	}
+}
+
+// Fixed-width numeric fields of a feed: 16-digit zero-padded quantities and 4-decimal prices
+std::vector<inplace_string<23>> make_quantity_fields()
+{
+	std::vector<inplace_string<23>> fields;
+	for (std::uint64_t i = 0; i < 64; ++i)
+	{
+		char buf[24];
+		std::snprintf(buf, sizeof(buf), "%016llu", static_cast<unsigned long long>(i * 7919 * 104729 + 12));
+		fields.emplace_back(buf);
+	}
+	return fields;
+}
+
+std::vector<inplace_string<23>> make_price_fields()
+{
+	std::vector<inplace_string<23>> fields;
+	for (unsigned i = 0; i < 64; ++i)
+	{
+		char buf[24];
+		std::snprintf(buf, sizeof(buf), "%u.%04u", 100 + i * 7, (i * 2671) % 10000);
+		fields.emplace_back(buf);
+	}
+	return fields;
+}
+
+void parse_quantity_stoull(benchmark::State& state)
+{
+	const auto fields = make_quantity_fields();
+	std::size_t i = 0;
+	for (auto _ : state)
+	{
+		const std::uint64_t qty = std::stoull(std::string(fields[i++ % fields.size()]));
+		benchmark::DoNotOptimize(qty);
+	}
+}
+
+void parse_quantity_from_chars(benchmark::State& state)
+{
+	const auto fields = make_quantity_fields();
+	std::size_t i = 0;
+	for (auto _ : state)
+	{
+		const auto& field = fields[i++ % fields.size()];
+		std::uint64_t qty = 0;
+		std::from_chars(field.data(), field.data() + field.size(), qty);
+		benchmark::DoNotOptimize(qty);
+	}
+}
+
+void parse_quantity_parse_uint(benchmark::State& state)
+{
+	const auto fields = make_quantity_fields();
+	std::size_t i = 0;
+	for (auto _ : state)
+	{
+		std::uint64_t qty = 0;
+		parse_uint(fields[i++ % fields.size()], qty);
+		benchmark::DoNotOptimize(qty);
+	}
+}
+
+void parse_price_stod(benchmark::State& state)
+{
+	const auto fields = make_price_fields();
+	std::size_t i = 0;
+	for (auto _ : state)
+	{
+		const auto px = static_cast<std::int64_t>(std::stod(std::string(fields[i++ % fields.size()])) * 10000 + 0.5);
+		benchmark::DoNotOptimize(px);
+	}
+}
+
+void parse_price_parse_decimal(benchmark::State& state)
+{
+	const auto fields = make_price_fields();
+	std::size_t i = 0;
+	for (auto _ : state)
+	{
+		std::int64_t px = 0;
+		parse_decimal(fields[i++ % fields.size()], px, 4);
+		benchmark::DoNotOptimize(px);
+	}
+}
+
+// A file with a unique name in the temporary directory, removed at destruction
+struct temp_file
+{
+	std::string path;
+
+	temp_file()
+	{
+#if defined _MSC_VER
+		char name[L_tmpnam_s];
+		if (tmpnam_s(name, sizeof(name)) == 0)
+			path = name;
+#else
+		const char* dir = std::getenv("TMPDIR");
+		std::string name = std::string(dir && *dir ? dir : "/tmp") + "/inplace_string_bench_XXXXXX";
+		const int fd = mkstemp(&name[0]);
+		if (fd != -1)
+		{
+			close(fd);
+			path = name;
+		}
+#endif
+		if (path.empty())
+			throw std::runtime_error("cannot create a temporary file");
+	}
+
+	~temp_file() { std::remove(path.c_str()); }
+
+	temp_file(const temp_file&) = delete;
+	temp_file& operator=(const temp_file&) = delete;
+};
+
+// A text file of identifiers, one per line, read back line by line or word by word. The file is written once,
+// in the temporary directory, and removed at exit; the size is in MB (pass --benchmark_filter and a larger Arg
+// for multi-GB runs).
+const std::string& identifier_file(std::size_t mb)
+{
+	static std::unordered_map<std::size_t, std::unique_ptr<temp_file>> files;
+	std::unique_ptr<temp_file>& file = files[mb];
+	if (!file)
+	{
+		file.reset(new temp_file);
+		std::ofstream out(file->path);
+		const auto symbols = make_symbols();
+		for (std::size_t bytes = 0, i = 0; bytes < (mb << 20); ++i)
+		{
+			char line[48];
+			const int len = std::snprintf(line, sizeof(line), "ORD-%s-%012zu\n", symbols[i % 8].c_str(), i * 7919);
+			out.write(line, len);
+			bytes += static_cast<std::size_t>(len);
+		}
+	}
+	return file->path;
+}
+
+template <typename Read>
+void read_identifiers(benchmark::State& state, Read read)
+{
+	const std::string& path = identifier_file(static_cast<std::size_t>(state.range(0)));
+	for (auto _ : state)
+	{
+		std::ifstream in(path);
+		std::size_t count = 0;
+		read(in, count);
+		benchmark::DoNotOptimize(count);
+	}
+	state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations()) * (state.range(0) << 20));
+}
+
+void getline_std_string(benchmark::State& state)
+{
+	read_identifiers(state, [](std::ifstream& in, std::size_t& count) {
+		for (std::string line; std::getline(in, line); ++count)
+		{
+			const inplace_string<31> id(line);
+			benchmark::DoNotOptimize(id);
+		}
+	});
+}
+
+void getline_inplace_string(benchmark::State& state)
+{
+	read_identifiers(state, [](std::ifstream& in, std::size_t& count) {
+		for (inplace_string<31> id; getline(in, id); ++count)
+			benchmark::DoNotOptimize(id);
+	});
+}
+
+void extract_std_string(benchmark::State& state)
+{
+	read_identifiers(state, [](std::ifstream& in, std::size_t& count) {
+		for (std::string word; in >> word; ++count)
+		{
+			const inplace_string<31> id(word);
+			benchmark::DoNotOptimize(id);
+		}
+	});
+}
+
+void extract_inplace_string(benchmark::State& state)
+{
+	read_identifiers(state, [](std::ifstream& in, std::size_t& count) {
+		for (inplace_string<31> id; in >> id; ++count)
+			benchmark::DoNotOptimize(id);
+	});
+}
+
+// A 24-byte binary id hex-encoded straight into the string, after resize() has filled it, through
+// resize_and_overwrite() or through prepare_append()/commit_append()
+char* hex_encode(const unsigned char* src, std::size_t count, char* dest)
+{
+	static const char digits[] = "0123456789abcdef";
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		*dest++ = digits[src[i] >> 4];
+		*dest++ = digits[src[i] & 0xf];
+	}
+	return dest;
+}
+
+std::array<unsigned char, 24> make_binary_id()
+{
+	std::array<unsigned char, 24> id;
+	for (std::size_t i = 0; i < id.size(); ++i)
+		id[i] = static_cast<unsigned char>(i * 37 + 11);
+	return id;
+}
+
+void hex_fill_resize(benchmark::State& state)
+{
+	const auto id = make_binary_id();
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(id.data());
+		inplace_string<63> s;
+		s.resize(id.size() * 2);
+		hex_encode(id.data(), id.size(), &s[0]);
+		benchmark::DoNotOptimize(s);
+	}
+}
+
+void hex_fill_resize_and_overwrite(benchmark::State& state)
+{
+	const auto id = make_binary_id();
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(id.data());
+		inplace_string<63> s;
+		s.resize_and_overwrite(id.size() * 2, [&](char* buf, std::size_t) {
+			return static_cast<std::size_t>(hex_encode(id.data(), id.size(), buf) - buf);
+		});
+		benchmark::DoNotOptimize(s);
+	}
+}
+
+void hex_fill_prepare_append(benchmark::State& state)
+{
+	const auto id = make_binary_id();
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(id.data());
+		inplace_string<63> s;
+		const auto span = s.prepare_append();
+		s.commit_append(static_cast<std::size_t>(hex_encode(id.data(), id.size(), span.data) - span.data));
+		benchmark::DoNotOptimize(s);
+	}
+}
+
+template <typename Map>
+struct map_name;
+
+template <typename Key, typename T>
+struct map_name<inplace_flat_map<Key, T>> { static const char* value() { return "inplace_flat_map"; } };
+
+template <typename Key, typename T>
+struct map_name<std::unordered_map<Key, T>> { static const char* value() { return "std::unordered_map"; } };
+
+template <typename Map>
+void map_insert(benchmark::State& state)
+{
+	using key_type = typename Map::key_type;
+	const auto keys = make_keys<key_type>(static_cast<std::size_t>(state.range(0)), true);
+
+	for (auto _ : state)
+	{
+		Map map;
+		for (const auto& key : keys)
+			map.emplace(key, 0);
+		benchmark::DoNotOptimize(map.size());
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * keys.size()));
+}
+
+// Hits in keys order, misses with keys that share the prefix of the stored ones.
+template <typename Map>
+void map_lookup(benchmark::State& state)
+{
+	using key_type = typename Map::key_type;
+	const auto keys = make_keys<key_type>(static_cast<std::size_t>(state.range(0)), true);
+	const bool miss = state.range(1) != 0;
+
+	Map map;
+	for (std::size_t i = 0; i < keys.size(); ++i)
+		if (!miss || i % 2 == 0)
+			map.emplace(keys[i], 0);
+
+	for (auto _ : state)
+	{
+		std::size_t found = 0;
+		for (const auto& key : keys)
+			found += map.count(key);
+		benchmark::DoNotOptimize(found);
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * keys.size()));
+}
+
+template <typename Map>
+void register_map()
+{
+	const std::string name = std::string(map_name<Map>::value()) + "<inplace_string<15>>";
+
+	benchmark::RegisterBenchmark(("map_insert/" + name).c_str(), &map_insert<Map>)
+		->ArgName("size")->Arg(1 << 10)->Arg(1 << 16)->Arg(1 << 20);
+	benchmark::RegisterBenchmark(("map_lookup/" + name).c_str(), &map_lookup<Map>)
+		->ArgNames({"size", "miss"})->Args({1 << 10, 0})->Args({1 << 16, 0})->Args({1 << 20, 0})->Args({1 << 16, 1});
+}
+
+// Name -> id lookups on a warmed-up interner, against the usual std::string keyed map.
+void intern_lookup(benchmark::State& state)
+{
+	const auto names = make_keys<inplace_string<15>>(4096, false);
+	inplace_string_interner<15> interner(names.size());
+	for (const auto& name : names)
+		interner.intern(name);
+	interner.freeze();
+
+	for (auto _ : state)
+	{
+		std::uint64_t sum = 0;
+		for (const auto& name : names)
+			sum += interner.intern(name);
+		benchmark::DoNotOptimize(sum);
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * names.size()));
+}
+
+void intern_lookup_std(benchmark::State& state)
+{
+	const auto keys = make_keys<inplace_string<15>>(4096, false);
+	std::vector<std::string> names(keys.begin(), keys.end());
+	std::unordered_map<std::string, std::uint32_t> ids;
+	for (const auto& name : names)
+		ids.emplace(name, static_cast<std::uint32_t>(ids.size()));
+
+	for (auto _ : state)
+	{
+		std::uint64_t sum = 0;
+		for (const auto& name : names)
+			sum += ids.find(name)->second;
+		benchmark::DoNotOptimize(sum);
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * names.size()));
+}
+
+// Scans over 1M strings of up to 31 characters, stored as a vector of inplace_string<31> or as a column
+std::vector<inplace_string<31>> make_column_records()
+{
+	std::vector<inplace_string<31>> records;
+	records.reserve(1 << 20);
+
+	unsigned seed = 1;
+	for (std::size_t i = 0; i < (1 << 20); ++i)
+	{
+		inplace_string<31> record;
+		seed = seed * 1103515245u + 12345u;
+		for (std::size_t j = (seed >> 16) % 32; j != 0; --j)
+		{
+			seed = seed * 1103515245u + 12345u;
+			record.push_back(static_cast<char>('a' + (seed >> 16) % 4));
+		}
+		records.push_back(record);
+	}
+
+	return records;
+}
+
+enum class column_scan { length, equal, prefix };
+
+void scan_vector(benchmark::State& state)
+{
+	const auto records = make_column_records();
+	const auto scan = static_cast<column_scan>(state.range(0));
+	const inplace_string<31> needle = "abcdabcdabcd";
+	std::vector<std::size_t> indices;
+	indices.reserve(records.size());
+
+	for (auto _ : state)
+	{
+		indices.clear();
+		for (std::size_t i = 0; i < records.size(); ++i)
+		{
+			const auto& record = records[i];
+			const bool match = scan == column_scan::length ? record.size() >= 4 && record.size() <= 6
+							 : scan == column_scan::equal ? record == needle
+							 : record.compare(0, 4, "abcd", 4) == 0 && record.size() >= 4;
+			if (match)
+				indices.push_back(i);
+		}
+		benchmark::DoNotOptimize(indices.data());
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * records.size()));
+}
+
+template <typename Column>
+void scan_column(benchmark::State& state)
+{
+	const auto records = make_column_records();
+	const Column column(records.begin(), records.end());
+	const auto scan = static_cast<column_scan>(state.range(0));
+	std::vector<std::size_t> indices;
+	indices.reserve(records.size());
+
+	for (auto _ : state)
+	{
+		indices.clear();
+		if (scan == column_scan::length)
+			column.filter_length(4, 6, std::back_inserter(indices));
+		else if (scan == column_scan::equal)
+			column.filter_equal("abcdabcdabcd", std::back_inserter(indices));
+		else
+			column.filter_prefix("abcd", std::back_inserter(indices));
+		benchmark::DoNotOptimize(indices.data());
+	}
+
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * records.size()));
+}
+
+}
+
+// Results can be written as JSON with --benchmark_out=<file> --benchmark_out_format=json, or through the
+// bench_json target, which writes bench.json in the build directory.
+int main(int argc, char** argv)
+{
+	register_char_type<char>();
+	register_impl<inplace_policy_impl<31, char, inplace_string_size_trailer_policy>, char>();
+	register_impl<inplace_policy_impl<255, char, inplace_string_size_trailer_policy>, char>();
+	register_impl<inplace_policy_impl<31, char, inplace_string_unterminated_policy>, char>();
+	register_impl<inplace_policy_impl<255, char, inplace_string_unterminated_policy>, char>();
+	register_capacity<4096, char>();
+	register_char_type<wchar_t>();
+	register_char_type<char16_t>();
+	register_char_type<char32_t>();
+
+	register_search<char>();
+	register_search<char16_t>();
+	register_search<char32_t>();
+
+	benchmark::RegisterBenchmark("grep/find", &grep_find)->ArgName("long_needle")->Arg(0)->Arg(1);
+	benchmark::RegisterBenchmark("grep/searcher", &grep_searcher)->ArgName("long_needle")->Arg(0)->Arg(1);
+
+	register_hash<15>();
+	register_hash<31>();
+
+	benchmark::RegisterBenchmark("lookup_stable_keys/inplace_string<15>", &lookup_stable_keys<inplace_string<15>>);
+	benchmark::RegisterBenchmark("lookup_stable_keys/cached_hash_inplace_string<15>", &lookup_stable_keys<cached_hash_inplace_string<15>>);
+
+	benchmark::RegisterBenchmark("sort_tickers/inplace_string<7>", &sort_tickers<inplace_string<7>>)->ArgName("count")->Arg(1 << 20);
+	benchmark::RegisterBenchmark("sort_tickers/inplace_string<15>", &sort_tickers<inplace_string<15>>)->ArgName("count")->Arg(1 << 20);
+	benchmark::RegisterBenchmark("sort_tickers/std::string", &sort_tickers<std::string>)->ArgName("count")->Arg(1 << 20);
+	benchmark::RegisterBenchmark("sort_tickers/inplace_string<7>/radix", &sort_tickers<inplace_string<7>, radix_sort>)->ArgName("count")->Arg(1 << 20);
+	benchmark::RegisterBenchmark("sort_tickers/inplace_string<7>/stable_radix", &sort_tickers<inplace_string<7>, stable_radix_sort>)->ArgName("count")->Arg(1 << 20);
+	benchmark::RegisterBenchmark("sort_tickers/inplace_string<15>/radix", &sort_tickers<inplace_string<15>, radix_sort>)->ArgName("count")->Arg(1 << 20);
+	benchmark::RegisterBenchmark("sort_order_ids/inplace_string<31>/std::sort", &sort_order_ids<inplace_string<31>, std_sort>)->ArgName("count")->Arg(1 << 20);
+	benchmark::RegisterBenchmark("sort_order_ids/inplace_string<31>/radix", &sort_order_ids<inplace_string<31>, radix_sort>)->ArgName("count")->Arg(1 << 20);
+	benchmark::RegisterBenchmark("sort_order_ids/inplace_string<31>/stable_radix", &sort_order_ids<inplace_string<31>, stable_radix_sort>)->ArgName("count")->Arg(1 << 20);
+	benchmark::RegisterBenchmark("concat/operator+", &concat_operator);
+	benchmark::RegisterBenchmark("concat/append", &concat_append);
+	benchmark::RegisterBenchmark("concat/std::string", &concat_std_string);
+	benchmark::RegisterBenchmark("append_fields/throw", &append_fields<inplace_string_default_policy>);
+	benchmark::RegisterBenchmark("append_fields/truncate", &append_fields<inplace_string_truncating_policy>);
+	benchmark::RegisterBenchmark("append_fields/saturate", &append_fields<inplace_string_saturating_policy>);
+	benchmark::RegisterBenchmark("append_fields/terminate", &append_fields<inplace_string_terminating_policy>);
+	benchmark::RegisterBenchmark("append_fields/unterminated", &append_fields<inplace_string_unterminated_policy>);
+	benchmark::RegisterBenchmark("push_back_chars/terminated", &push_back_chars<inplace_string_default_policy>);
+	benchmark::RegisterBenchmark("push_back_chars/unterminated", &push_back_chars<inplace_string_unterminated_policy>);
+	benchmark::RegisterBenchmark("label/std::to_string", &label_to_string);
+	benchmark::RegisterBenchmark("label/append_number", &label_append_number);
+	benchmark::RegisterBenchmark("label/to_inplace_string", &label_to_inplace_string);
+	benchmark::RegisterBenchmark("label/append_number<double>", &price_append_number);
+	benchmark::RegisterBenchmark("format/snprintf", &format_snprintf);
+	benchmark::RegisterBenchmark("format/inplace_format", &format_inplace_format);
+	benchmark::RegisterBenchmark("format/inplace_format/unbounded", &format_inplace_format_unbounded);
+	benchmark::RegisterBenchmark("ostream/std::ostringstream", &ostream_std_ostringstream);
+	benchmark::RegisterBenchmark("ostream/inplace_ostringstream", &ostream_inplace_ostringstream);
+	benchmark::RegisterBenchmark("ostream/std::ostringstream/reused", &ostream_std_ostringstream_reused);
+	benchmark::RegisterBenchmark("ostream/inplace_ostringstream/reused", &ostream_inplace_ostringstream_reused);
+	benchmark::RegisterBenchmark("parse_quantity/std::stoull", &parse_quantity_stoull);
+	benchmark::RegisterBenchmark("parse_quantity/std::from_chars", &parse_quantity_from_chars);
+	benchmark::RegisterBenchmark("parse_quantity/parse_uint", &parse_quantity_parse_uint);
+	benchmark::RegisterBenchmark("parse_price/std::stod", &parse_price_stod);
+	benchmark::RegisterBenchmark("parse_price/parse_decimal", &parse_price_parse_decimal);
+	benchmark::RegisterBenchmark("read_lines/std::getline(std::string)", &getline_std_string)->ArgName("MB")->Arg(256)->Unit(benchmark::kMillisecond);
+	benchmark::RegisterBenchmark("read_lines/getline(inplace_string<31>)", &getline_inplace_string)->ArgName("MB")->Arg(256)->Unit(benchmark::kMillisecond);
+	benchmark::RegisterBenchmark("read_words/operator>>(std::string)", &extract_std_string)->ArgName("MB")->Arg(256)->Unit(benchmark::kMillisecond);
+	benchmark::RegisterBenchmark("read_words/operator>>(inplace_string<31>)", &extract_inplace_string)->ArgName("MB")->Arg(256)->Unit(benchmark::kMillisecond);
+	benchmark::RegisterBenchmark("hex_fill/resize", &hex_fill_resize);
+	benchmark::RegisterBenchmark("hex_fill/resize_and_overwrite", &hex_fill_resize_and_overwrite);
+	benchmark::RegisterBenchmark("hex_fill/prepare_append", &hex_fill_prepare_append);
+	benchmark::RegisterBenchmark("parallel_sort/inplace_string<23>", &parallel_sort)->ArgName("threads")->RangeMultiplier(2)->Range(1, 64)->UseRealTime();
+	benchmark::RegisterBenchmark("parallel_unique/inplace_string<23>", &parallel_unique)->ArgName("threads")->RangeMultiplier(2)->Range(1, 64)->UseRealTime();
+	benchmark::RegisterBenchmark("parallel_count_by_key/inplace_string<23>", &parallel_count_by_key)->ArgName("threads")->RangeMultiplier(2)->Range(1, 64)->UseRealTime();
+
+	register_map<inplace_flat_map<inplace_string<15>, int>>();
+	register_map<std::unordered_map<inplace_string<15>, int>>();
+
+	benchmark::RegisterBenchmark("intern_lookup/inplace_string_interner<15>", &intern_lookup);
+	benchmark::RegisterBenchmark("intern_lookup/std::unordered_map<std::string,uint32_t>", &intern_lookup_std);
+
+	benchmark::RegisterBenchmark("column_scan/vector<inplace_string<31>>", &scan_vector)->ArgName("length_equal_prefix")->DenseRange(0, 2);
+	benchmark::RegisterBenchmark("column_scan/inplace_string_column<31>", &scan_column<inplace_string_column<31>>)->ArgName("length_equal_prefix")->DenseRange(0, 2);
+	benchmark::RegisterBenchmark("column_scan/inplace_string_prefix_column<31>", &scan_column<inplace_string_prefix_column<31>>)->ArgName("length_equal_prefix")->DenseRange(0, 2);
+
+	benchmark::Initialize(&argc, argv);
+	if (benchmark::ReportUnrecognizedArguments(argc, argv))
+		return 1;
+
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+	return 0;
+}
@@ -0,0 +1,727 @@
+#pragma once
+
+#include "inplace_string.h"
+
+#include <memory>
+#include <utility>
+#include <functional>
+#include <iterator>
+#include <initializer_list>
+
+namespace detail
+{
+
+// Control bytes of inplace_flat_map: one per slot, either empty, deleted, or the 7 low bits of the hash of the
+// key stored in the slot. Empty and deleted have the sign bit set, full slots do not.
+constexpr signed char ctrl_empty = -128;
+constexpr signed char ctrl_deleted = -2;
+
+// 16 consecutive control bytes, matched at once: each match returns a bitmask with one bit per slot.
+class ctrl_group
+{
+public:
+	static constexpr std::size_t width = 16;
+
+	explicit ctrl_group(const signed char* ctrl) noexcept
+	{
+#if defined INPLACE_STRING_SSE2
+		_ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+#else
+		std::memcpy(_ctrl, ctrl, width);
+#endif
+	}
+
+	unsigned match(signed char h2) const noexcept
+	{
+#if defined INPLACE_STRING_SSE2
+		return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(_ctrl, _mm_set1_epi8(h2))));
+#else
+		unsigned mask = 0;
+		for (std::size_t i = 0; i < width; ++i)
+			mask |= static_cast<unsigned>(_ctrl[i] == h2) << i;
+		return mask;
+#endif
+	}
+
+	unsigned match_empty() const noexcept
+	{
+		return match(ctrl_empty);
+	}
+
+	unsigned match_empty_or_deleted() const noexcept
+	{
+#if defined INPLACE_STRING_SSE2
+		return static_cast<unsigned>(_mm_movemask_epi8(_ctrl));
+#else
+		unsigned mask = 0;
+		for (std::size_t i = 0; i < width; ++i)
+			mask |= static_cast<unsigned>(_ctrl[i] < 0) << i;
+		return mask;
+#endif
+	}
+
+private:
+#if defined INPLACE_STRING_SSE2
+	__m128i _ctrl;
+#else
+	signed char _ctrl[width];
+#endif
+};
+
+}
+
+// Open-addressing hash map for basic_inplace_string keys, Swiss table style. The key/value pairs are stored
+// inline in one slot array: keys are fixed-size, so there is no node allocation. A rehash move-constructs
+// every pair into the new array and hashes its key again, which only reads the stored hash for
+// cached_hash_inplace_string keys. Lookups probe groups of 16 control bytes with SIMD compares, and only
+// compare keys whose 7 hash bits match.
+// Lookups also accept a basic_string_view: a view longer than the key capacity cannot be in the map, any other
+// one is copied in a key before hashing.
+// Iterators, pointers and references are invalidated by every insertion that grows the map.
+template <typename Key,
+		  typename T,
+		  typename Hash = std::hash<Key>,
+		  typename KeyEqual = std::equal_to<Key>>
+class inplace_flat_map
+{
+	static_assert(detail::is_inplace_string<Key>::value, "inplace_flat_map: Key must be a basic_inplace_string");
+
+	template <bool Const>
+	class basic_iterator;
+
+public:
+	using key_type = Key;
+	using mapped_type = T;
+	using value_type = std::pair<const Key, T>;
+	using size_type = std::size_t;
+	using difference_type = std::ptrdiff_t;
+	using hasher = Hash;
+	using key_equal = KeyEqual;
+	using reference = value_type&;
+	using const_reference = const value_type&;
+	using pointer = value_type*;
+	using const_pointer = const value_type*;
+	using iterator = basic_iterator<false>;
+	using const_iterator = basic_iterator<true>;
+	using key_view = basic_string_view<typename Key::value_type, typename Key::traits_type>;
+
+private:
+	// Heterogeneous overloads: anything convertible to a view but the key itself, so that string literals and
+	// std::string select them without building a key first.
+	template <typename K>
+	using if_view = typename std::enable_if<std::is_convertible<const K&, key_view>::value
+											&& !std::is_same<K, key_type>::value>::type;
+
+public:
+
+	inplace_flat_map() noexcept = default;
+	explicit inplace_flat_map(size_type capacity, const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual());
+	inplace_flat_map(std::initializer_list<value_type> ilist);
+
+	template <typename InputIt>
+	inplace_flat_map(InputIt first, InputIt last);
+
+	inplace_flat_map(const inplace_flat_map& other);
+	inplace_flat_map(inplace_flat_map&& other) noexcept;
+	~inplace_flat_map();
+
+	inplace_flat_map& operator=(const inplace_flat_map& other);
+	inplace_flat_map& operator=(inplace_flat_map&& other) noexcept;
+
+	iterator       begin() noexcept        { return iterator(_ctrl, _slots, _ctrl + _capacity); }
+	const_iterator begin() const noexcept  { return const_iterator(_ctrl, _slots, _ctrl + _capacity); }
+	const_iterator cbegin() const noexcept { return begin(); }
+	iterator       end() noexcept          { return iterator(); }
+	const_iterator end() const noexcept    { return const_iterator(); }
+	const_iterator cend() const noexcept   { return end(); }
+
+	bool empty() const noexcept { return _size == 0; }
+	size_type size() const noexcept { return _size; }
+	size_type capacity() const noexcept { return _capacity; }
+	float load_factor() const noexcept { return _capacity ? static_cast<float>(_size) / static_cast<float>(_capacity) : 0.0f; }
+	static constexpr float max_load_factor() noexcept { return 0.875f; }
+
+	void clear() noexcept;
+	void reserve(size_type count);
+	void rehash(size_type capacity);
+	void swap(inplace_flat_map& other) noexcept;
+
+	std::pair<iterator, bool> insert(const value_type& value) { return try_emplace(value.first, value.second); }
+	std::pair<iterator, bool> insert(value_type&& value)      { return try_emplace(value.first, std::move(value.second)); }
+
+	template <typename InputIt>
+	void insert(InputIt first, InputIt last);
+
+	void insert(std::initializer_list<value_type> ilist) { insert(ilist.begin(), ilist.end()); }
+
+	template <typename... Args>
+	std::pair<iterator, bool> try_emplace(const key_type& key, Args&&... args);
+
+	template <typename... Args>
+	std::pair<iterator, bool> emplace(const key_type& key, Args&&... args) { return try_emplace(key, std::forward<Args>(args)...); }
+
+	template <typename M>
+	std::pair<iterator, bool> insert_or_assign(const key_type& key, M&& obj);
+
+	T& operator[](const key_type& key) { return try_emplace(key).first->second; }
+
+	T&       at(const key_type& key);
+	const T& at(const key_type& key) const;
+
+	template <typename K, typename X = if_view<K>>
+	T& at(const K& key);
+
+	template <typename K, typename X = if_view<K>>
+	const T& at(const K& key) const;
+
+	iterator       find(const key_type& key) noexcept;
+	const_iterator find(const key_type& key) const noexcept;
+
+	template <typename K, typename X = if_view<K>>
+	iterator find(const K& key);
+
+	template <typename K, typename X = if_view<K>>
+	const_iterator find(const K& key) const;
+
+	size_type count(const key_type& key) const noexcept { return find(key) != end(); }
+	bool contains(const key_type& key) const noexcept   { return find(key) != end(); }
+
+	template <typename K, typename X = if_view<K>>
+	size_type count(const K& key) const { return find(key) != end(); }
+
+	template <typename K, typename X = if_view<K>>
+	bool contains(const K& key) const { return find(key) != end(); }
+
+	iterator erase(const_iterator pos);
+	size_type erase(const key_type& key);
+
+	template <typename K, typename X = if_view<K>>
+	size_type erase(const K& key);
+
+	hasher hash_function() const { return _hash; }
+	key_equal key_eq() const { return _equal; }
+
+private:
+	static constexpr size_type group_width = detail::ctrl_group::width;
+
+	std::size_t find_index(const key_type& key, std::size_t hash) const noexcept;
+	std::size_t find_insert_index(std::size_t hash) const noexcept;
+	void set_ctrl(std::size_t index, signed char ctrl) noexcept;
+	void erase_index(std::size_t index) noexcept;
+	void grow();
+	void allocate(size_type capacity);
+	void deallocate() noexcept;
+	void destroy_slots() noexcept;
+
+	static std::size_t h1(std::size_t hash) noexcept { return hash >> 7; }
+	static signed char h2(std::size_t hash) noexcept { return static_cast<signed char>(hash & 0x7f); }
+
+	// Keys that do not fit are never in the map: false without touching the table.
+	static bool to_key(key_view view, key_type& key)
+	{
+		if (view.size() > key_type::max_size())
+			return false;
+
+		key = key_type(view);
+		return true;
+	}
+
+	// The control bytes are followed by a copy of the first 16 ones, so that a group can be loaded at any index.
+	signed char* _ctrl = nullptr;
+	value_type* _slots = nullptr;
+	size_type _capacity = 0;
+	size_type _size = 0;
+	size_type _growth_left = 0;
+	Hash _hash;
+	KeyEqual _equal;
+};
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+template <bool Const>
+class inplace_flat_map<Key, T, Hash, KeyEqual>::basic_iterator
+{
+public:
+	using iterator_category = std::forward_iterator_tag;
+	using value_type = typename inplace_flat_map::value_type;
+	using difference_type = std::ptrdiff_t;
+	using reference = typename std::conditional<Const, const value_type&, value_type&>::type;
+	using pointer = typename std::conditional<Const, const value_type*, value_type*>::type;
+
+	basic_iterator() noexcept = default;
+
+	template <bool OtherConst, typename X = typename std::enable_if<Const && !OtherConst>::type>
+	basic_iterator(const basic_iterator<OtherConst>& other) noexcept :
+		_ctrl(other._ctrl),
+		_slot(other._slot),
+		_ctrl_end(other._ctrl_end)
+	{}
+
+	reference operator*() const noexcept  { return *_slot; }
+	pointer   operator->() const noexcept { return _slot; }
+
+	basic_iterator& operator++() noexcept
+	{
+		++_ctrl;
+		++_slot;
+		skip_empty();
+		return *this;
+	}
+
+	basic_iterator operator++(int) noexcept
+	{
+		basic_iterator it = *this;
+		++*this;
+		return it;
+	}
+
+	friend bool operator==(const basic_iterator& lhs, const basic_iterator& rhs) noexcept { return lhs._slot == rhs._slot; }
+	friend bool operator!=(const basic_iterator& lhs, const basic_iterator& rhs) noexcept { return lhs._slot != rhs._slot; }
+
+private:
+	friend class inplace_flat_map;
+
+	template <bool>
+	friend class basic_iterator;
+
+	// slot is the slot of ctrl, ctrl_end bounds the iteration: the end iterator is the null one.
+	basic_iterator(const signed char* ctrl, pointer slot, const signed char* ctrl_end) noexcept :
+		_ctrl(ctrl),
+		_slot(slot),
+		_ctrl_end(ctrl_end)
+	{
+		skip_empty();
+	}
+
+	void skip_empty() noexcept
+	{
+		while (_ctrl != _ctrl_end && *_ctrl < 0)
+		{
+			++_ctrl;
+			++_slot;
+		}
+
+		if (_ctrl == _ctrl_end)
+		{
+			_ctrl = nullptr;
+			_slot = nullptr;
+		}
+	}
+
+	const signed char* _ctrl = nullptr;
+	pointer _slot = nullptr;
+	const signed char* _ctrl_end = nullptr;
+};
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+inplace_flat_map<Key, T, Hash, KeyEqual>::inplace_flat_map(size_type capacity, const Hash& hash, const KeyEqual& equal) :
+	_hash(hash),
+	_equal(equal)
+{
+	reserve(capacity);
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+inplace_flat_map<Key, T, Hash, KeyEqual>::inplace_flat_map(std::initializer_list<value_type> ilist) :
+	inplace_flat_map(ilist.begin(), ilist.end())
+{
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+template <typename InputIt>
+inplace_flat_map<Key, T, Hash, KeyEqual>::inplace_flat_map(InputIt first, InputIt last)
+{
+	insert(first, last);
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+inplace_flat_map<Key, T, Hash, KeyEqual>::inplace_flat_map(const inplace_flat_map& other) :
+	_hash(other._hash),
+	_equal(other._equal)
+{
+	reserve(other._size);
+	insert(other.begin(), other.end());
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+inplace_flat_map<Key, T, Hash, KeyEqual>::inplace_flat_map(inplace_flat_map&& other) noexcept :
+	_hash(other._hash),
+	_equal(other._equal)
+{
+	swap(other);
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+inplace_flat_map<Key, T, Hash, KeyEqual>::~inplace_flat_map()
+{
+	destroy_slots();
+	deallocate();
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+inplace_flat_map<Key, T, Hash, KeyEqual>&
+inplace_flat_map<Key, T, Hash, KeyEqual>::operator=(const inplace_flat_map& other)
+{
+	if (this != &other)
+	{
+		inplace_flat_map copy(other);
+		swap(copy);
+	}
+	return *this;
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+inplace_flat_map<Key, T, Hash, KeyEqual>&
+inplace_flat_map<Key, T, Hash, KeyEqual>::operator=(inplace_flat_map&& other) noexcept
+{
+	inplace_flat_map moved(std::move(other));
+	swap(moved);
+	return *this;
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+void inplace_flat_map<Key, T, Hash, KeyEqual>::clear() noexcept
+{
+	destroy_slots();
+	if (_capacity)
+		std::memset(_ctrl, detail::ctrl_empty, _capacity + group_width);
+
+	_size = 0;
+	_growth_left = _capacity - _capacity / 8;
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+void inplace_flat_map<Key, T, Hash, KeyEqual>::reserve(size_type count)
+{
+	// smallest power of 2 holding count elements below the maximum load factor
+	size_type capacity = group_width;
+	while (capacity - capacity / 8 < count)
+		capacity *= 2;
+
+	if (capacity > _capacity)
+		rehash(capacity);
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+void inplace_flat_map<Key, T, Hash, KeyEqual>::rehash(size_type capacity)
+{
+	size_type new_capacity = group_width;
+	while (new_capacity < capacity || new_capacity - new_capacity / 8 < _size)
+		new_capacity *= 2;
+
+	signed char* const old_ctrl = _ctrl;
+	value_type* const old_slots = _slots;
+	const size_type old_capacity = _capacity;
+
+	allocate(new_capacity);
+
+	for (size_type i = 0; i != old_capacity; ++i)
+	{
+		if (old_ctrl[i] < 0)
+			continue;
+
+		value_type& slot = old_slots[i];
+		const std::size_t hash = _hash(slot.first);
+		const std::size_t index = find_insert_index(hash);
+		::new (static_cast<void*>(_slots + index)) value_type(std::move(slot));
+		set_ctrl(index, h2(hash));
+		slot.~value_type();
+	}
+
+	_growth_left -= _size;
+
+	std::allocator<value_type>().deallocate(old_slots, old_capacity);
+	std::allocator<signed char>().deallocate(old_ctrl, old_capacity ? old_capacity + group_width : 0);
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+void inplace_flat_map<Key, T, Hash, KeyEqual>::swap(inplace_flat_map& other) noexcept
+{
+	using std::swap;
+	swap(_ctrl, other._ctrl);
+	swap(_slots, other._slots);
+	swap(_capacity, other._capacity);
+	swap(_size, other._size);
+	swap(_growth_left, other._growth_left);
+	swap(_hash, other._hash);
+	swap(_equal, other._equal);
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+template <typename InputIt>
+void inplace_flat_map<Key, T, Hash, KeyEqual>::insert(InputIt first, InputIt last)
+{
+	for (; first != last; ++first)
+		insert(*first);
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+template <typename... Args>
+std::pair<typename inplace_flat_map<Key, T, Hash, KeyEqual>::iterator, bool>
+inplace_flat_map<Key, T, Hash, KeyEqual>::try_emplace(const key_type& key, Args&&... args)
+{
+	const std::size_t hash = _hash(key);
+
+	std::size_t index = find_index(key, hash);
+	if (index != _capacity)
+		return {iterator(_ctrl + index, _slots + index, _ctrl + _capacity), false};
+
+	if (_growth_left == 0)
+		grow();
+
+	index = find_insert_index(hash);
+	::new (static_cast<void*>(_slots + index)) value_type(std::piecewise_construct,
+														   std::forward_as_tuple(key),
+														   std::forward_as_tuple(std::forward<Args>(args)...));
+
+	// reusing a deleted slot does not consume growth
+	_growth_left -= _ctrl[index] == detail::ctrl_empty;
+	set_ctrl(index, h2(hash));
+	++_size;
+
+	return {iterator(_ctrl + index, _slots + index, _ctrl + _capacity), true};
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+template <typename M>
+std::pair<typename inplace_flat_map<Key, T, Hash, KeyEqual>::iterator, bool>
+inplace_flat_map<Key, T, Hash, KeyEqual>::insert_or_assign(const key_type& key, M&& obj)
+{
+	auto res = try_emplace(key, std::forward<M>(obj));
+	if (!res.second)
+		res.first->second = std::forward<M>(obj);
+	return res;
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+T& inplace_flat_map<Key, T, Hash, KeyEqual>::at(const key_type& key)
+{
+	const iterator it = find(key);
+	if (it == end())
+		detail::throw_helper<std::out_of_range>("inplace_flat_map::at: key not found");
+	return it->second;
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+const T& inplace_flat_map<Key, T, Hash, KeyEqual>::at(const key_type& key) const
+{
+	const const_iterator it = find(key);
+	if (it == end())
+		detail::throw_helper<std::out_of_range>("inplace_flat_map::at: key not found");
+	return it->second;
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+template <typename K, typename X>
+T& inplace_flat_map<Key, T, Hash, KeyEqual>::at(const K& key)
+{
+	const iterator it = find(key);
+	if (it == end())
+		detail::throw_helper<std::out_of_range>("inplace_flat_map::at: key not found");
+	return it->second;
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+template <typename K, typename X>
+const T& inplace_flat_map<Key, T, Hash, KeyEqual>::at(const K& key) const
+{
+	const const_iterator it = find(key);
+	if (it == end())
+		detail::throw_helper<std::out_of_range>("inplace_flat_map::at: key not found");
+	return it->second;
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+typename inplace_flat_map<Key, T, Hash, KeyEqual>::iterator
+inplace_flat_map<Key, T, Hash, KeyEqual>::find(const key_type& key) noexcept
+{
+	const std::size_t index = find_index(key, _hash(key));
+	return index != _capacity ? iterator(_ctrl + index, _slots + index, _ctrl + _capacity) : end();
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+typename inplace_flat_map<Key, T, Hash, KeyEqual>::const_iterator
+inplace_flat_map<Key, T, Hash, KeyEqual>::find(const key_type& key) const noexcept
+{
+	const std::size_t index = find_index(key, _hash(key));
+	return index != _capacity ? const_iterator(_ctrl + index, _slots + index, _ctrl + _capacity) : end();
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+template <typename K, typename X>
+typename inplace_flat_map<Key, T, Hash, KeyEqual>::iterator
+inplace_flat_map<Key, T, Hash, KeyEqual>::find(const K& view)
+{
+	key_type key;
+	return to_key(view, key) ? find(key) : end();
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+template <typename K, typename X>
+typename inplace_flat_map<Key, T, Hash, KeyEqual>::const_iterator
+inplace_flat_map<Key, T, Hash, KeyEqual>::find(const K& view) const
+{
+	key_type key;
+	return to_key(view, key) ? find(key) : end();
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+typename inplace_flat_map<Key, T, Hash, KeyEqual>::iterator
+inplace_flat_map<Key, T, Hash, KeyEqual>::erase(const_iterator pos)
+{
+	const std::size_t index = static_cast<std::size_t>(pos._ctrl - _ctrl);
+	iterator next(_ctrl + index, _slots + index, _ctrl + _capacity);
+	++next;
+
+	erase_index(index);
+	return next;
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+typename inplace_flat_map<Key, T, Hash, KeyEqual>::size_type
+inplace_flat_map<Key, T, Hash, KeyEqual>::erase(const key_type& key)
+{
+	const std::size_t index = find_index(key, _hash(key));
+	if (index == _capacity)
+		return 0;
+
+	erase_index(index);
+	return 1;
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+template <typename K, typename X>
+typename inplace_flat_map<Key, T, Hash, KeyEqual>::size_type
+inplace_flat_map<Key, T, Hash, KeyEqual>::erase(const K& view)
+{
+	key_type key;
+	return to_key(view, key) ? erase(key) : 0;
+}
+
+// Probes the groups starting at the home index of the hash, with a triangular sequence: as the capacity is a
+// power of 2, every group is visited. A group with an empty slot ends the probe.
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+std::size_t inplace_flat_map<Key, T, Hash, KeyEqual>::find_index(const key_type& key, std::size_t hash) const noexcept
+{
+	if (_capacity == 0)
+		return 0;
+
+	const std::size_t mask = _capacity - 1;
+	const signed char tag = h2(hash);
+	std::size_t offset = h1(hash) & mask;
+
+	for (std::size_t step = group_width; ; step += group_width)
+	{
+		const detail::ctrl_group group(_ctrl + offset);
+
+		for (unsigned match = group.match(tag); match != 0; match &= match - 1)
+		{
+			const std::size_t index = (offset + detail::count_trailing_zeros(match)) & mask;
+			if (_equal(_slots[index].first, key))
+				return index;
+		}
+
+		if (group.match_empty())
+			return _capacity;
+
+		offset = (offset + step) & mask;
+	}
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+std::size_t inplace_flat_map<Key, T, Hash, KeyEqual>::find_insert_index(std::size_t hash) const noexcept
+{
+	const std::size_t mask = _capacity - 1;
+	std::size_t offset = h1(hash) & mask;
+
+	for (std::size_t step = group_width; ; step += group_width)
+	{
+		const unsigned match = detail::ctrl_group(_ctrl + offset).match_empty_or_deleted();
+		if (match)
+			return (offset + detail::count_trailing_zeros(match)) & mask;
+
+		offset = (offset + step) & mask;
+	}
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+void inplace_flat_map<Key, T, Hash, KeyEqual>::set_ctrl(std::size_t index, signed char ctrl) noexcept
+{
+	_ctrl[index] = ctrl;
+	if (index < group_width)
+		_ctrl[_capacity + index] = ctrl;
+}
+
+// A slot can go back to empty when no probe sequence went past it: its group, seen from any index around it,
+// still had an empty slot. Otherwise it becomes a tombstone, reclaimed at the next rehash.
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+void inplace_flat_map<Key, T, Hash, KeyEqual>::erase_index(std::size_t index) noexcept
+{
+	_slots[index].~value_type();
+	--_size;
+
+	const std::size_t mask = _capacity - 1;
+	const unsigned empty_after = detail::ctrl_group(_ctrl + index).match_empty();
+	const unsigned empty_before = detail::ctrl_group(_ctrl + ((index - group_width) & mask)).match_empty();
+
+	const unsigned leading = empty_before ? 15u - detail::highest_bit(empty_before) : static_cast<unsigned>(group_width);
+	const unsigned trailing = empty_after ? detail::count_trailing_zeros(empty_after) : static_cast<unsigned>(group_width);
+
+	if (leading + trailing < group_width)
+	{
+		set_ctrl(index, detail::ctrl_empty);
+		++_growth_left;
+	}
+	else
+		set_ctrl(index, detail::ctrl_deleted);
+}
+
+// Doubles the capacity, unless tombstones take most of the room: rehashing at the same capacity reclaims them.
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+void inplace_flat_map<Key, T, Hash, KeyEqual>::grow()
+{
+	if (_capacity && _size < (_capacity - _capacity / 8) / 2)
+		rehash(_capacity);
+	else
+		rehash(_capacity ? _capacity * 2 : group_width);
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+void inplace_flat_map<Key, T, Hash, KeyEqual>::allocate(size_type capacity)
+{
+	signed char* const ctrl = std::allocator<signed char>().allocate(capacity + group_width);
+	try
+	{
+		_slots = std::allocator<value_type>().allocate(capacity);
+	}
+	catch (...)
+	{
+		std::allocator<signed char>().deallocate(ctrl, capacity + group_width);
+		throw;
+	}
+
+	_ctrl = ctrl;
+	_capacity = capacity;
+	std::memset(_ctrl, detail::ctrl_empty, _capacity + group_width);
+	_growth_left = _capacity - _capacity / 8;
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+void inplace_flat_map<Key, T, Hash, KeyEqual>::deallocate() noexcept
+{
+	if (_capacity == 0)
+		return;
+
+	std::allocator<value_type>().deallocate(_slots, _capacity);
+	std::allocator<signed char>().deallocate(_ctrl, _capacity + group_width);
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+void inplace_flat_map<Key, T, Hash, KeyEqual>::destroy_slots() noexcept
+{
+	if (std::is_trivially_destructible<value_type>::value)
+		return;
+
+	for (size_type i = 0; i != _capacity; ++i)
+		if (_ctrl[i] >= 0)
+			_slots[i].~value_type();
+}
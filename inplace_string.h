@@ -5,9 +5,29 @@
 #include <algorithm>
 #include <type_traits>
 #include <limits>
+#include <stdexcept>
+#include <exception>
+#include <string>
+#include <vector>
+#include <iterator>
+#include <ostream>
+#include <istream>
+#include <locale>
+#include <cstring>
+#include <cstdint>
+#include <atomic>
+#include <system_error>
+
+#if __has_include(<charconv>)
+#include <charconv>
+#define INPLACE_STRING_HAS_TO_CHARS 1
+#else
+#define INPLACE_STRING_HAS_TO_CHARS 0
+#endif
 
 #if defined _NO_EXCEPTIONS
-#include <iostream>
+#include <cstdio>
+#include <cstdlib>
 #endif
 
 #if __has_include(<string_view>)
@@ -18,16 +38,74 @@ template <typename CharT, typename Traits> using basic_string_view = std::basic_
 template <typename CharT, typename Traits>  using basic_string_view = std::experimental::basic_string_view<CharT, Traits>;
 #endif
 
+// SSE2 is part of the x86-64 baseline, SSSE3 and AVX2 kernels are compiled with a target attribute and selected
+// at runtime.
+// Define INPLACE_STRING_NO_SIMD to only use the portable code paths.
+#if !defined INPLACE_STRING_NO_SIMD && (defined __x86_64__ || defined _M_X64 || (defined __i386__ && defined __SSE2__))
+#define INPLACE_STRING_SSE2 1
+#include <immintrin.h>
+#if defined _MSC_VER
+#define INPLACE_STRING_TARGET_SSSE3
+#define INPLACE_STRING_TARGET_AVX2
+#else
+#define INPLACE_STRING_TARGET_SSSE3 __attribute__((target("ssse3")))
+#define INPLACE_STRING_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+#if defined _MSC_VER
+#include <intrin.h>
+#endif
+
+// From C++20 on, basic_inplace_string is usable in constant expressions: C++20 allows storage to stay
+// uninitialized in constexpr functions and tells constant evaluation apart, so that the vectorized and memcpy
+// paths are only taken at run time.
+#if defined __cpp_lib_is_constant_evaluated && defined __cpp_constexpr && __cpp_constexpr >= 201907L
+#define INPLACE_STRING_HAS_CONSTEXPR 1
+#define INPLACE_STRING_CONSTEXPR constexpr
+#else
+#define INPLACE_STRING_HAS_CONSTEXPR 0
+#define INPLACE_STRING_CONSTEXPR
+#endif
+
+// From C++20 on, format strings are parsed at compile time.
+#if defined __cpp_consteval && __cpp_consteval >= 201811L
+#define INPLACE_STRING_HAS_CONSTEVAL 1
+#define INPLACE_STRING_CONSTEVAL consteval
+#else
+#define INPLACE_STRING_HAS_CONSTEVAL 0
+#define INPLACE_STRING_CONSTEVAL constexpr
+#endif
+
+// Tells the optimizer that a condition holds, such as the size being at most N, which it cannot know from
+// the size field. Checked by assert in debug builds.
+#if defined __GNUC__
+#define INPLACE_STRING_ASSUME(cond) do { assert(cond); if (!(cond)) __builtin_unreachable(); } while (false)
+#elif defined _MSC_VER
+#define INPLACE_STRING_ASSUME(cond) do { assert(cond); __assume(cond); } while (false)
+#else
+#define INPLACE_STRING_ASSUME(cond) assert(cond)
+#endif
+
 namespace detail
 {
 
+constexpr bool is_constant_evaluated() noexcept
+{
+#if INPLACE_STRING_HAS_CONSTEXPR
+	return std::is_constant_evaluated();
+#else
+	return false;
+#endif
+}
+
 template <typename T>
-inline void throw_helper(const std::string& msg)
+[[noreturn]] inline void throw_helper(const char* msg)
 {
 #ifndef _NO_EXCEPTIONS
 	throw T(msg);
 #else
-	std::cerr << msg.c_str() << "\n";
+	std::fprintf(stderr, "%s\n", msg);
 	std::abort();
 #endif
 }
@@ -57,21 +135,300 @@ struct is_exactly_input_iterator :
 struct is_exactly_input_iterator_tag {};
 struct is_input_iterator_tag {};
 
+template <typename Lhs, typename Rhs>
+class concat_expr;
+
+template <typename String, bool Enabled>
+struct inplace_string_hash;
+
+// Vectorized kernels and bitmaps only apply to the standard traits, where eq() is a plain bitwise comparison.
+template <typename CharT, typename Traits>
+struct is_bitwise_comparable :
+	public std::integral_constant<bool,
+		std::is_same<Traits, std::char_traits<CharT>>::value
+		&& std::is_integral<CharT>::value>
+{};
+
 template <typename CharT, typename Traits>
 const CharT* search_substring(const CharT* first1, const CharT* last1, const CharT* first2, const CharT* last2);
 
+template <std::size_t Count, typename CharT, typename Traits>
+std::size_t find_char(const CharT* data, std::size_t pos, std::size_t size, CharT ch);
+
+template <std::size_t Count, typename CharT, typename Traits>
+std::size_t find_last_char(const CharT* data, std::size_t last, CharT ch);
+
+template <std::size_t Count, typename CharT, typename Traits>
+std::size_t find_first_of(const CharT* data, std::size_t pos, std::size_t size, const CharT* set, std::size_t count, bool not_of);
+
+template <std::size_t Count, typename CharT, typename Traits>
+std::size_t find_last_of(const CharT* data, std::size_t last, const CharT* set, std::size_t count, bool not_of);
+
+// Hash value stored next to the characters, computed on first use. 0 stands for "not computed": a computed 0
+// is stored as 1. The value is atomic so that concurrent readers of a const string can fill it; relaxed
+// accesses are plain loads and stores on the usual targets.
+template <bool Enabled>
+class hash_cache
+{
+public:
+	constexpr void invalidate_hash() const noexcept {}
+
+	template <typename Compute>
+	std::size_t cached_hash(Compute compute) const noexcept { return compute(); }
+
+	constexpr bool hash_differs(const hash_cache&) const noexcept { return false; }
+};
+
+template <>
+class hash_cache<true>
+{
+public:
+	hash_cache() noexcept = default;
+	hash_cache(const hash_cache& other) noexcept : _hash(other._hash.load(std::memory_order_relaxed)) {}
+
+	hash_cache& operator=(const hash_cache& other) noexcept
+	{
+		_hash.store(other._hash.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		return *this;
+	}
+
+	void invalidate_hash() const noexcept { _hash.store(0, std::memory_order_relaxed); }
+
+	template <typename Compute>
+	std::size_t cached_hash(Compute compute) const noexcept
+	{
+		std::size_t h = _hash.load(std::memory_order_relaxed);
+		if (h == 0)
+		{
+			h = compute();
+			h += h == 0;
+			_hash.store(h, std::memory_order_relaxed);
+		}
+		return h;
+	}
+
+	bool hash_differs(const hash_cache& other) const noexcept
+	{
+		const std::size_t h = _hash.load(std::memory_order_relaxed);
+		const std::size_t other_h = other._hash.load(std::memory_order_relaxed);
+		return h != 0 && other_h != 0 && h != other_h;
+	}
+
+private:
+	mutable std::atomic<std::size_t> _hash{0};
+};
+
+// Overflow flag of inplace_string_overflow::saturate, stored after the hash cache
+template <bool Enabled, typename Base>
+class overflow_flag : public Base
+{
+public:
+	constexpr bool get_overflow() const noexcept { return false; }
+	INPLACE_STRING_CONSTEXPR void set_overflow(bool) noexcept {}
+	INPLACE_STRING_CONSTEXPR void swap_overflow(overflow_flag&) noexcept {}
+};
+
+template <typename Base>
+class overflow_flag<true, Base> : public Base
+{
+public:
+	constexpr bool get_overflow() const noexcept { return _overflow; }
+	INPLACE_STRING_CONSTEXPR void set_overflow(bool overflow) noexcept { _overflow = overflow; }
+
+	INPLACE_STRING_CONSTEXPR void swap_overflow(overflow_flag& other) noexcept
+	{
+		const bool overflow = _overflow;
+		_overflow = other._overflow;
+		other._overflow = overflow;
+	}
+
+private:
+	bool _overflow = false;
+};
+
+// Strings of single-byte characters with N < 16 fit in two 64-bit registers. Their characters are loaded as
+// big-endian integers, so that integer ordering is the lexicographical ordering of unsigned characters, which
+// is how std::char_traits<char> compares.
+template <std::size_t N, typename CharT, typename Traits>
+struct is_register_comparable :
+	public std::integral_constant<bool,
+		is_bitwise_comparable<CharT, Traits>::value
+		&& sizeof(CharT) == 1
+		&& (std::is_same<CharT, char>::value || std::is_unsigned<CharT>::value)
+		&& N < 16>
+{};
+
+inline std::uint64_t from_big_endian(std::uint64_t word) noexcept
+{
+#if defined __BYTE_ORDER__ && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	return word;
+#elif defined __GNUC__
+	return __builtin_bswap64(word);
+#elif defined _MSC_VER
+	return _byteswap_uint64(word);
+#else
+	word = ((word & 0x00ff00ff00ff00ffull) << 8) | ((word >> 8) & 0x00ff00ff00ff00ffull);
+	word = ((word & 0x0000ffff0000ffffull) << 16) | ((word >> 16) & 0x0000ffff0000ffffull);
+	return (word << 32) | (word >> 32);
+#endif
+}
+
+// Characters [Offset, Offset + 8) of a string of capacity N as a big-endian integer, the characters past size
+// being zero. A string and the same string followed by zeros give the same words: ties are broken by size.
+// The load may include the size character, which is always masked: for N = 7 or 15, it is a full 8-byte load.
+template <std::size_t N, std::size_t Offset>
+inline std::uint64_t load_register_word(const void* data, std::size_t size) noexcept
+{
+	constexpr std::size_t count = Offset < N ? std::min<std::size_t>(8, N + 1 - Offset) : 0;
+
+	std::uint64_t word = 0;
+	std::memcpy(&word, static_cast<const unsigned char*>(data) + Offset, count);
+	word = from_big_endian(word);
+
+	if (size <= Offset)
+		return 0;
+	if (size - Offset < 8)
+		word &= ~(~std::uint64_t{0} >> ((size - Offset) * 8));
+	return word;
+}
+
+template <std::size_t N>
+inline int register_compare(const void* lhs, std::size_t lhs_size, const void* rhs, std::size_t rhs_size) noexcept
+{
+	const std::uint64_t l0 = load_register_word<N, 0>(lhs, lhs_size);
+	const std::uint64_t r0 = load_register_word<N, 0>(rhs, rhs_size);
+	if (l0 != r0)
+		return l0 < r0 ? -1 : 1;
+
+	if (N > 8)
+	{
+		const std::uint64_t l1 = load_register_word<N, 8>(lhs, lhs_size);
+		const std::uint64_t r1 = load_register_word<N, 8>(rhs, rhs_size);
+		if (l1 != r1)
+			return l1 < r1 ? -1 : 1;
+	}
+
+	return lhs_size < rhs_size ? -1 : (lhs_size != rhs_size);
+}
+
+template <std::size_t N>
+inline bool register_equal(const void* lhs, std::size_t lhs_size, const void* rhs, std::size_t rhs_size) noexcept
+{
+	const std::uint64_t diff0 = load_register_word<N, 0>(lhs, lhs_size) ^ load_register_word<N, 0>(rhs, rhs_size);
+	const std::uint64_t diff1 = N > 8 ? load_register_word<N, 8>(lhs, lhs_size) ^ load_register_word<N, 8>(rhs, rhs_size) : 0;
+	return (diff0 | diff1 | (lhs_size ^ rhs_size)) == 0;
+}
+
+// Where basic_inplace_string keeps its size. By default the last character holds N - size, which doubles as the
+// terminator of a full string. With a trailer, the size is stored after the terminator, or right after the
+// characters of an unterminated string, in the characters of a 16- or 32-bit integer, least significant digit
+// first.
+template <std::size_t N, typename CharT, bool Trailer, bool Terminated>
+struct size_field
+{
+	using type = typename std::conditional<Trailer,
+		typename std::conditional<N <= std::numeric_limits<std::uint16_t>::max(), std::uint16_t, std::uint32_t>::type,
+		std::make_unsigned_t<CharT>>::type;
+
+	static constexpr const std::size_t trailer = Trailer ? (sizeof(type) + sizeof(CharT) - 1) / sizeof(CharT) : 0;
+	static constexpr const std::size_t trailer_offset = Terminated ? N + 1 : N;
+
+	// Characters of storage
+	static constexpr const std::size_t storage = Trailer ? trailer_offset + trailer : N + 1;
+};
+
+template <std::size_t N, typename CharT, typename Policy>
+using size_field_of = size_field<N, CharT,
+								 Policy::size_trailer || (N > std::numeric_limits<std::make_unsigned_t<CharT>>::max()),
+								 Policy::null_terminated>;
+
 }
 
+// What a mutation does when its result would exceed the capacity of the string. Errors on positions always
+// throw std::out_of_range.
+enum class inplace_string_overflow
+{
+	throw_exception, // std::length_error, the string is left unchanged
+	truncate,        // only the characters that fit are inserted
+	saturate,        // truncate, and set overflowed() until clear_overflow()
+	terminate        // std::terminate, without building an error message
+};
+
+// Policies customize the storage of basic_inplace_string. A custom policy derives from
+// inplace_string_default_policy and overrides the options it needs.
+struct inplace_string_default_policy
+{
+	// The characters between size() and N are always zero: equality compares the whole storage and hashing
+	// runs over a fixed-size block. Every mutation shrinking the string has to clear the characters it
+	// releases. Writing past size() through data() or operator[] breaks the invariant.
+	static constexpr bool zero_padded = false;
+
+	// The hash is computed once and stored next to the characters, std::hash returns it without rehashing
+	// and equality uses it to reject different strings early. Every mutating member, as well as the
+	// non-const accessors, drops it. A pointer, reference or iterator obtained before the hash is computed
+	// must not be written through afterwards: the stale hash makes equality fail. Call the accessor again.
+	static constexpr bool cache_hash = false;
+
+	static constexpr inplace_string_overflow overflow = inplace_string_overflow::throw_exception;
+
+	// The size is stored in a 16- or 32-bit trailer after the terminator, rather than in the last character.
+	// Capacities that do not fit in a character, such as N > 255 for char, always use the trailer.
+	static constexpr bool size_trailer = false;
+
+	// Mutations write a terminator after the last character. Without it, c_str() does not compile and the
+	// characters are only accessed through data(), size() and string_view; a trailer then starts right after
+	// the N characters.
+	static constexpr bool null_terminated = true;
+};
+
+struct inplace_string_zero_padded_policy : inplace_string_default_policy
+{
+	static constexpr bool zero_padded = true;
+};
+
+struct inplace_string_cached_hash_policy : inplace_string_default_policy
+{
+	static constexpr bool cache_hash = true;
+};
+
+struct inplace_string_truncating_policy : inplace_string_default_policy
+{
+	static constexpr inplace_string_overflow overflow = inplace_string_overflow::truncate;
+};
+
+struct inplace_string_saturating_policy : inplace_string_default_policy
+{
+	static constexpr inplace_string_overflow overflow = inplace_string_overflow::saturate;
+};
+
+struct inplace_string_terminating_policy : inplace_string_default_policy
+{
+	static constexpr inplace_string_overflow overflow = inplace_string_overflow::terminate;
+};
+
+struct inplace_string_size_trailer_policy : inplace_string_default_policy
+{
+	static constexpr bool size_trailer = true;
+};
+
+struct inplace_string_unterminated_policy : inplace_string_default_policy
+{
+	static constexpr bool null_terminated = false;
+};
+
 template <
 	std::size_t N,
 	typename CharT = char,
-	typename Traits = std::char_traits<CharT>>
-class basic_inplace_string
+	typename Traits = std::char_traits<CharT>,
+	typename Policy = inplace_string_default_policy>
+class basic_inplace_string :
+	private detail::overflow_flag<Policy::overflow == inplace_string_overflow::saturate, detail::hash_cache<Policy::cache_hash>>
 {
 public:
 	using __self = basic_inplace_string;
 
 	using traits_type = Traits;
+	using policy_type = Policy;
 	using value_type = CharT;
 	using reference = value_type&;
 	using const_reference = const value_type&;
@@ -86,228 +443,364 @@ public:
 
 private:
 	using static_size_type = std::make_unsigned_t<value_type>;
+	using size_field = detail::size_field_of<N, CharT, Policy>;
+	using view_type = basic_string_view<CharT, Traits>;
 
 public:
 	static constexpr const size_type npos = static_cast<size_type>(-1);
 
-	static_assert(std::is_pod<value_type>::value, "CharT type of basic_inplace_string must be a POD");
+	static_assert(std::is_trivial<value_type>::value && std::is_standard_layout<value_type>::value, "CharT type of basic_inplace_string must be a POD");
 	static_assert(std::is_same<value_type, typename traits_type::char_type>::value, "CharT type must be the same type as Traits::char_type");
-	static_assert(N <= std::numeric_limits<static_size_type>::max(), "N must be smaller than the maximum static_size possible with this CharT type");
+	static_assert(N <= std::numeric_limits<typename size_field::type>::max(), "N must be smaller than the maximum size of the size field");
 
-	explicit basic_inplace_string() noexcept;
+	explicit INPLACE_STRING_CONSTEXPR basic_inplace_string() noexcept;
 
 	template <std::size_t M>
-	basic_inplace_string(const value_type(&str)[M]) noexcept;
+	INPLACE_STRING_CONSTEXPR basic_inplace_string(const value_type(&str)[M]) noexcept;
 
 	template <typename ValueTypePtr, typename X = typename std::enable_if<std::is_same<ValueTypePtr, const value_type*>::value>::type>
-	basic_inplace_string(ValueTypePtr str);
+	INPLACE_STRING_CONSTEXPR basic_inplace_string(ValueTypePtr str);
 
-	basic_inplace_string(size_type count, value_type ch);
-	basic_inplace_string(const std::basic_string<CharT, Traits>& other, size_type pos);
-	basic_inplace_string(const basic_inplace_string& other, size_type pos);
-	basic_inplace_string(const std::basic_string<CharT, Traits>& other, size_type pos, size_type count);
-	basic_inplace_string(const basic_inplace_string& other, size_type pos, size_type count);
-	basic_inplace_string(const value_type* str, size_type count);
+	template <typename Lhs, typename Rhs>
+	INPLACE_STRING_CONSTEXPR basic_inplace_string(const detail::concat_expr<Lhs, Rhs>& expr) noexcept;
+
+	INPLACE_STRING_CONSTEXPR basic_inplace_string(size_type count, value_type ch);
+	INPLACE_STRING_CONSTEXPR basic_inplace_string(const std::basic_string<CharT, Traits>& other, size_type pos);
+	INPLACE_STRING_CONSTEXPR basic_inplace_string(const basic_inplace_string& other, size_type pos);
+	INPLACE_STRING_CONSTEXPR basic_inplace_string(const std::basic_string<CharT, Traits>& other, size_type pos, size_type count);
+	INPLACE_STRING_CONSTEXPR basic_inplace_string(const basic_inplace_string& other, size_type pos, size_type count);
+	INPLACE_STRING_CONSTEXPR basic_inplace_string(const value_type* str, size_type count);
 
 	template <typename InputIt>
-	basic_inplace_string(InputIt first, InputIt last);
+	INPLACE_STRING_CONSTEXPR basic_inplace_string(InputIt first, InputIt last);
 
-	basic_inplace_string(const std::initializer_list<CharT>& ilist);
+	INPLACE_STRING_CONSTEXPR basic_inplace_string(const std::initializer_list<CharT>& ilist);
 
-	explicit basic_inplace_string(const std::basic_string<CharT, Traits>& str);
-	explicit basic_inplace_string(basic_string_view<CharT, Traits> sv);
+	explicit INPLACE_STRING_CONSTEXPR basic_inplace_string(const std::basic_string<CharT, Traits>& str);
+	explicit INPLACE_STRING_CONSTEXPR basic_inplace_string(basic_string_view<CharT, Traits> sv);
 
 	template <typename T,
 			  typename X = typename std::enable_if<std::is_convertible<const T&, basic_string_view<CharT, Traits>>::value>::type>
-	basic_inplace_string(const T& t, size_type pos, size_type n);
+	INPLACE_STRING_CONSTEXPR basic_inplace_string(const T& t, size_type pos, size_type n);
 
-	reference       at(size_type i);
-	const_reference at(size_type i) const;
+	INPLACE_STRING_CONSTEXPR reference       at(size_type i);
+	INPLACE_STRING_CONSTEXPR const_reference at(size_type i) const;
 
-	reference       operator[](size_type i)       { assert(i <= size()); return _data[i]; }
-	const_reference operator[](size_type i) const { assert(i <= size()); return _data[i]; }
+	INPLACE_STRING_CONSTEXPR reference       operator[](size_type i)       { assert(i <= size()); this->invalidate_hash(); return _data[i]; }
+	INPLACE_STRING_CONSTEXPR const_reference operator[](size_type i) const { assert(i <= size()); return _data[i]; }
 
-	reference       front()       { assert(!empty()); return _data[0]; }
-	const_reference front() const { assert(!empty()); return _data[0]; }
-	reference       back()        { assert(!empty()); return _data[size() - 1]; }
-	const_reference back() const  { assert(!empty()); return _data[size() - 1]; }
+	INPLACE_STRING_CONSTEXPR reference       front()       { assert(!empty()); this->invalidate_hash(); return _data[0]; }
+	INPLACE_STRING_CONSTEXPR const_reference front() const { assert(!empty()); return _data[0]; }
+	INPLACE_STRING_CONSTEXPR reference       back()        { assert(!empty()); this->invalidate_hash(); return _data[size() - 1]; }
+	INPLACE_STRING_CONSTEXPR const_reference back() const  { assert(!empty()); return _data[size() - 1]; }
 
-	value_type*       data() noexcept        { return _data.data(); }
-	const value_type* data() const noexcept  { return _data.data(); }
-	const value_type* c_str() const noexcept { return _data.data(); }
+	INPLACE_STRING_CONSTEXPR value_type*       data() noexcept        { this->invalidate_hash(); return _data.data(); }
+	INPLACE_STRING_CONSTEXPR const value_type* data() const noexcept  { return _data.data(); }
+	INPLACE_STRING_CONSTEXPR const value_type* c_str() const noexcept
+	{
+		static_assert(Policy::null_terminated, "basic_inplace_string: c_str() of a string without terminator");
+		return _data.data();
+	}
 
-	operator basic_string_view<CharT, Traits>() const noexcept { return {_data.data(), size()}; }
+	INPLACE_STRING_CONSTEXPR operator basic_string_view<CharT, Traits>() const noexcept { return {_data.data(), size()}; }
 
-	iterator       begin() noexcept        { return &_data[0]; }
-	const_iterator begin() const noexcept  { return &_data[0]; }
-	const_iterator cbegin() const noexcept { return begin(); }
-	iterator       end() noexcept          { return &_data[size()]; }
-	const_iterator end() const noexcept    { return &_data[size()]; }
-	const_iterator cend() const noexcept   { return end(); }
+	INPLACE_STRING_CONSTEXPR iterator       begin() noexcept        { this->invalidate_hash(); return &_data[0]; }
+	INPLACE_STRING_CONSTEXPR const_iterator begin() const noexcept  { return &_data[0]; }
+	INPLACE_STRING_CONSTEXPR const_iterator cbegin() const noexcept { return begin(); }
+	INPLACE_STRING_CONSTEXPR iterator       end() noexcept          { this->invalidate_hash(); return &_data[size()]; }
+	INPLACE_STRING_CONSTEXPR const_iterator end() const noexcept    { return &_data[size()]; }
+	INPLACE_STRING_CONSTEXPR const_iterator cend() const noexcept   { return end(); }
 
-	reverse_iterator       rbegin() noexcept        { return reverse_iterator(end()); }
-	const_reverse_iterator rbegin() const noexcept  { return const_reverse_iterator(cend()); }
-	const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator(cend()); }
+	INPLACE_STRING_CONSTEXPR reverse_iterator       rbegin() noexcept        { return reverse_iterator(end()); }
+	INPLACE_STRING_CONSTEXPR const_reverse_iterator rbegin() const noexcept  { return const_reverse_iterator(cend()); }
+	INPLACE_STRING_CONSTEXPR const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator(cend()); }
 
-	reverse_iterator       rend() noexcept        { return reverse_iterator(begin()); }
-	const_reverse_iterator rend() const noexcept  { return const_reverse_iterator(cbegin()); }
-	const_reverse_iterator crend() const noexcept { return const_reverse_iterator(cbegin()); }
+	INPLACE_STRING_CONSTEXPR reverse_iterator       rend() noexcept        { return reverse_iterator(begin()); }
+	INPLACE_STRING_CONSTEXPR const_reverse_iterator rend() const noexcept  { return const_reverse_iterator(cbegin()); }
+	INPLACE_STRING_CONSTEXPR const_reverse_iterator crend() const noexcept { return const_reverse_iterator(cbegin()); }
 
-	bool empty() const noexcept { return get_remaining_size() == max_size(); }
+	INPLACE_STRING_CONSTEXPR bool empty() const noexcept { return size() == 0; }
 
-	size_type size() const noexcept { return N - reinterpret_cast<const static_size_type&>(_data[N]); }
-	size_type length() const noexcept { return size(); }
+	INPLACE_STRING_CONSTEXPR size_type size() const noexcept;
+	INPLACE_STRING_CONSTEXPR size_type length() const noexcept { return size(); }
 
 	static constexpr size_type max_size() noexcept { return N; }
 	static constexpr size_type capacity() noexcept { return N; }
 
-	void shrink_to_fit() noexcept  {}
+	INPLACE_STRING_CONSTEXPR void shrink_to_fit() noexcept  {}
+
+	// With inplace_string_overflow::saturate, whether a mutation was truncated since the string was built or
+	// cleared, or since the last clear_overflow(). Always false with the other policies.
+	INPLACE_STRING_CONSTEXPR bool overflowed() const noexcept { return this->get_overflow(); }
+	INPLACE_STRING_CONSTEXPR void clear_overflow() noexcept { this->set_overflow(false); }
 
-	void clear() noexcept { *this = __self{}; }
+	INPLACE_STRING_CONSTEXPR void clear() noexcept { *this = __self{}; }
 
-	basic_inplace_string& insert(size_type index, size_type count, value_type ch);
-	basic_inplace_string& insert(size_type index, const value_type* str);
-	basic_inplace_string& insert(size_type index, const value_type* str, size_type count);
-	basic_inplace_string& insert(size_type index, const basic_inplace_string& str);
-	basic_inplace_string& insert(size_type index, const basic_inplace_string& str, size_type index_str, size_type count = npos);
-	iterator insert(const_iterator pos, value_type ch);
-	iterator insert(const_iterator pos, size_type count, value_type ch);
+	INPLACE_STRING_CONSTEXPR basic_inplace_string& insert(size_type index, size_type count, value_type ch);
+	INPLACE_STRING_CONSTEXPR basic_inplace_string& insert(size_type index, const value_type* str);
+	INPLACE_STRING_CONSTEXPR basic_inplace_string& insert(size_type index, const value_type* str, size_type count);
+	INPLACE_STRING_CONSTEXPR basic_inplace_string& insert(size_type index, const basic_inplace_string& str);
+	INPLACE_STRING_CONSTEXPR basic_inplace_string& insert(size_type index, const basic_inplace_string& str, size_type index_str, size_type count = npos);
+	INPLACE_STRING_CONSTEXPR iterator insert(const_iterator pos, value_type ch);
+	INPLACE_STRING_CONSTEXPR iterator insert(const_iterator pos, size_type count, value_type ch);
 
 	template <typename InputIt>
-	iterator insert(const_iterator pos, InputIt first, InputIt last);
+	INPLACE_STRING_CONSTEXPR iterator insert(const_iterator pos, InputIt first, InputIt last);
 
-	iterator insert(const_iterator pos, std::initializer_list<CharT> ilist);
-	basic_inplace_string& insert(size_type pos, basic_string_view<CharT, Traits> view);
+	INPLACE_STRING_CONSTEXPR iterator insert(const_iterator pos, std::initializer_list<CharT> ilist);
+	INPLACE_STRING_CONSTEXPR basic_inplace_string& insert(size_type pos, basic_string_view<CharT, Traits> view);
 
 	template <typename T,
 			  typename X = typename std::enable_if<std::is_convertible<const T&, basic_string_view<CharT, Traits>>::value
 												   && !std::is_convertible<const T&, const CharT*>::value>::type>
-	basic_inplace_string& insert(size_type pos, const T& t, size_type index_str, size_type count = npos);
+	INPLACE_STRING_CONSTEXPR basic_inplace_string& insert(size_type pos, const T& t, size_type index_str, size_type count = npos);
 
-	basic_inplace_string& erase(size_type pos = 0, size_type count = npos);
-	iterator erase(const_iterator pos);
-	iterator erase(const_iterator first, const_iterator last);
+	INPLACE_STRING_CONSTEXPR basic_inplace_string& erase(size_type pos = 0, size_type count = npos);
+	INPLACE_STRING_CONSTEXPR iterator erase(const_iterator pos);
+	INPLACE_STRING_CONSTEXPR iterator erase(const_iterator first, const_iterator last);
 
-	void push_back(value_type ch) { append(1, ch); }
-	void pop_back()               { erase(size() - 1, 1); }
+	INPLACE_STRING_CONSTEXPR void push_back(value_type ch) { append(1, ch); }
+	INPLACE_STRING_CONSTEXPR void pop_back()               { erase(size() - 1, 1); }
 
-	basic_inplace_string& append(size_type count, value_type ch);
-	basic_inplace_string& append(const std::basic_string<CharT, Traits>& str);
-	basic_inplace_string& append(const std::basic_string<CharT, Traits>& str, size_type pos, size_type count = npos);
-	basic_inplace_string& append(const value_type* str, size_type count);
-	basic_inplace_string& append(const value_type* str);
+	INPLACE_STRING_CONSTEXPR basic_inplace_string& append(size_type count, value_type ch);
+	INPLACE_STRING_CONSTEXPR basic_inplace_string& append(const std::basic_string<CharT, Traits>& str);
+	INPLACE_STRING_CONSTEXPR basic_inplace_string& append(const std::basic_string<CharT, Traits>& str, size_type pos, size_type count = npos);
+	INPLACE_STRING_CONSTEXPR basic_inplace_string& append(const value_type* str, size_type count);
+	INPLACE_STRING_CONSTEXPR basic_inplace_string& append(const value_type* str);
 
 	template <typename InputIt>
-	basic_inplace_string& append(InputIt first, InputIt last);
+	INPLACE_STRING_CONSTEXPR basic_inplace_string& append(InputIt first, InputIt last);
 
-	basic_inplace_string& append(std::initializer_list<value_type> ilist);
-	basic_inplace_string& append(const basic_string_view<CharT, Traits>& view);
+	INPLACE_STRING_CONSTEXPR basic_inplace_string& append(std::initializer_list<value_type> ilist);
+	INPLACE_STRING_CONSTEXPR basic_inplace_string& append(const basic_string_view<CharT, Traits>& view);
 
 	template <typename T,
 			  typename X = typename std::enable_if<std::is_convertible<const T&, basic_string_view<CharT, Traits>>::value
 												   && !std::is_convertible<const T&, const CharT*>::value>::type>
-	basic_inplace_string& append(const T& t, size_type pos, size_type count = npos);
-
-	basic_inplace_string& operator+=(const std::basic_string<CharT, Traits>& str) { return append(str); }
-	basic_inplace_string& operator+=(value_type ch) { push_back(ch); return *this; }
-	basic_inplace_string& operator+=(const value_type* str) { return append(str); }
-	basic_inplace_string& operator+=(std::initializer_list<value_type> ilist) {return append(ilist); }
-	basic_inplace_string& operator+=(basic_string_view<CharT, Traits> view) { return append(view); }
-
-	int compare(const basic_inplace_string& str) const noexcept;
-	int compare(size_type pos1, size_type count1, const basic_inplace_string& str) const;
-	int compare(size_type pos1, size_type count1, const basic_inplace_string& str, size_type pos2, size_type count2 = npos) const;
-	int compare(const value_type* str) const;
-	int compare(size_type pos1, size_type count1, const value_type* str) const;
-	int compare(size_type pos1, size_type count1, const value_type* str, size_type count2) const;
-	int compare(basic_string_view<CharT, Traits> sv) const noexcept;
-	int compare(size_type pos1, size_type count1, basic_string_view<CharT, Traits> sv) const;
+	INPLACE_STRING_CONSTEXPR basic_inplace_string& append(const T& t, size_type pos, size_type count = npos);
+
+	INPLACE_STRING_CONSTEXPR basic_inplace_string& operator+=(const std::basic_string<CharT, Traits>& str) { return append(str); }
+	INPLACE_STRING_CONSTEXPR basic_inplace_string& operator+=(value_type ch) { push_back(ch); return *this; }
+	INPLACE_STRING_CONSTEXPR basic_inplace_string& operator+=(const value_type* str) { return append(str); }
+	INPLACE_STRING_CONSTEXPR basic_inplace_string& operator+=(std::initializer_list<value_type> ilist) {return append(ilist); }
+	INPLACE_STRING_CONSTEXPR basic_inplace_string& operator+=(basic_string_view<CharT, Traits> view) { return append(view); }
+
+	INPLACE_STRING_CONSTEXPR int compare(const basic_inplace_string& str) const noexcept;
+	INPLACE_STRING_CONSTEXPR int compare(size_type pos1, size_type count1, const basic_inplace_string& str) const;
+	INPLACE_STRING_CONSTEXPR int compare(size_type pos1, size_type count1, const basic_inplace_string& str, size_type pos2, size_type count2 = npos) const;
+	INPLACE_STRING_CONSTEXPR int compare(const value_type* str) const;
+	INPLACE_STRING_CONSTEXPR int compare(size_type pos1, size_type count1, const value_type* str) const;
+	INPLACE_STRING_CONSTEXPR int compare(size_type pos1, size_type count1, const value_type* str, size_type count2) const;
+	INPLACE_STRING_CONSTEXPR int compare(basic_string_view<CharT, Traits> sv) const noexcept;
+	INPLACE_STRING_CONSTEXPR int compare(size_type pos1, size_type count1, basic_string_view<CharT, Traits> sv) const;
 
 	template <typename T,
 			  typename X = typename std::enable_if<std::is_convertible<const T&, basic_string_view<CharT, Traits>>::value
 												   && !std::is_convertible<const T&, const CharT*>::value>::type>
-	int compare(size_type pos1, size_type count1, const T& t, size_type pos2, size_type count2 = npos) const;
+	INPLACE_STRING_CONSTEXPR int compare(size_type pos1, size_type count1, const T& t, size_type pos2, size_type count2 = npos) const;
 
-	basic_inplace_string& replace(size_type pos, size_type count, const basic_inplace_string& str);
-	basic_inplace_string& replace(const_iterator first, const_iterator last, const basic_inplace_string& str);
-	basic_inplace_string& replace(size_type pos, size_type count, const basic_inplace_string& str, size_type pos2, size_type count2 = npos);
+	INPLACE_STRING_CONSTEXPR basic_inplace_string& replace(size_type pos, size_type count, const basic_inplace_string& str);
+	INPLACE_STRING_CONSTEXPR basic_inplace_string& replace(const_iterator first, const_iterator last, const basic_inplace_string& str);
+	INPLACE_STRING_CONSTEXPR basic_inplace_string& replace(size_type pos, size_type count, const basic_inplace_string& str, size_type pos2, size_type count2 = npos);
 
 	template <class InputIt>
-	basic_inplace_string& replace(const_iterator first, const_iterator last, InputIt first2, InputIt last2);
-
-	basic_inplace_string& replace(size_type pos, size_type count, const CharT* str, size_type count2);
-	basic_inplace_string& replace(const_iterator first, const_iterator last, const CharT* str, size_type count2);
-	basic_inplace_string& replace(size_type pos, size_type count, const CharT* str);
-	basic_inplace_string& replace(const_iterator first, const_iterator last, const CharT* str);
-	basic_inplace_string& replace(size_type pos, size_type count, size_type count2, value_type ch);
-	basic_inplace_string& replace(const_iterator first, const_iterator last, size_type count2, value_type ch);
-	basic_inplace_string& replace(const_iterator first, const_iterator last, std::initializer_list<value_type> ilist);
-	basic_inplace_string& replace(size_type pos, size_type count, basic_string_view<CharT, Traits> sv);
-	basic_inplace_string& replace(const_iterator first, const_iterator last, basic_string_view<CharT, Traits> sv);
+	INPLACE_STRING_CONSTEXPR basic_inplace_string& replace(const_iterator first, const_iterator last, InputIt first2, InputIt last2);
+
+	INPLACE_STRING_CONSTEXPR basic_inplace_string& replace(size_type pos, size_type count, const CharT* str, size_type count2);
+	INPLACE_STRING_CONSTEXPR basic_inplace_string& replace(const_iterator first, const_iterator last, const CharT* str, size_type count2);
+	INPLACE_STRING_CONSTEXPR basic_inplace_string& replace(size_type pos, size_type count, const CharT* str);
+	INPLACE_STRING_CONSTEXPR basic_inplace_string& replace(const_iterator first, const_iterator last, const CharT* str);
+	INPLACE_STRING_CONSTEXPR basic_inplace_string& replace(size_type pos, size_type count, size_type count2, value_type ch);
+	INPLACE_STRING_CONSTEXPR basic_inplace_string& replace(const_iterator first, const_iterator last, size_type count2, value_type ch);
+	INPLACE_STRING_CONSTEXPR basic_inplace_string& replace(const_iterator first, const_iterator last, std::initializer_list<value_type> ilist);
+	INPLACE_STRING_CONSTEXPR basic_inplace_string& replace(size_type pos, size_type count, basic_string_view<CharT, Traits> sv);
+	INPLACE_STRING_CONSTEXPR basic_inplace_string& replace(const_iterator first, const_iterator last, basic_string_view<CharT, Traits> sv);
 
 	template <typename T,
 			  typename X = typename std::enable_if<std::is_convertible<const T&, basic_string_view<CharT, Traits>>::value
 												   && !std::is_convertible<const T&, const CharT*>::value>::type>
-	basic_inplace_string& replace(size_type pos, size_type count, const T& t, size_type pos2, size_type count2 = npos);
+	INPLACE_STRING_CONSTEXPR basic_inplace_string& replace(size_type pos, size_type count, const T& t, size_type pos2, size_type count2 = npos);
 
-	basic_inplace_string substr(size_type pos = 0, size_type count = npos) const;
+	INPLACE_STRING_CONSTEXPR basic_inplace_string substr(size_type pos = 0, size_type count = npos) const;
 
-	size_type copy(value_type* dest, size_type count, size_type pos = 0) const;
+	INPLACE_STRING_CONSTEXPR size_type copy(value_type* dest, size_type count, size_type pos = 0) const;
 
-	void resize(size_type sz);
-	void resize(size_type new_size, value_type ch);
+	INPLACE_STRING_CONSTEXPR void resize(size_type sz);
+	INPLACE_STRING_CONSTEXPR void resize(size_type new_size, value_type ch);
 
-	void swap(basic_inplace_string& other) noexcept;
+	// As in C++23: op(data(), count) writes the characters directly and returns the new size, at most count. The
+	// first min(size(), count) characters are the old ones, the rest are unspecified.
+	template <typename Operation>
+	INPLACE_STRING_CONSTEXPR void resize_and_overwrite(size_type count, Operation op);
 
-	size_type find(const basic_inplace_string& other, size_type pos = 0) const noexcept;
-	size_type find(const value_type* str, size_type pos, size_type count) const noexcept;
-	size_type find(const value_type* str, size_type pos = 0) const noexcept;
-	size_type find(value_type ch, size_type pos = 0) const noexcept;
-	size_type find(basic_string_view<CharT, Traits> sv, size_type pos = 0) const noexcept;
+	// Characters past the end of the string, writable in place: prepare_append() hands them out, then
+	// commit_append(count) appends the first count of them. Any other mutation in between discards them.
+	struct write_span
+	{
+		value_type* data;
+		size_type size;
+	};
+
+	INPLACE_STRING_CONSTEXPR write_span prepare_append() noexcept;
+	INPLACE_STRING_CONSTEXPR void commit_append(size_type count) noexcept;
+
+	INPLACE_STRING_CONSTEXPR void swap(basic_inplace_string& other) noexcept;
+
+	INPLACE_STRING_CONSTEXPR size_type find(const basic_inplace_string& other, size_type pos = 0) const noexcept;
+	INPLACE_STRING_CONSTEXPR size_type find(const value_type* str, size_type pos, size_type count) const noexcept;
+	INPLACE_STRING_CONSTEXPR size_type find(const value_type* str, size_type pos = 0) const noexcept;
+	INPLACE_STRING_CONSTEXPR size_type find(value_type ch, size_type pos = 0) const noexcept;
+	INPLACE_STRING_CONSTEXPR size_type find(basic_string_view<CharT, Traits> sv, size_type pos = 0) const noexcept;
+
+	INPLACE_STRING_CONSTEXPR size_type rfind(const basic_inplace_string& other, size_type pos = npos) const noexcept;
+	INPLACE_STRING_CONSTEXPR size_type rfind(const value_type* str, size_type pos, size_type count) const noexcept;
+	INPLACE_STRING_CONSTEXPR size_type rfind(const value_type* str, size_type pos = npos) const noexcept;
+	INPLACE_STRING_CONSTEXPR size_type rfind(value_type ch, size_type pos = npos) const noexcept;
+	INPLACE_STRING_CONSTEXPR size_type rfind(basic_string_view<CharT, Traits> sv, size_type pos = npos) const noexcept;
+
+	INPLACE_STRING_CONSTEXPR size_type find_first_of(const basic_inplace_string& other, size_type pos = 0) const noexcept;
+	INPLACE_STRING_CONSTEXPR size_type find_first_of(const value_type* str, size_type pos, size_type count) const noexcept;
+	INPLACE_STRING_CONSTEXPR size_type find_first_of(const value_type* str, size_type pos = 0) const noexcept;
+	INPLACE_STRING_CONSTEXPR size_type find_first_of(value_type ch, size_type pos = 0) const noexcept;
+	INPLACE_STRING_CONSTEXPR size_type find_first_of(basic_string_view<CharT, Traits> sv, size_type pos = 0) const noexcept;
+
+	INPLACE_STRING_CONSTEXPR size_type find_first_not_of(const basic_inplace_string& other, size_type pos = 0) const noexcept;
+	INPLACE_STRING_CONSTEXPR size_type find_first_not_of(const value_type* str, size_type pos, size_type count) const noexcept;
+	INPLACE_STRING_CONSTEXPR size_type find_first_not_of(const value_type* str, size_type pos = 0) const noexcept;
+	INPLACE_STRING_CONSTEXPR size_type find_first_not_of(value_type ch, size_type pos = 0) const noexcept;
+	INPLACE_STRING_CONSTEXPR size_type find_first_not_of(basic_string_view<CharT, Traits> sv, size_type pos = 0) const noexcept;
+
+	INPLACE_STRING_CONSTEXPR size_type find_last_of(const basic_inplace_string& other, size_type pos = npos) const noexcept;
+	INPLACE_STRING_CONSTEXPR size_type find_last_of(const value_type* str, size_type pos, size_type count) const noexcept;
+	INPLACE_STRING_CONSTEXPR size_type find_last_of(const value_type* str, size_type pos = npos) const noexcept;
+	INPLACE_STRING_CONSTEXPR size_type find_last_of(value_type ch, size_type pos = npos) const noexcept;
+	INPLACE_STRING_CONSTEXPR size_type find_last_of(basic_string_view<CharT, Traits> sv, size_type pos = npos) const noexcept;
+
+	INPLACE_STRING_CONSTEXPR size_type find_last_not_of(const basic_inplace_string& other, size_type pos = npos) const noexcept;
+	INPLACE_STRING_CONSTEXPR size_type find_last_not_of(const value_type* str, size_type pos, size_type count) const noexcept;
+	INPLACE_STRING_CONSTEXPR size_type find_last_not_of(const value_type* str, size_type pos = npos) const noexcept;
+	INPLACE_STRING_CONSTEXPR size_type find_last_not_of(value_type ch, size_type pos = npos) const noexcept;
+	INPLACE_STRING_CONSTEXPR size_type find_last_not_of(basic_string_view<CharT, Traits> sv, size_type pos = npos) const noexcept;
 
 private:
+	template <typename String, bool Enabled>
+	friend struct detail::inplace_string_hash;
+
+	template <std::size_t M, typename C, typename T, typename P>
+	friend INPLACE_STRING_CONSTEXPR bool operator==(const basic_inplace_string<M, C, T, P>& lhs, const basic_inplace_string<M, C, T, P>& rhs);
+
 	template <typename InputIt>
-	basic_inplace_string(InputIt first, InputIt last, detail::is_exactly_input_iterator_tag);
+	INPLACE_STRING_CONSTEXPR basic_inplace_string(InputIt first, InputIt last, detail::is_exactly_input_iterator_tag);
 
 	template <typename InputIt>
-	basic_inplace_string(InputIt first, InputIt last, detail::is_input_iterator_tag);
+	INPLACE_STRING_CONSTEXPR basic_inplace_string(InputIt first, InputIt last, detail::is_input_iterator_tag);
 
 	template <typename InputIt>
-	iterator insert(const_iterator pos, InputIt first, InputIt last, detail::is_exactly_input_iterator_tag);
+	INPLACE_STRING_CONSTEXPR iterator insert(const_iterator pos, InputIt first, InputIt last, detail::is_exactly_input_iterator_tag);
 
 	template <typename InputIt>
-	iterator insert(const_iterator pos, InputIt first, InputIt last, detail::is_input_iterator_tag);
+	INPLACE_STRING_CONSTEXPR iterator insert(const_iterator pos, InputIt first, InputIt last, detail::is_input_iterator_tag);
 
 	template <typename InputIt>
-	basic_inplace_string& replace(const_iterator first, const_iterator last, InputIt first2, InputIt last2, detail::is_exactly_input_iterator_tag);
+	INPLACE_STRING_CONSTEXPR basic_inplace_string& replace(const_iterator first, const_iterator last, InputIt first2, InputIt last2, detail::is_exactly_input_iterator_tag);
 
 	template <typename InputIt>
-	basic_inplace_string& replace(const_iterator first, const_iterator last, InputIt first2, InputIt last2, detail::is_input_iterator_tag);
+	INPLACE_STRING_CONSTEXPR basic_inplace_string& replace(const_iterator first, const_iterator last, InputIt first2, InputIt last2, detail::is_input_iterator_tag);
+
+	INPLACE_STRING_CONSTEXPR int compare(const basic_inplace_string& str, std::false_type) const noexcept;
+	INPLACE_STRING_CONSTEXPR int compare(const basic_inplace_string& str, std::true_type) const noexcept;
+
+	static constexpr const std::size_t size_digit_bits = std::numeric_limits<static_size_type>::digits;
+
+	INPLACE_STRING_CONSTEXPR void set_size(size_type sz) noexcept
+	{
+		assert(sz <= max_size());
 
-	void set_size(size_type sz) noexcept
+		if (size_field::trailer == 0)
+			_data[N] = static_cast<value_type>(N - sz);
+
+		for (std::size_t i = 0; i < size_field::trailer; ++i)
+			_data[size_field::trailer_offset + i] = static_cast<value_type>(static_cast<static_size_type>(sz >> (i * size_digit_bits)));
+	}
+
+	// With a trailer, the character at N is the terminator of a full string: it is written once, at construction.
+	INPLACE_STRING_CONSTEXPR void init_trailer_terminator() noexcept
+	{
+		if (size_field::trailer != 0 && Policy::null_terminated)
+			traits_type::assign(_data[N], value_type{});
+	}
+
+	// Number of characters out of count that a string of sz characters can take: count, or what the overflow
+	// policy makes of a length error.
+	INPLACE_STRING_CONSTEXPR size_type fit_length(size_type sz, size_type count, const char* msg)
 	{
 		assert(sz <= max_size());
-		_data[N] = static_cast<value_type>(N - sz);
+		if (count <= max_size() - sz)
+			return count;
+
+		// Bounds the new size for the optimizer, whatever the policy returns
+		count = overflow(sz, msg);
+		INPLACE_STRING_ASSUME(count <= max_size() - sz);
+		return count;
+	}
+
+	INPLACE_STRING_CONSTEXPR size_type overflow(size_type sz, const char* msg);
+
+	// Terminates the string at new_size after a mutation. In zero-padded mode the characters released by a
+	// shrinking string are cleared.
+	INPLACE_STRING_CONSTEXPR void update_size(size_type old_size, size_type new_size) noexcept
+	{
+		INPLACE_STRING_ASSUME(new_size <= max_size());
+
+		if (Policy::zero_padded && new_size < old_size)
+			traits_type::assign(_data.data() + new_size, old_size - new_size, value_type{});
+		else if (Policy::null_terminated)
+			traits_type::assign(_data[new_size], value_type{});
+
+		set_size(new_size);
+		this->invalidate_hash();
 	}
 
-	size_type get_remaining_size() const noexcept
+	// Constant evaluation cannot copy uninitialized characters: the whole storage is cleared then.
+	INPLACE_STRING_CONSTEXPR void init_empty() noexcept
 	{
-		return static_cast<size_type>(_data[N]);
+		if (Policy::zero_padded || detail::is_constant_evaluated())
+			traits_type::assign(_data.data(), N, value_type{});
+		else if (Policy::null_terminated)
+			traits_type::assign(_data[0], value_type{});
+
+		init_trailer_terminator();
+		set_size(0);
+		this->invalidate_hash();
 	}
 
-	std::array<value_type, N + 1> _data;
+	std::array<value_type, size_field::storage> _data;
 };
 
-template <std::size_t N, typename CharT, typename Traits>
-basic_inplace_string<N, CharT, Traits>::basic_inplace_string() noexcept
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>::basic_inplace_string() noexcept
 {
-	_data[0] = value_type{};
-	set_size(0);
+	init_empty();
 }
 
-template <std::size_t N, typename CharT, typename Traits>
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR typename basic_inplace_string<N, CharT, Traits, Policy>::size_type
+basic_inplace_string<N, CharT, Traits, Policy>::size() const noexcept
+{
+	size_type sz = 0;
+	if (size_field::trailer == 0)
+		sz = N - static_cast<static_size_type>(_data[N]);
+
+	for (std::size_t i = 0; i < size_field::trailer; ++i)
+		sz |= static_cast<size_type>(static_cast<static_size_type>(_data[size_field::trailer_offset + i])) << (i * size_digit_bits);
+
+	INPLACE_STRING_ASSUME(sz <= N);
+	return sz;
+}
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
 template <std::size_t M>
-basic_inplace_string<N, CharT, Traits>::basic_inplace_string(const value_type(&str)[M]) noexcept
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>::basic_inplace_string(const value_type(&str)[M]) noexcept
 {
 	constexpr size_type sz = M - 1;
 	static_assert(sz <= max_size(), "basic_inplace_string: size exceeds maximum capacity");
@@ -315,85 +808,91 @@ basic_inplace_string<N, CharT, Traits>::basic_inplace_string(const value_type(&s
 	for (size_type i = 0; i < sz; ++i)
 		traits_type::assign(_data[i], str[i]);
 
-	traits_type::assign(_data[sz], value_type{});
+	if (Policy::zero_padded || detail::is_constant_evaluated())
+		traits_type::assign(_data.data() + sz, N - sz, value_type{});
+	else if (Policy::null_terminated)
+		traits_type::assign(_data[sz], value_type{});
+
+	init_trailer_terminator();
 	set_size(sz);
 }
 
-template <std::size_t N, typename CharT, typename Traits>
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
 template <typename ValueTypePtr, typename X>
-basic_inplace_string<N, CharT, Traits>::basic_inplace_string(ValueTypePtr str) :
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>::basic_inplace_string(ValueTypePtr str) :
 	basic_inplace_string(str, traits_type::length(str))
 {
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-basic_inplace_string<N, CharT, Traits>::basic_inplace_string(size_type count, value_type ch)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>::basic_inplace_string(size_type count, value_type ch)
 {
-	set_size(0);
+	init_empty();
 	insert(static_cast<size_type>(0), count, ch);
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-basic_inplace_string<N, CharT, Traits>::basic_inplace_string(const std::basic_string<CharT, Traits>& other, size_type pos) :
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>::basic_inplace_string(const std::basic_string<CharT, Traits>& other, size_type pos) :
 	basic_inplace_string(other.data() + pos, other.size() - pos)
 {
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-basic_inplace_string<N, CharT, Traits>::basic_inplace_string(const basic_inplace_string& other, size_type pos) :
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>::basic_inplace_string(const basic_inplace_string& other, size_type pos) :
 	basic_inplace_string(other.data() + pos, other.size() - pos)
 {
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-basic_inplace_string<N, CharT, Traits>::basic_inplace_string(const std::basic_string<CharT, Traits>& other, size_type pos, size_type count) :
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>::basic_inplace_string(const std::basic_string<CharT, Traits>& other, size_type pos, size_type count) :
 	basic_inplace_string(other.data() + pos, std::min(other.size() - pos, count))
 {
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-basic_inplace_string<N, CharT, Traits>::basic_inplace_string(const basic_inplace_string& other, size_type pos, size_type count) :
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>::basic_inplace_string(const basic_inplace_string& other, size_type pos, size_type count) :
 	basic_inplace_string(other.data() + pos, std::min(other.size() - pos, count))
 {
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-basic_inplace_string<N, CharT, Traits>::basic_inplace_string(const value_type* str, size_type count)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>::basic_inplace_string(const value_type* str, size_type count)
 {
-	set_size(0);
+	init_empty();
 	insert(static_cast<size_type>(0), str, count);
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-basic_inplace_string<N, CharT, Traits>::basic_inplace_string(const std::basic_string<CharT, Traits>& str) :
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>::basic_inplace_string(const std::basic_string<CharT, Traits>& str) :
 	basic_inplace_string(str.data(), str.size())
 {
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-basic_inplace_string<N, CharT, Traits>::basic_inplace_string(const std::initializer_list<CharT>& ilist) :
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>::basic_inplace_string(const std::initializer_list<CharT>& ilist) :
 	basic_inplace_string(ilist.begin(), ilist.size())
 {
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-basic_inplace_string<N, CharT, Traits>::basic_inplace_string(basic_string_view<CharT, Traits> sv) :
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>::basic_inplace_string(basic_string_view<CharT, Traits> sv) :
 	basic_inplace_string(sv.data(), sv.size())
 {
 }
 
-template <std::size_t N, typename CharT, typename Traits>
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
 template <typename T, typename X>
-basic_inplace_string<N, CharT, Traits>::basic_inplace_string(const T& t, size_type pos, size_type n)
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>::basic_inplace_string(const T& t, size_type pos, size_type n)
 {
 	basic_string_view<CharT, Traits> sv = t;
 	sv = sv.substr(pos, n);
-	basic_inplace_string(sv.data(), sv.size());
+	init_empty();
+	insert(static_cast<size_type>(0), sv.data(), sv.size());
 }
 
-template <std::size_t N, typename CharT, typename Traits>
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
 template <typename InputIt>
-basic_inplace_string<N, CharT, Traits>::basic_inplace_string(InputIt first, InputIt last) :
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>::basic_inplace_string(InputIt first, InputIt last) :
 	basic_inplace_string(first,
 						 last,
 						 typename std::conditional<detail::is_exactly_input_iterator<InputIt>::value,
@@ -402,35 +901,36 @@ basic_inplace_string<N, CharT, Traits>::basic_inplace_string(InputIt first, Inpu
 {
 }
 
-template <std::size_t N, typename CharT, typename Traits>
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
 template <typename InputIt>
-basic_inplace_string<N, CharT, Traits>::basic_inplace_string(InputIt first, InputIt last, detail::is_exactly_input_iterator_tag tag)
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>::basic_inplace_string(InputIt first, InputIt last, detail::is_exactly_input_iterator_tag tag)
 {
-	set_size(0);
+	init_empty();
 	insert(cbegin(), first, last, tag);
 }
 
-template <std::size_t N, typename CharT, typename Traits>
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
 template <typename InputIt>
-basic_inplace_string<N, CharT, Traits>::basic_inplace_string(InputIt first, InputIt last, detail::is_input_iterator_tag tag)
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>::basic_inplace_string(InputIt first, InputIt last, detail::is_input_iterator_tag tag)
 {
-	set_size(0);
+	init_empty();
 	insert(cbegin(), first, last, tag);
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-typename basic_inplace_string<N, CharT, Traits>::reference
-basic_inplace_string<N, CharT, Traits>::at(size_type i)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR typename basic_inplace_string<N, CharT, Traits, Policy>::reference
+basic_inplace_string<N, CharT, Traits, Policy>::at(size_type i)
 {
 	if (i >= size())
 		detail::throw_helper<std::out_of_range>("basic_inplace_string::at: out of range");
 
+	this->invalidate_hash();
 	return _data[i];
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-typename basic_inplace_string<N, CharT, Traits>::const_reference
-basic_inplace_string<N, CharT, Traits>::at(size_type i) const
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR typename basic_inplace_string<N, CharT, Traits, Policy>::const_reference
+basic_inplace_string<N, CharT, Traits, Policy>::at(size_type i) const
 {
 	if (i >= size())
 		detail::throw_helper<std::out_of_range>("basic_inplace_string::at: out of range");
@@ -438,68 +938,78 @@ basic_inplace_string<N, CharT, Traits>::at(size_type i) const
 	return _data[i];
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-basic_inplace_string<N, CharT, Traits>&
-basic_inplace_string<N, CharT, Traits>::insert(size_type index, size_type count, value_type ch)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR typename basic_inplace_string<N, CharT, Traits, Policy>::size_type
+basic_inplace_string<N, CharT, Traits, Policy>::overflow(size_type sz, const char* msg)
+{
+	if (Policy::overflow == inplace_string_overflow::throw_exception)
+		detail::throw_helper<std::length_error>(msg);
+	if (Policy::overflow == inplace_string_overflow::terminate)
+		std::terminate();
+	if (Policy::overflow == inplace_string_overflow::saturate)
+		this->set_overflow(true);
+
+	return max_size() - sz;
+}
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>&
+basic_inplace_string<N, CharT, Traits, Policy>::insert(size_type index, size_type count, value_type ch)
 {
 	const size_type sz = size();
 
 	if (index > sz)
 		detail::throw_helper<std::out_of_range>("basic_inplace_string::insert: out of range");
 
-	if (sz + count > max_size())
-		detail::throw_helper<std::length_error>("basic_inplace_string::insert: maximum capacity reached");
+	count = fit_length(sz, count, "basic_inplace_string::insert: maximum capacity reached");
 
 	traits_type::move(_data.data() + index + count, _data.data() + index, sz - index);
 	traits_type::assign(&_data[index], count, ch);
 
 	const size_type new_size = sz + count;
-	traits_type::assign(_data[new_size], value_type{});
-	set_size(new_size);
+	update_size(sz, new_size);
 
 	return *this;
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-basic_inplace_string<N, CharT, Traits>&
-basic_inplace_string<N, CharT, Traits>::insert(size_type index, const value_type* str)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>&
+basic_inplace_string<N, CharT, Traits, Policy>::insert(size_type index, const value_type* str)
 {
 	return insert(index, str, traits_type::length(str));
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-basic_inplace_string<N, CharT, Traits>&
-basic_inplace_string<N, CharT, Traits>::insert(size_type index, const value_type* str, size_type count)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>&
+basic_inplace_string<N, CharT, Traits, Policy>::insert(size_type index, const value_type* str, size_type count)
 {
 	const size_type sz = size();
 
 	if (index > sz)
 		detail::throw_helper<std::out_of_range>("basic_inplace_string::insert: out of range");
 
-	if (size() + count > max_size())
-		detail::throw_helper<std::length_error>("basic_inplace_string::insert: maximum capacity reached");
+	count = fit_length(sz, count, "basic_inplace_string::insert: maximum capacity reached");
 
 	traits_type::move(_data.data() + index + count, _data.data() + index, sz - index);
 	for (size_type i = 0; i != count; ++i)
 		traits_type::assign(_data[index + i], str[i]);
 
 	const size_type new_size = sz + count;
-	traits_type::assign(_data[new_size], value_type{});
-	set_size(new_size);
+	update_size(sz, new_size);
 
 	return *this;
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-basic_inplace_string<N, CharT, Traits>&
-basic_inplace_string<N, CharT, Traits>::insert(size_type index, const basic_inplace_string& str)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>&
+basic_inplace_string<N, CharT, Traits, Policy>::insert(size_type index, const basic_inplace_string& str)
 {
 	return insert(index, str.data(), str.size());
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-basic_inplace_string<N, CharT, Traits>&
-basic_inplace_string<N, CharT, Traits>::insert(size_type index, const basic_inplace_string& str, size_type index_str, size_type count)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>&
+basic_inplace_string<N, CharT, Traits, Policy>::insert(size_type index, const basic_inplace_string& str, size_type index_str, size_type count)
 {
 	if (index_str > str.size())
 		detail::throw_helper<std::out_of_range>("basic_inplace_string::insert: out of range");
@@ -508,38 +1018,38 @@ basic_inplace_string<N, CharT, Traits>::insert(size_type index, const basic_inpl
 	return insert(index, subs.data(), subs.size());
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-typename basic_inplace_string<N, CharT, Traits>::iterator
-basic_inplace_string<N, CharT, Traits>::insert(const_iterator pos, value_type ch)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR typename basic_inplace_string<N, CharT, Traits, Policy>::iterator
+basic_inplace_string<N, CharT, Traits, Policy>::insert(const_iterator pos, value_type ch)
 {
 	const size_type index = static_cast<size_type>(pos - _data.data());
 	insert(index, 1, ch);
 	return _data.data() + index;
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-typename basic_inplace_string<N, CharT, Traits>::iterator
-basic_inplace_string<N, CharT, Traits>::insert(const_iterator pos, size_type count, value_type ch)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR typename basic_inplace_string<N, CharT, Traits, Policy>::iterator
+basic_inplace_string<N, CharT, Traits, Policy>::insert(const_iterator pos, size_type count, value_type ch)
 {
 	const size_type index = static_cast<size_type>(pos - _data.data());
 	insert(index, count, ch);
 	return _data.data() + index;
 }
 
-template <std::size_t N, typename CharT, typename Traits>
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
 template <typename InputIt>
-typename basic_inplace_string<N, CharT, Traits>::iterator
-basic_inplace_string<N, CharT, Traits>::insert(const_iterator pos, InputIt first, InputIt last)
+INPLACE_STRING_CONSTEXPR typename basic_inplace_string<N, CharT, Traits, Policy>::iterator
+basic_inplace_string<N, CharT, Traits, Policy>::insert(const_iterator pos, InputIt first, InputIt last)
 {
 	return insert(pos, first, last, typename std::conditional<detail::is_exactly_input_iterator<InputIt>::value,
 											detail::is_exactly_input_iterator_tag,
 											detail::is_input_iterator_tag>::type{});
 }
 
-template <std::size_t N, typename CharT, typename Traits>
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
 template <typename InputIt>
-typename basic_inplace_string<N, CharT, Traits>::iterator
-basic_inplace_string<N, CharT, Traits>::insert(const_iterator pos, InputIt first, InputIt last, detail::is_exactly_input_iterator_tag)
+INPLACE_STRING_CONSTEXPR typename basic_inplace_string<N, CharT, Traits, Policy>::iterator
+basic_inplace_string<N, CharT, Traits, Policy>::insert(const_iterator pos, InputIt first, InputIt last, detail::is_exactly_input_iterator_tag)
 {
 	assert(pos >= _data.data() && pos <= _data.data() + size());
 
@@ -549,42 +1059,43 @@ basic_inplace_string<N, CharT, Traits>::insert(const_iterator pos, InputIt first
 
 	for (; first != last; ++first, ++count)
 	{
-		traits_type::move(&_data[index + count + 1], &_data[index + count], sz - index + count);
+		if (fit_length(sz + count, 1, "basic_inplace_string::insert: maximum capacity reached") == 0)
+			break;
+
+		traits_type::move(&_data[index + count + 1], &_data[index + count], sz - index);
 		traits_type::assign(_data[index + count], *first);
 	}
 
 	const size_type new_size = sz + count;
-	traits_type::assign(_data[new_size], value_type{});
-	set_size(new_size);
+	update_size(sz, new_size);
 
 	return _data.data() + index;
 }
 
-template <std::size_t N, typename CharT, typename Traits>
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
 template <typename InputIt>
-typename basic_inplace_string<N, CharT, Traits>::iterator
-basic_inplace_string<N, CharT, Traits>::insert(const_iterator pos, InputIt first, InputIt last, detail::is_input_iterator_tag)
+INPLACE_STRING_CONSTEXPR typename basic_inplace_string<N, CharT, Traits, Policy>::iterator
+basic_inplace_string<N, CharT, Traits, Policy>::insert(const_iterator pos, InputIt first, InputIt last, detail::is_input_iterator_tag)
 {
 	assert(pos >= _data.data() && pos <= _data.data() + size());
 
 	const size_type sz = size();
 	const size_type index = static_cast<size_type>(pos - _data.data());
-	const size_type count = static_cast<size_type>(std::distance(first, last));
+	const size_type count = fit_length(sz, static_cast<size_type>(std::distance(first, last)), "basic_inplace_string::insert: maximum capacity reached");
 
 	traits_type::move(&_data[index + count], &_data[index], sz - index);
 	for (size_type i = 0; i < count; ++i, ++first)
 		traits_type::assign(_data[index + i], *first);
 
 	const size_type new_size = sz + count;
-	traits_type::assign(_data[new_size], value_type{});
-	set_size(new_size);
+	update_size(sz, new_size);
 
 	return _data.data() + index;
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-typename basic_inplace_string<N, CharT, Traits>::iterator
-basic_inplace_string<N, CharT, Traits>::insert(const_iterator pos, std::initializer_list<CharT> ilist)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR typename basic_inplace_string<N, CharT, Traits, Policy>::iterator
+basic_inplace_string<N, CharT, Traits, Policy>::insert(const_iterator pos, std::initializer_list<CharT> ilist)
 {
 	assert(pos >= _data.data() && pos <= _data.data() + size());
 
@@ -593,17 +1104,17 @@ basic_inplace_string<N, CharT, Traits>::insert(const_iterator pos, std::initiali
 	return _data.data() + index;
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-basic_inplace_string<N, CharT, Traits>&
-basic_inplace_string<N, CharT, Traits>::insert(size_type pos, basic_string_view<CharT, Traits> view)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>&
+basic_inplace_string<N, CharT, Traits, Policy>::insert(size_type pos, basic_string_view<CharT, Traits> view)
 {
 	return insert(pos, view.data(), view.size());
 }
 
-template <std::size_t N, typename CharT, typename Traits>
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
 template <typename T, typename X>
-basic_inplace_string<N, CharT, Traits>&
-basic_inplace_string<N, CharT, Traits>::insert(size_type pos, const T& t, size_type index_str, size_type count)
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>&
+basic_inplace_string<N, CharT, Traits, Policy>::insert(size_type pos, const T& t, size_type index_str, size_type count)
 {
 	basic_string_view<CharT, Traits> view = t;
 
@@ -613,9 +1124,9 @@ basic_inplace_string<N, CharT, Traits>::insert(size_type pos, const T& t, size_t
 	return insert(pos, view.data(), index_str, std::min(count, view.size() - index_str));
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-basic_inplace_string<N, CharT, Traits>&
-basic_inplace_string<N, CharT, Traits>::erase(size_type index, size_type count)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>&
+basic_inplace_string<N, CharT, Traits, Policy>::erase(size_type index, size_type count)
 {
 	size_type sz = size();
 	count = std::min(sz - index, count);
@@ -625,25 +1136,22 @@ basic_inplace_string<N, CharT, Traits>::erase(size_type index, size_type count)
 
 	traits_type::move(_data.data() + index, _data.data() + index + count, sz - index - count);
 
-	sz -= count;
-	traits_type::assign(_data[sz], value_type{});
-
-	set_size(sz);
+	update_size(sz, sz - count);
 	return *this;
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-typename basic_inplace_string<N, CharT, Traits>::iterator
-basic_inplace_string<N, CharT, Traits>::erase(const_iterator position)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR typename basic_inplace_string<N, CharT, Traits, Policy>::iterator
+basic_inplace_string<N, CharT, Traits, Policy>::erase(const_iterator position)
 {
 	size_type index = static_cast<size_type>(position - _data.data());
 	erase(index, 1);
 	return iterator{_data.data() + index};
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-typename basic_inplace_string<N, CharT, Traits>::iterator
-basic_inplace_string<N, CharT, Traits>::erase(const_iterator first, const_iterator last)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR typename basic_inplace_string<N, CharT, Traits, Policy>::iterator
+basic_inplace_string<N, CharT, Traits, Policy>::erase(const_iterator first, const_iterator last)
 {
 	const size_type index = static_cast<size_type>(first - _data.data());
 	const size_type count = static_cast<size_type>(std::distance(first, last));
@@ -652,140 +1160,147 @@ basic_inplace_string<N, CharT, Traits>::erase(const_iterator first, const_iterat
 	return iterator{_data.data() + index};
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-basic_inplace_string<N, CharT, Traits>&
-basic_inplace_string<N, CharT, Traits>::append(size_type count, value_type ch)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>&
+basic_inplace_string<N, CharT, Traits, Policy>::append(size_type count, value_type ch)
 {
 	const size_type sz = size();
-	if (sz + count > max_size())
-		detail::throw_helper<std::length_error>("basic_inplace_string::append: exceed maximum string length");
+	count = fit_length(sz, count, "basic_inplace_string::append: exceed maximum string length");
 
 	traits_type::assign(_data.data() + sz, count, ch);
 
 	const size_type new_size = sz + count;
-	traits_type::assign(_data[new_size], value_type{});
-	set_size(new_size);
+	update_size(sz, new_size);
 
 	return *this;
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-basic_inplace_string<N, CharT, Traits>&
-basic_inplace_string<N, CharT, Traits>::append(const std::basic_string<CharT, Traits>& str)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>&
+basic_inplace_string<N, CharT, Traits, Policy>::append(const std::basic_string<CharT, Traits>& str)
 {
 	return append(str.data(), str.size());
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-basic_inplace_string<N, CharT, Traits>&
-basic_inplace_string<N, CharT, Traits>::append(const std::basic_string<CharT, Traits>& str, size_type pos, size_type count)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>&
+basic_inplace_string<N, CharT, Traits, Policy>::append(const std::basic_string<CharT, Traits>& str, size_type pos, size_type count)
 {
 	return append(str.data() + pos, std::min(str.size() - pos, count));
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-basic_inplace_string<N, CharT, Traits>&
-basic_inplace_string<N, CharT, Traits>::append(const value_type* str, size_type count)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>&
+basic_inplace_string<N, CharT, Traits, Policy>::append(const value_type* str, size_type count)
 {
 	const size_type sz = size();
-	if (sz + count > max_size())
-		detail::throw_helper<std::length_error>("basic_inplace_string::append: exceed maximum string length");
+	count = fit_length(sz, count, "basic_inplace_string::append: exceed maximum string length");
 
 	for (size_type i = 0; i != count; ++i)
 		traits_type::assign(_data[sz + i], str[i]);
 
 	const size_type new_size = sz + count;
-	traits_type::assign(_data[new_size], value_type{});
-	set_size(new_size);
+	update_size(sz, new_size);
 
 	return *this;
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-basic_inplace_string<N, CharT, Traits>&
-basic_inplace_string<N, CharT, Traits>::append(const value_type* str)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>&
+basic_inplace_string<N, CharT, Traits, Policy>::append(const value_type* str)
 {
 	size_type sz = traits_type::length(str);
 	return append(str, sz);
 }
 
-template <std::size_t N, typename CharT, typename Traits>
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
 template <typename InputIt>
-basic_inplace_string<N, CharT, Traits>&
-basic_inplace_string<N, CharT, Traits>::append(InputIt first, InputIt last)
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>&
+basic_inplace_string<N, CharT, Traits, Policy>::append(InputIt first, InputIt last)
 {
 	// TODO exact fwd it stuff
 	const size_type sz = size();
-	const size_type count = std::distance(first, last);
+	const size_type count = fit_length(sz, static_cast<size_type>(std::distance(first, last)), "basic_inplace_string::append: exceed maximum string length");
 
-	if (sz + count > max_size())
-		detail::throw_helper<std::length_error>("basic_inplace_string::append: exceed maximum string length");
+	pointer p = _data.data() + sz;
 
-	const pointer p = _data.data() + sz;
+	for (size_type i = 0; i < count; ++i, ++first, ++p)
+		traits_type::assign(*p, *first);
 
-	for (auto it = first; it != last; ++it, ++p)
-		traits_type::assign(*p, *it);
-	traits_type::assign(*p, value_type{});
-
-	set_size(sz + count);
+	update_size(sz, sz + count);
 	return *this;
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-basic_inplace_string<N, CharT, Traits>&
-basic_inplace_string<N, CharT, Traits>::append(std::initializer_list<value_type> ilist)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>&
+basic_inplace_string<N, CharT, Traits, Policy>::append(std::initializer_list<value_type> ilist)
 {
 	return append(ilist.begin(), ilist.size());
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-basic_inplace_string<N, CharT, Traits>&
-basic_inplace_string<N, CharT, Traits>::append(const basic_string_view<CharT, Traits>& view)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>&
+basic_inplace_string<N, CharT, Traits, Policy>::append(const basic_string_view<CharT, Traits>& view)
 {
 	return append(view.data(), view.size());
 }
 
-template <std::size_t N, typename CharT, typename Traits>
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
 template <typename T, typename X>
-basic_inplace_string<N, CharT, Traits>&
-basic_inplace_string<N, CharT, Traits>::append(const T& t, size_type pos, size_type count)
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>&
+basic_inplace_string<N, CharT, Traits, Policy>::append(const T& t, size_type pos, size_type count)
 {
 	basic_string_view<CharT, Traits> view = t;
 	return append(view.data() + pos, std::min(view.size() - pos, count));
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-int basic_inplace_string<N, CharT, Traits>::compare(const basic_inplace_string& str) const noexcept
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR int basic_inplace_string<N, CharT, Traits, Policy>::compare(const basic_inplace_string& str) const noexcept
+{
+	return compare(str, typename detail::is_register_comparable<N, CharT, Traits>::type{});
+}
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR int basic_inplace_string<N, CharT, Traits, Policy>::compare(const basic_inplace_string& str, std::false_type) const noexcept
 {
 	return compare(0, size(), str.data(), str.size());
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-int basic_inplace_string<N, CharT, Traits>::compare(size_type pos1, size_type count1, const basic_inplace_string& str) const
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR int basic_inplace_string<N, CharT, Traits, Policy>::compare(const basic_inplace_string& str, std::true_type) const noexcept
+{
+	if (detail::is_constant_evaluated())
+		return compare(str, std::false_type{});
+
+	return detail::register_compare<N>(_data.data(), size(), str._data.data(), str.size());
+}
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR int basic_inplace_string<N, CharT, Traits, Policy>::compare(size_type pos1, size_type count1, const basic_inplace_string& str) const
 {
 	return compare(pos1, count1, str.data(), str.size());
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-int basic_inplace_string<N, CharT, Traits>::compare(size_type pos1, size_type count1, const basic_inplace_string& str, size_type pos2, size_type count2) const
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR int basic_inplace_string<N, CharT, Traits, Policy>::compare(size_type pos1, size_type count1, const basic_inplace_string& str, size_type pos2, size_type count2) const
 {
 	return compare(pos1, count1, str.data() + pos2, std::min(size() - pos2, count2));
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-int basic_inplace_string<N, CharT, Traits>::compare(const value_type* str) const
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR int basic_inplace_string<N, CharT, Traits, Policy>::compare(const value_type* str) const
 {
 	return compare(0, size(), str, traits_type::length(str));
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-int basic_inplace_string<N, CharT, Traits>::compare(size_type pos1, size_type count1, const value_type* str) const
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR int basic_inplace_string<N, CharT, Traits, Policy>::compare(size_type pos1, size_type count1, const value_type* str) const
 {
 	return compare(pos1, count1, str, traits_type::length(str));
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-int basic_inplace_string<N, CharT, Traits>::compare(size_type pos1, size_type count1, const value_type* str, size_type count2) const
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR int basic_inplace_string<N, CharT, Traits, Policy>::compare(size_type pos1, size_type count1, const value_type* str, size_type count2) const
 {
 	const size_type sz = std::min(count1, count2);
 	const int cmp = traits_type::compare(data() + pos1, str, sz);
@@ -794,21 +1309,21 @@ int basic_inplace_string<N, CharT, Traits>::compare(size_type pos1, size_type co
 	return count1 > count2 ? 1 : (count1 == count2 ? 0 : -1);
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-int basic_inplace_string<N, CharT, Traits>::compare(basic_string_view<CharT, Traits> sv) const noexcept
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR int basic_inplace_string<N, CharT, Traits, Policy>::compare(basic_string_view<CharT, Traits> sv) const noexcept
 {
 	return compare(0, size(), sv.data(), sv.size());
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-int basic_inplace_string<N, CharT, Traits>::compare(size_type pos1, size_type count1, basic_string_view<CharT, Traits> sv) const
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR int basic_inplace_string<N, CharT, Traits, Policy>::compare(size_type pos1, size_type count1, basic_string_view<CharT, Traits> sv) const
 {
 	return compare(pos1, count1, sv.data(), sv.size());
 }
 
-template <std::size_t N, typename CharT, typename Traits>
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
 template <typename T, typename X>
-int basic_inplace_string<N, CharT, Traits>::compare(size_type pos1, size_type count1, const T& t, size_type pos2, size_type count2) const
+INPLACE_STRING_CONSTEXPR int basic_inplace_string<N, CharT, Traits, Policy>::compare(size_type pos1, size_type count1, const T& t, size_type pos2, size_type count2) const
 {
 	basic_string_view<CharT, Traits> view = t;
 
@@ -818,44 +1333,44 @@ int basic_inplace_string<N, CharT, Traits>::compare(size_type pos1, size_type co
 	return compare(pos1, count1, view.data() + pos2, std::min(view.size() - pos2, count2));
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-basic_inplace_string<N, CharT, Traits>&
-basic_inplace_string<N, CharT, Traits>::replace(size_type pos, size_type count, const basic_inplace_string& str)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>&
+basic_inplace_string<N, CharT, Traits, Policy>::replace(size_type pos, size_type count, const basic_inplace_string& str)
 {
-	return replace(pos, count, str.c_str(), str.size());
+	return replace(pos, count, str.data(), str.size());
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-basic_inplace_string<N, CharT, Traits>&
-basic_inplace_string<N, CharT, Traits>::replace(const_iterator first, const_iterator last, const basic_inplace_string& str)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>&
+basic_inplace_string<N, CharT, Traits, Policy>::replace(const_iterator first, const_iterator last, const basic_inplace_string& str)
 {
-	return replace(first - _data.data(), std::distance(first, last), str.c_str(), str.size());
+	return replace(first - _data.data(), std::distance(first, last), str.data(), str.size());
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-basic_inplace_string<N, CharT, Traits>&
-basic_inplace_string<N, CharT, Traits>::replace(size_type pos, size_type count, const basic_inplace_string& str, size_type pos2, size_type count2)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>&
+basic_inplace_string<N, CharT, Traits, Policy>::replace(size_type pos, size_type count, const basic_inplace_string& str, size_type pos2, size_type count2)
 {
 	if (pos2  > str.size())
 		detail::throw_helper<std::out_of_range>("basic_inplace_string::replace: out of range");
 
-	return replace(pos, count, str.c_str() + pos2, std::min(str.size() - pos2, count2));
+	return replace(pos, count, str.data() + pos2, std::min(str.size() - pos2, count2));
 }
 
-template <std::size_t N, typename CharT, typename Traits>
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
 template <class InputIt>
-basic_inplace_string<N, CharT, Traits>&
-basic_inplace_string<N, CharT, Traits>::replace(const_iterator first, const_iterator last, InputIt first2, InputIt last2)
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>&
+basic_inplace_string<N, CharT, Traits, Policy>::replace(const_iterator first, const_iterator last, InputIt first2, InputIt last2)
 {
 	return replace(first, last, first2, last2, typename std::conditional<detail::is_exactly_input_iterator<InputIt>::value,
 													detail::is_exactly_input_iterator_tag,
 													detail::is_input_iterator_tag>::type{});
 }
 
-template <std::size_t N, typename CharT, typename Traits>
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
 template <class InputIt>
-basic_inplace_string<N, CharT, Traits>&
-basic_inplace_string<N, CharT, Traits>::replace(const_iterator first, const_iterator last, InputIt first2, InputIt last2, detail::is_exactly_input_iterator_tag)
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>&
+basic_inplace_string<N, CharT, Traits, Policy>::replace(const_iterator first, const_iterator last, InputIt first2, InputIt last2, detail::is_exactly_input_iterator_tag)
 {
 	const size_type pos1 = static_cast<size_type>(first - _data.data());
 	const size_type count1 = static_cast<size_type>(std::distance(first, last));
@@ -868,161 +1383,157 @@ basic_inplace_string<N, CharT, Traits>::replace(const_iterator first, const_iter
 	for (; first2 != last2; ++first2, ++count2)
 	{
 		if (count2 >= count1)
+		{
+			if (fit_length(sz + count2 - count1, 1, "basic_inplace_string::replace: exceed maximum string length") == 0)
+				break;
+
 			traits_type::move(_data.data() + pos1 + count2 + 1, _data.data() + pos1 + count2, sz - pos1 - count1);
+		}
 
 		traits_type::assign(_data[pos1 + count2], *first2);
 	}
 
+	if (count2 < count1)
+		traits_type::move(_data.data() + pos1 + count2, _data.data() + pos1 + count1, sz - pos1 - count1);
+
 	const difference_type new_bytes = static_cast<difference_type>(count2 - count1);
 	const size_type new_size = sz + static_cast<size_type>(new_bytes);
 
-	traits_type::assign(_data[new_size], value_type{});
-	set_size(new_size);
+	update_size(sz, new_size);
 
 	return *this;
 }
 
-template <std::size_t N, typename CharT, typename Traits>
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
 template <class InputIt>
-basic_inplace_string<N, CharT, Traits>&
-basic_inplace_string<N, CharT, Traits>::replace(const_iterator first, const_iterator last, InputIt first2, InputIt last2, detail::is_input_iterator_tag)
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>&
+basic_inplace_string<N, CharT, Traits, Policy>::replace(const_iterator first, const_iterator last, InputIt first2, InputIt last2, detail::is_input_iterator_tag)
 {
 	const size_type pos1 = static_cast<size_type>(first - _data.data());
 	const size_type count1 = static_cast<size_type>(std::distance(first, last));
-
-	const size_type count2 = static_cast<size_type>(std::distance(first2, last2));
-	const difference_type new_bytes = static_cast<difference_type>(count2 - count1);
-
 	const size_type sz = size();
-	const size_type new_size = sz + static_cast<size_type>(new_bytes);
 
 	if (pos1 > sz)
 		detail::throw_helper<std::out_of_range>("basic_inplace_string::replace: out of range");
 
-	if (new_size > max_size())
-		detail::throw_helper<std::length_error>("basic_inplace_string::replace: exceed maximum string length");
+	const size_type count2 = fit_length(sz - count1, static_cast<size_type>(std::distance(first2, last2)), "basic_inplace_string::replace: exceed maximum string length");
+	const size_type new_size = sz - count1 + count2;
 
 	traits_type::move(_data.data() + pos1 + count2, _data.data() + pos1 + count1, sz - pos1 - count1);
 
 	pointer p = _data.data() + pos1;
-	for (auto it = first2; it != last2; ++it, ++p)
-		traits_type::assign(*p, *it);
+	for (size_type i = 0; i < count2; ++i, ++first2, ++p)
+		traits_type::assign(*p, *first2);
 
-	traits_type::assign(_data[new_size], value_type{});
-	set_size(new_size);
+	update_size(sz, new_size);
 
 	return *this;
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-basic_inplace_string<N, CharT, Traits>&
-basic_inplace_string<N, CharT, Traits>::replace(size_type pos1, size_type count1, const CharT* str, size_type count2)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>&
+basic_inplace_string<N, CharT, Traits, Policy>::replace(size_type pos1, size_type count1, const CharT* str, size_type count2)
 {
 	const size_type sz = size();
-	const difference_type new_bytes = static_cast<difference_type>(count2 - count1);
-	const size_type new_size = sz + static_cast<size_type>(new_bytes);
 
 	if (pos1 > sz)
 		detail::throw_helper<std::out_of_range>("basic_inplace_string::replace: out of range");
 
-	if (new_size > max_size())
-		detail::throw_helper<std::length_error>("basic_inplace_string::replace: exceed maximum string length");
+	count1 = std::min(count1, sz - pos1);
+	count2 = fit_length(sz - count1, count2, "basic_inplace_string::replace: exceed maximum string length");
+	const size_type new_size = sz - count1 + count2;
 
-	traits_type::move(_data.data() + pos1 + count2, _data.data() + pos1 + count1, sz - pos1);
+	traits_type::move(_data.data() + pos1 + count2, _data.data() + pos1 + count1, sz - pos1 - count1);
 
-	for (size_type i = 0; i != count2; ++i)
-		traits_type::assign(_data[pos1 + i], str[i]);
+	traits_type::move(_data.data() + pos1, str, count2);
 
-	traits_type::assign(_data[new_size], value_type{});
-	set_size(new_size);
+	update_size(std::max(sz, pos1 + count2), new_size);
 
 	return *this;
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-basic_inplace_string<N, CharT, Traits>&
-basic_inplace_string<N, CharT, Traits>::replace(const_iterator first, const_iterator last, const CharT* str, size_type count2)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>&
+basic_inplace_string<N, CharT, Traits, Policy>::replace(const_iterator first, const_iterator last, const CharT* str, size_type count2)
 {
 	const size_type pos1 = static_cast<size_type>(first - _data.data());
 	const size_type count1 = static_cast<size_type>(std::distance(first, last));
 	return replace(pos1, count1, str, count2);
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-basic_inplace_string<N, CharT, Traits>&
-basic_inplace_string<N, CharT, Traits>::replace(size_type pos, size_type count, const CharT* str)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>&
+basic_inplace_string<N, CharT, Traits, Policy>::replace(size_type pos, size_type count, const CharT* str)
 {
 	return replace(pos, count, str, traits_type::length(str));
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-basic_inplace_string<N, CharT, Traits>&
-basic_inplace_string<N, CharT, Traits>::replace(const_iterator first, const_iterator last, const CharT* str)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>&
+basic_inplace_string<N, CharT, Traits, Policy>::replace(const_iterator first, const_iterator last, const CharT* str)
 {
 	return replace(first - _data.data(), std::distance(first, last), str, traits_type::length(str));
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-basic_inplace_string<N, CharT, Traits>&
-basic_inplace_string<N, CharT, Traits>::replace(size_type pos1, size_type count1, size_type count2, value_type ch)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>&
+basic_inplace_string<N, CharT, Traits, Policy>::replace(size_type pos1, size_type count1, size_type count2, value_type ch)
 {
 	const size_type sz = size();
-	const difference_type new_bytes = static_cast<difference_type>(count2 - count1);
-	const size_type new_size = sz + static_cast<size_type>(new_bytes);
 
 	if (pos1 > sz)
 		detail::throw_helper<std::out_of_range>("basic_inplace_string::replace: out of range");
 
-	if (new_size > max_size())
-		detail::throw_helper<std::length_error>("basic_inplace_string::replace: exceed maximum string length");
+	count1 = std::min(count1, sz - pos1);
+	count2 = fit_length(sz - count1, count2, "basic_inplace_string::replace: exceed maximum string length");
+	const size_type new_size = sz - count1 + count2;
 
-	traits_type::move(_data.data() + pos1 + count2, _data.data() + pos1 + count1, size() - pos1 - count1);
+	traits_type::move(_data.data() + pos1 + count2, _data.data() + pos1 + count1, sz - pos1 - count1);
 	traits_type::assign(_data.data() + pos1, count2, ch);
 
-	traits_type::assign(_data[new_size], value_type{});
-	set_size(new_size);
+	update_size(std::max(sz, pos1 + count2), new_size);
 
 	return *this;
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-basic_inplace_string<N, CharT, Traits>&
-basic_inplace_string<N, CharT, Traits>::replace(const_iterator first, const_iterator last, size_type count2, value_type ch)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>&
+basic_inplace_string<N, CharT, Traits, Policy>::replace(const_iterator first, const_iterator last, size_type count2, value_type ch)
 {
 	const size_type pos1 = static_cast<size_type>(first - _data.data());
 	const size_type count1 = static_cast<size_type>(std::distance(first, last));
 	return replace(pos1, count1, count2, ch);
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-basic_inplace_string<N, CharT, Traits>&
-basic_inplace_string<N, CharT, Traits>::replace(const_iterator first, const_iterator last, std::initializer_list<value_type> ilist)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>&
+basic_inplace_string<N, CharT, Traits, Policy>::replace(const_iterator first, const_iterator last, std::initializer_list<value_type> ilist)
 {
 	const size_type pos1 = static_cast<size_type>(first - _data.data());
 	const size_type count1 = static_cast<size_type>(std::distance(first, last));
 	return replace(pos1, count1, ilist.begin(), ilist.size());
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-basic_inplace_string<N, CharT, Traits>&
-basic_inplace_string<N, CharT, Traits>::replace(size_type pos, size_type count, basic_string_view<CharT, Traits> sv)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>&
+basic_inplace_string<N, CharT, Traits, Policy>::replace(size_type pos, size_type count, basic_string_view<CharT, Traits> sv)
 {
 	return replace(pos, count, sv.data(), sv.size());
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-basic_inplace_string<N, CharT, Traits>&
-basic_inplace_string<N, CharT, Traits>::replace(const_iterator first, const_iterator last, basic_string_view<CharT, Traits> sv)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>&
+basic_inplace_string<N, CharT, Traits, Policy>::replace(const_iterator first, const_iterator last, basic_string_view<CharT, Traits> sv)
 {
 	const size_type pos1 = static_cast<size_type>(first - _data.data());
 	const size_type count1 = static_cast<size_type>(std::distance(first, last));
 	return replace(pos1, count1, sv.data(), sv.size());
 }
 
-template <std::size_t N, typename CharT, typename Traits>
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
 template <typename T, typename X>
-basic_inplace_string<N, CharT, Traits>&
-basic_inplace_string<N, CharT, Traits>::replace(size_type pos, size_type count, const T& t, size_type pos2, size_type count2)
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>&
+basic_inplace_string<N, CharT, Traits, Policy>::replace(size_type pos, size_type count, const T& t, size_type pos2, size_type count2)
 {
 	basic_string_view<CharT, Traits> view = t;
 
@@ -1032,9 +1543,9 @@ basic_inplace_string<N, CharT, Traits>::replace(size_type pos, size_type count,
 	return replace(pos, count, view.data() + pos2, std::min(view.size() - pos2, count2));
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-basic_inplace_string<N, CharT, Traits>
-basic_inplace_string<N, CharT, Traits>::substr(size_type pos, size_type count) const
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>
+basic_inplace_string<N, CharT, Traits, Policy>::substr(size_type pos, size_type count) const
 {
 	if (pos > size())
 		detail::throw_helper<std::out_of_range>("basic_inplace_string::substr: out of range");
@@ -1042,360 +1553,2665 @@ basic_inplace_string<N, CharT, Traits>::substr(size_type pos, size_type count) c
 	return {data() + pos, std::min(count, size() - pos)};
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-typename basic_inplace_string<N, CharT, Traits>::size_type
-basic_inplace_string<N, CharT, Traits>::find(const basic_inplace_string& other, size_type pos) const noexcept
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR typename basic_inplace_string<N, CharT, Traits, Policy>::size_type
+basic_inplace_string<N, CharT, Traits, Policy>::find(const basic_inplace_string& other, size_type pos) const noexcept
 {
 	return find(other.data(), pos, other.size());
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-typename basic_inplace_string<N, CharT, Traits>::size_type
-basic_inplace_string<N, CharT, Traits>::find(const value_type* str, size_type pos, size_type count) const noexcept
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR typename basic_inplace_string<N, CharT, Traits, Policy>::size_type
+basic_inplace_string<N, CharT, Traits, Policy>::find(const value_type* str, size_type pos, size_type count) const noexcept
 {
-	if (pos >= size() || count == 0)
+	// As std::string, an empty needle is found at pos
+	if (count == 0)
+		return pos <= size() ? pos : npos;
+
+	if (pos >= size())
 		return npos;
 
+	if (detail::is_constant_evaluated())
+		return view_type(*this).find(str, pos, count);
+
 	const value_type* res = detail::search_substring<CharT, Traits>(cbegin() + pos, cend(), str, str + count);
 	return res ? static_cast<size_type>(res - cbegin()) : npos;
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-typename basic_inplace_string<N, CharT, Traits>::size_type
-basic_inplace_string<N, CharT, Traits>::find(const value_type* str, size_type pos) const noexcept
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR typename basic_inplace_string<N, CharT, Traits, Policy>::size_type
+basic_inplace_string<N, CharT, Traits, Policy>::find(const value_type* str, size_type pos) const noexcept
 {
 	return find(str, pos, traits_type::length(str));
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-typename basic_inplace_string<N, CharT, Traits>::size_type
-basic_inplace_string<N, CharT, Traits>::find(value_type ch, size_type pos) const noexcept
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR typename basic_inplace_string<N, CharT, Traits, Policy>::size_type
+basic_inplace_string<N, CharT, Traits, Policy>::find(value_type ch, size_type pos) const noexcept
 {
-	const value_type* res = traits_type::find(data() + pos, size() - pos, ch);
-	return res ? static_cast<size_type>(res - cbegin()) : npos;
+	const size_type sz = size();
+	if (pos >= sz)
+		return npos;
+
+	if (detail::is_constant_evaluated())
+		return view_type(*this).find(ch, pos);
+
+	return detail::find_char<N + 1, CharT, Traits>(_data.data(), pos, sz, ch);
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-typename basic_inplace_string<N, CharT, Traits>::size_type
-basic_inplace_string<N, CharT, Traits>::find(basic_string_view<CharT, Traits> sv, size_type pos) const noexcept
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR typename basic_inplace_string<N, CharT, Traits, Policy>::size_type
+basic_inplace_string<N, CharT, Traits, Policy>::find(basic_string_view<CharT, Traits> sv, size_type pos) const noexcept
 {
 	return find(sv.data(), pos, sv.size());
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-typename basic_inplace_string<N, CharT, Traits>::size_type
-basic_inplace_string<N, CharT, Traits>::copy(value_type* dest, size_type count, size_type pos) const
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR typename basic_inplace_string<N, CharT, Traits, Policy>::size_type
+basic_inplace_string<N, CharT, Traits, Policy>::rfind(const basic_inplace_string& other, size_type pos) const noexcept
 {
-	if (pos > size())
-		detail::throw_helper<std::out_of_range>("basic_inplace_string::copy: out of range");
+	return rfind(other.data(), pos, other.size());
+}
 
-	size_type i = pos;
-	for (; i != pos + std::min(size() - pos, count); ++i, ++dest)
-		traits_type::assign(*dest, _data[i]);
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR typename basic_inplace_string<N, CharT, Traits, Policy>::size_type
+basic_inplace_string<N, CharT, Traits, Policy>::rfind(const value_type* str, size_type pos, size_type count) const noexcept
+{
+	const size_type sz = size();
+	if (count > sz)
+		return npos;
 
-	return i - pos;
+	size_type index = std::min(pos, sz - count);
+	if (count == 0)
+		return index;
+
+	if (detail::is_constant_evaluated())
+		return view_type(*this).rfind(str, pos, count);
+
+	while (true)
+	{
+		index = detail::find_last_char<N + 1, CharT, Traits>(_data.data(), index, *str);
+		if (index == npos || traits_type::compare(_data.data() + index, str, count) == 0)
+			return index;
+
+		if (index == 0)
+			return npos;
+
+		--index;
+	}
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-void basic_inplace_string<N, CharT, Traits>::resize(size_type sz)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR typename basic_inplace_string<N, CharT, Traits, Policy>::size_type
+basic_inplace_string<N, CharT, Traits, Policy>::rfind(const value_type* str, size_type pos) const noexcept
 {
-	resize(sz, value_type{});
+	return rfind(str, pos, traits_type::length(str));
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-void basic_inplace_string<N, CharT, Traits>::resize(size_type new_size, value_type ch)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR typename basic_inplace_string<N, CharT, Traits, Policy>::size_type
+basic_inplace_string<N, CharT, Traits, Policy>::rfind(value_type ch, size_type pos) const noexcept
+{
+	const size_type sz = size();
+	if (sz == 0)
+		return npos;
+
+	if (detail::is_constant_evaluated())
+		return view_type(*this).rfind(ch, pos);
+
+	return detail::find_last_char<N + 1, CharT, Traits>(_data.data(), std::min(pos, sz - 1), ch);
+}
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR typename basic_inplace_string<N, CharT, Traits, Policy>::size_type
+basic_inplace_string<N, CharT, Traits, Policy>::rfind(basic_string_view<CharT, Traits> sv, size_type pos) const noexcept
+{
+	return rfind(sv.data(), pos, sv.size());
+}
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR typename basic_inplace_string<N, CharT, Traits, Policy>::size_type
+basic_inplace_string<N, CharT, Traits, Policy>::find_first_of(const basic_inplace_string& other, size_type pos) const noexcept
 {
-	if (new_size > max_size())
-		detail::throw_helper<std::length_error>("basic_inplace_string::resize: exceed maximum string length");
+	return find_first_of(other.data(), pos, other.size());
+}
 
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR typename basic_inplace_string<N, CharT, Traits, Policy>::size_type
+basic_inplace_string<N, CharT, Traits, Policy>::find_first_of(const value_type* str, size_type pos, size_type count) const noexcept
+{
 	const size_type sz = size();
+	if (pos >= sz || count == 0)
+		return npos;
 
-	if (static_cast<difference_type>(new_size - sz) > 0)
-		traits_type::assign(&_data[sz], new_size - sz, ch);
+	if (detail::is_constant_evaluated())
+		return view_type(*this).find_first_of(str, pos, count);
 
-	traits_type::assign(_data[new_size], value_type{});
-	set_size(new_size);
+	return detail::find_first_of<N + 1, CharT, Traits>(_data.data(), pos, sz, str, count, false);
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-void basic_inplace_string<N, CharT, Traits>::swap(basic_inplace_string& other) noexcept
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR typename basic_inplace_string<N, CharT, Traits, Policy>::size_type
+basic_inplace_string<N, CharT, Traits, Policy>::find_first_of(const value_type* str, size_type pos) const noexcept
 {
-	basic_inplace_string s(other);
-	other = *this;
-	*this = s;
+	return find_first_of(str, pos, traits_type::length(str));
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-inline std::basic_ostream<CharT, Traits>& operator<<(std::basic_ostream<CharT, Traits>& os, const basic_inplace_string<N, CharT, Traits>& str)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR typename basic_inplace_string<N, CharT, Traits, Policy>::size_type
+basic_inplace_string<N, CharT, Traits, Policy>::find_first_of(value_type ch, size_type pos) const noexcept
 {
-	return os.write(str.data(), static_cast<std::streamsize>(str.size()));
+	return find(ch, pos);
 }
 
-template <std::size_t N, std::size_t M, typename CharT, typename Traits>
-inline bool operator==(const basic_inplace_string<N, CharT, Traits>& lhs,
-					   const basic_inplace_string<M, CharT, Traits>& rhs)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR typename basic_inplace_string<N, CharT, Traits, Policy>::size_type
+basic_inplace_string<N, CharT, Traits, Policy>::find_first_of(basic_string_view<CharT, Traits> sv, size_type pos) const noexcept
 {
-	return lhs.size() == rhs.size() && Traits::compare(lhs.data(), rhs.data(), lhs.size()) == 0;
+	return find_first_of(sv.data(), pos, sv.size());
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-inline bool operator==(const basic_inplace_string<N, CharT, Traits>& lhs,
-					   const CharT* rhs)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR typename basic_inplace_string<N, CharT, Traits, Policy>::size_type
+basic_inplace_string<N, CharT, Traits, Policy>::find_first_not_of(const basic_inplace_string& other, size_type pos) const noexcept
 {
-	assert(rhs != nullptr);
-	return lhs.size() == Traits::length(rhs) && Traits::compare(lhs.data(), rhs, lhs.size()) == 0;
+	return find_first_not_of(other.data(), pos, other.size());
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-inline bool operator==(const CharT* lhs,
-					   const basic_inplace_string<N, CharT, Traits>& rhs)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR typename basic_inplace_string<N, CharT, Traits, Policy>::size_type
+basic_inplace_string<N, CharT, Traits, Policy>::find_first_not_of(const value_type* str, size_type pos, size_type count) const noexcept
 {
-	return rhs == lhs;
+	const size_type sz = size();
+	if (pos >= sz)
+		return npos;
+
+	if (detail::is_constant_evaluated())
+		return view_type(*this).find_first_not_of(str, pos, count);
+
+	return detail::find_first_of<N + 1, CharT, Traits>(_data.data(), pos, sz, str, count, true);
 }
 
-template <std::size_t N, typename CharT, typename Traits, typename T, typename X = typename std::enable_if<std::is_convertible<const T&, basic_string_view<CharT, Traits>>::value>::type>
-inline bool operator==(const basic_inplace_string<N, CharT, Traits>& lhs,
-					   T rhs)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR typename basic_inplace_string<N, CharT, Traits, Policy>::size_type
+basic_inplace_string<N, CharT, Traits, Policy>::find_first_not_of(const value_type* str, size_type pos) const noexcept
 {
-	basic_string_view<CharT, Traits> sv = rhs;
-	return lhs.size() == sv.size() && Traits::compare(lhs.data(), sv.data(), lhs.size()) == 0;
+	return find_first_not_of(str, pos, traits_type::length(str));
 }
 
-template <std::size_t N, typename CharT, typename Traits, typename T, typename X = typename std::enable_if<std::is_convertible<const T&, basic_string_view<CharT, Traits>>::value>::type>
-inline bool operator==(T lhs,
-					   const basic_inplace_string<N, CharT, Traits>& rhs)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR typename basic_inplace_string<N, CharT, Traits, Policy>::size_type
+basic_inplace_string<N, CharT, Traits, Policy>::find_first_not_of(value_type ch, size_type pos) const noexcept
 {
-	return rhs == lhs;
+	return find_first_not_of(&ch, pos, 1);
 }
 
-template <std::size_t N, std::size_t M, typename CharT, typename Traits>
-inline bool operator!=(const basic_inplace_string<N, CharT, Traits>& lhs,
-					   const basic_inplace_string<M, CharT, Traits>& rhs)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR typename basic_inplace_string<N, CharT, Traits, Policy>::size_type
+basic_inplace_string<N, CharT, Traits, Policy>::find_first_not_of(basic_string_view<CharT, Traits> sv, size_type pos) const noexcept
 {
-	return !(lhs == rhs);
+	return find_first_not_of(sv.data(), pos, sv.size());
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-inline bool operator!=(const basic_inplace_string<N, CharT, Traits>& lhs,
-					   const CharT* rhs)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR typename basic_inplace_string<N, CharT, Traits, Policy>::size_type
+basic_inplace_string<N, CharT, Traits, Policy>::find_last_of(const basic_inplace_string& other, size_type pos) const noexcept
 {
-	assert(rhs != nullptr);
-	return lhs.size() != Traits::length(rhs) || Traits::compare(lhs.data(), rhs, lhs.size()) != 0;
+	return find_last_of(other.data(), pos, other.size());
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-inline bool operator!=(const CharT* lhs,
-					   const basic_inplace_string<N, CharT, Traits>& rhs)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR typename basic_inplace_string<N, CharT, Traits, Policy>::size_type
+basic_inplace_string<N, CharT, Traits, Policy>::find_last_of(const value_type* str, size_type pos, size_type count) const noexcept
 {
-	return rhs != lhs;
+	const size_type sz = size();
+	if (sz == 0 || count == 0)
+		return npos;
+
+	if (detail::is_constant_evaluated())
+		return view_type(*this).find_last_of(str, pos, count);
+
+	return detail::find_last_of<N + 1, CharT, Traits>(_data.data(), std::min(pos, sz - 1), str, count, false);
 }
 
-template <std::size_t N, typename CharT, typename Traits, typename T, typename X = typename std::enable_if<std::is_convertible<const T&, basic_string_view<CharT, Traits>>::value>::type>
-inline bool operator!=(const basic_inplace_string<N, CharT, Traits>& lhs,
-					   T rhs)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR typename basic_inplace_string<N, CharT, Traits, Policy>::size_type
+basic_inplace_string<N, CharT, Traits, Policy>::find_last_of(const value_type* str, size_type pos) const noexcept
 {
-	return !(lhs == rhs);
+	return find_last_of(str, pos, traits_type::length(str));
 }
 
-template <std::size_t N, typename CharT, typename Traits, typename T, typename X = typename std::enable_if<std::is_convertible<const T&, basic_string_view<CharT, Traits>>::value>::type>
-inline bool operator!=(T lhs,
-					   const basic_inplace_string<N, CharT, Traits>& rhs)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR typename basic_inplace_string<N, CharT, Traits, Policy>::size_type
+basic_inplace_string<N, CharT, Traits, Policy>::find_last_of(value_type ch, size_type pos) const noexcept
 {
-	return rhs != lhs;
+	return rfind(ch, pos);
 }
 
-template <std::size_t N, std::size_t M, typename CharT, typename Traits>
-inline bool operator<(const basic_inplace_string<N, CharT, Traits>& lhs,
-					  const basic_inplace_string<M, CharT, Traits>& rhs)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR typename basic_inplace_string<N, CharT, Traits, Policy>::size_type
+basic_inplace_string<N, CharT, Traits, Policy>::find_last_of(basic_string_view<CharT, Traits> sv, size_type pos) const noexcept
 {
-	return lhs.compare(rhs) < 0;
+	return find_last_of(sv.data(), pos, sv.size());
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-inline bool operator<(const basic_inplace_string<N, CharT, Traits>& lhs,
-					  const CharT* rhs)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR typename basic_inplace_string<N, CharT, Traits, Policy>::size_type
+basic_inplace_string<N, CharT, Traits, Policy>::find_last_not_of(const basic_inplace_string& other, size_type pos) const noexcept
 {
-	return lhs.compare(rhs) < 0;
+	return find_last_not_of(other.data(), pos, other.size());
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-inline bool operator<(const CharT* lhs,
-					  const basic_inplace_string<N, CharT, Traits>& rhs)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR typename basic_inplace_string<N, CharT, Traits, Policy>::size_type
+basic_inplace_string<N, CharT, Traits, Policy>::find_last_not_of(const value_type* str, size_type pos, size_type count) const noexcept
 {
-	return rhs.compare(lhs) > 0;
+	const size_type sz = size();
+	if (sz == 0)
+		return npos;
+
+	if (detail::is_constant_evaluated())
+		return view_type(*this).find_last_not_of(str, pos, count);
+
+	return detail::find_last_of<N + 1, CharT, Traits>(_data.data(), std::min(pos, sz - 1), str, count, true);
 }
 
-template <std::size_t N, typename CharT, typename Traits, typename T, typename X = typename std::enable_if<std::is_convertible<const T&, basic_string_view<CharT, Traits>>::value>::type>
-inline bool operator<(const basic_inplace_string<N, CharT, Traits>& lhs,
-					  T rhs)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR typename basic_inplace_string<N, CharT, Traits, Policy>::size_type
+basic_inplace_string<N, CharT, Traits, Policy>::find_last_not_of(const value_type* str, size_type pos) const noexcept
 {
-	basic_string_view<CharT, Traits> view = rhs;
-	return lhs.compare(view) < 0;
+	return find_last_not_of(str, pos, traits_type::length(str));
 }
 
-template <std::size_t N, typename CharT, typename Traits, typename T, typename X = typename std::enable_if<std::is_convertible<const T&, basic_string_view<CharT, Traits>>::value>::type>
-inline bool operator<(T lhs,
-					  const basic_inplace_string<N, CharT, Traits>& rhs)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR typename basic_inplace_string<N, CharT, Traits, Policy>::size_type
+basic_inplace_string<N, CharT, Traits, Policy>::find_last_not_of(value_type ch, size_type pos) const noexcept
 {
-	return rhs.compare(lhs) > 0;
+	return find_last_not_of(&ch, pos, 1);
 }
 
-template <std::size_t N, std::size_t M, typename CharT, typename Traits>
-inline bool operator>(const basic_inplace_string<N, CharT, Traits>& lhs,
-					  const basic_inplace_string<M, CharT, Traits>& rhs)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR typename basic_inplace_string<N, CharT, Traits, Policy>::size_type
+basic_inplace_string<N, CharT, Traits, Policy>::find_last_not_of(basic_string_view<CharT, Traits> sv, size_type pos) const noexcept
 {
-	return rhs < lhs;
+	return find_last_not_of(sv.data(), pos, sv.size());
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-inline bool operator>(const basic_inplace_string<N, CharT, Traits>& lhs,
-					  const CharT* rhs)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR typename basic_inplace_string<N, CharT, Traits, Policy>::size_type
+basic_inplace_string<N, CharT, Traits, Policy>::copy(value_type* dest, size_type count, size_type pos) const
 {
-	return rhs < lhs;
+	if (pos > size())
+		detail::throw_helper<std::out_of_range>("basic_inplace_string::copy: out of range");
+
+	size_type i = pos;
+	for (; i != pos + std::min(size() - pos, count); ++i, ++dest)
+		traits_type::assign(*dest, _data[i]);
+
+	return i - pos;
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-inline bool operator>(const CharT* lhs,
-					  const basic_inplace_string<N, CharT, Traits>& rhs)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR void basic_inplace_string<N, CharT, Traits, Policy>::resize(size_type sz)
 {
-	return rhs < lhs;
+	resize(sz, value_type{});
 }
 
-template <std::size_t N, typename CharT, typename Traits, typename T, typename X = typename std::enable_if<std::is_convertible<const T&, basic_string_view<CharT, Traits>>::value>::type>
-inline bool operator>(const basic_inplace_string<N, CharT, Traits>& lhs,
-					  T rhs)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR void basic_inplace_string<N, CharT, Traits, Policy>::resize(size_type new_size, value_type ch)
 {
-	return rhs < lhs;
+	const size_type sz = size();
+	if (new_size > sz)
+	{
+		const size_type count = fit_length(sz, new_size - sz, "basic_inplace_string::resize: exceed maximum string length");
+		traits_type::assign(_data.data() + sz, count, ch);
+		new_size = sz + count;
+	}
+
+	update_size(sz, new_size);
 }
 
-template <std::size_t N, typename CharT, typename Traits, typename T, typename X = typename std::enable_if<std::is_convertible<const T&, basic_string_view<CharT, Traits>>::value>::type>
-inline bool operator>(T lhs,
-					  const basic_inplace_string<N, CharT, Traits>& rhs)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+template <typename Operation>
+INPLACE_STRING_CONSTEXPR void basic_inplace_string<N, CharT, Traits, Policy>::resize_and_overwrite(size_type count, Operation op)
 {
-	return rhs < lhs;
+	const size_type sz = size();
+	count = fit_length(0, count, "basic_inplace_string::resize_and_overwrite: exceed maximum string length");
+
+	const size_type new_size = static_cast<size_type>(std::move(op)(_data.data(), count));
+	assert(new_size <= count);
+
+	// Zero padding: op may have written anywhere below count.
+	update_size(std::max(sz, count), new_size);
 }
 
-template <std::size_t N, std::size_t M, typename CharT, typename Traits>
-inline bool operator<=(const basic_inplace_string<N, CharT, Traits>& lhs,
-					   const basic_inplace_string<M, CharT, Traits>& rhs)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR typename basic_inplace_string<N, CharT, Traits, Policy>::write_span
+basic_inplace_string<N, CharT, Traits, Policy>::prepare_append() noexcept
 {
-	return !(rhs < lhs);
+	const size_type sz = size();
+	return write_span{_data.data() + sz, max_size() - sz};
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-inline bool operator<=(const basic_inplace_string<N, CharT, Traits>& lhs,
-					   const CharT* rhs)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR void basic_inplace_string<N, CharT, Traits, Policy>::commit_append(size_type count) noexcept
 {
-	return !(rhs < lhs);
+	const size_type sz = size();
+	assert(count <= max_size() - sz);
+
+	// Zero padding: the writer may have gone past count.
+	update_size(Policy::zero_padded ? max_size() : sz + count, sz + count);
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-inline bool operator<=(const CharT* lhs,
-					   const basic_inplace_string<N, CharT, Traits>& rhs)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+INPLACE_STRING_CONSTEXPR void basic_inplace_string<N, CharT, Traits, Policy>::swap(basic_inplace_string& other) noexcept
 {
-	return !(rhs < lhs);
+	this->swap_overflow(other);
+
+	if (detail::is_constant_evaluated())
+	{
+		_data.swap(other._data);
+		return;
+	}
+
+	// Fixed-size copies of the storage: for small N, two loads and two stores in registers.
+	unsigned char tmp[sizeof(_data)];
+	std::memcpy(tmp, _data.data(), sizeof(_data));
+	std::memcpy(_data.data(), other._data.data(), sizeof(_data));
+	std::memcpy(other._data.data(), tmp, sizeof(_data));
+
+	using cache = detail::hash_cache<Policy::cache_hash>;
+	std::swap(static_cast<cache&>(*this), static_cast<cache&>(other));
 }
 
-template <std::size_t N, typename CharT, typename Traits, typename T, typename X = typename std::enable_if<std::is_convertible<const T&, basic_string_view<CharT, Traits>>::value>::type>
-inline bool operator<=(const basic_inplace_string<N, CharT, Traits>& lhs,
-					   T rhs)
+namespace detail
 {
-	return !(rhs < lhs);
+
+// Pieces of a concatenation, each with a capacity known at compile time. A string or a literal is copied as a
+// fixed-size block of its capacity, the next piece overwriting what is past its size.
+template <std::size_t Capacity, typename CharT, typename Traits>
+struct concat_piece
+{
+	using value_type = CharT;
+	using traits_type = Traits;
+
+	static constexpr const std::size_t capacity = Capacity;
+
+	const CharT* str;
+	std::size_t size;
+
+	// As for std::string, a character array holds a string up to its first null character: the capacity is
+	// that of a literal, the size is only known at run time for a buffer.
+	static INPLACE_STRING_CONSTEXPR concat_piece from_array(const CharT* arr) noexcept
+	{
+		const CharT* const end = Traits::find(arr, Capacity, CharT());
+		return {arr, end ? static_cast<std::size_t>(end - arr) : Capacity};
+	}
+
+	INPLACE_STRING_CONSTEXPR std::size_t write(CharT* dest) const noexcept
+	{
+		if (is_constant_evaluated())
+			Traits::copy(dest, str, size);
+		else
+			std::memcpy(dest, str, Capacity * sizeof(CharT));
+		return size;
+	}
+};
+
+template <typename CharT, typename Traits>
+struct concat_char
+{
+	using value_type = CharT;
+	using traits_type = Traits;
+
+	static constexpr const std::size_t capacity = 1;
+
+	CharT ch;
+
+	INPLACE_STRING_CONSTEXPR std::size_t write(CharT* dest) const noexcept
+	{
+		Traits::assign(*dest, ch);
+		return 1;
+	}
+};
+
+template <typename Lhs, typename Rhs>
+class concat_expr
+{
+public:
+	using value_type = typename Lhs::value_type;
+	using traits_type = typename Lhs::traits_type;
+
+	static constexpr const std::size_t capacity = Lhs::capacity + Rhs::capacity;
+
+	INPLACE_STRING_CONSTEXPR concat_expr(const Lhs& lhs, const Rhs& rhs) noexcept : _lhs(lhs), _rhs(rhs) {}
+
+	// Writes the pieces at dest, which has room for capacity characters, and returns the size written
+	INPLACE_STRING_CONSTEXPR std::size_t write(value_type* dest) const noexcept
+	{
+		const std::size_t size = _lhs.write(dest);
+		return size + _rhs.write(dest + size);
+	}
+
+	INPLACE_STRING_CONSTEXPR basic_inplace_string<capacity, value_type, traits_type> str() const noexcept { return *this; }
+
+private:
+	Lhs _lhs;
+	Rhs _rhs;
+};
+
+template <typename T>
+struct concat_operand : std::false_type {};
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+struct concat_operand<basic_inplace_string<N, CharT, Traits, Policy>> : std::true_type
+{
+	using type = concat_piece<N, CharT, Traits>;
+
+	static INPLACE_STRING_CONSTEXPR type make(const basic_inplace_string<N, CharT, Traits, Policy>& str) noexcept { return {str.data(), str.size()}; }
+};
+
+template <typename Lhs, typename Rhs>
+struct concat_operand<concat_expr<Lhs, Rhs>> : std::true_type
+{
+	using type = concat_expr<Lhs, Rhs>;
+
+	static INPLACE_STRING_CONSTEXPR const type& make(const type& expr) noexcept { return expr; }
+};
+
+template <typename Lhs, typename Rhs, bool = concat_operand<Lhs>::value && concat_operand<Rhs>::value>
+struct is_concat_operands : std::false_type {};
+
+template <typename Lhs, typename Rhs>
+struct is_concat_operands<Lhs, Rhs, true> :
+	std::integral_constant<bool, std::is_same<typename Lhs::value_type, typename Rhs::value_type>::value
+								 && std::is_same<typename Lhs::traits_type, typename Rhs::traits_type>::value> {};
+
+template <typename String, typename CharT>
+struct is_concat_operand_of :
+	std::integral_constant<bool, concat_operand<String>::value && std::is_same<typename String::value_type, CharT>::value> {};
+
+template <typename Lhs, typename Rhs>
+using concat_result = concat_expr<typename concat_operand<Lhs>::type, typename concat_operand<Rhs>::type>;
+
 }
 
-template <std::size_t N, typename CharT, typename Traits, typename T, typename X = typename std::enable_if<std::is_convertible<const T&, basic_string_view<CharT, Traits>>::value>::type>
-inline bool operator<=(T lhs,
-					   const basic_inplace_string<N, CharT, Traits>& rhs)
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+template <typename Lhs, typename Rhs>
+INPLACE_STRING_CONSTEXPR basic_inplace_string<N, CharT, Traits, Policy>::basic_inplace_string(const detail::concat_expr<Lhs, Rhs>& expr) noexcept
 {
-	return !(rhs < lhs);
+	static_assert(detail::concat_expr<Lhs, Rhs>::capacity <= max_size(), "basic_inplace_string: concatenation exceeds maximum capacity");
+	static_assert(std::is_same<typename detail::concat_expr<Lhs, Rhs>::traits_type, Traits>::value, "basic_inplace_string: concatenation of another traits type");
+
+	const size_type sz = expr.write(_data.data());
+
+	if (Policy::zero_padded || detail::is_constant_evaluated())
+		traits_type::assign(_data.data() + sz, N - sz, value_type{});
+	else if (Policy::null_terminated)
+		traits_type::assign(_data[sz], value_type{});
+
+	init_trailer_terminator();
+	set_size(sz);
 }
 
-template <std::size_t N, std::size_t M, typename CharT, typename Traits>
-inline bool operator>=(const basic_inplace_string<N, CharT, Traits>& lhs,
-					   const basic_inplace_string<M, CharT, Traits>& rhs)
+// A concatenation is an expression that a basic_inplace_string is built from, copying each piece once. Its
+// capacity adds up the capacities of the pieces: N for a basic_inplace_string<N>, the length of a string literal
+// and 1 for a character. A string too small for it does not compile, so there is no capacity check left.
+// The expression refers to the strings it is made of: build the string in the same statement, or call str().
+template <typename Lhs, typename Rhs, typename X = typename std::enable_if<detail::is_concat_operands<Lhs, Rhs>::value>::type>
+inline INPLACE_STRING_CONSTEXPR detail::concat_result<Lhs, Rhs> operator+(const Lhs& lhs, const Rhs& rhs) noexcept
 {
-	return !(lhs < rhs);
+	return {detail::concat_operand<Lhs>::make(lhs), detail::concat_operand<Rhs>::make(rhs)};
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-inline bool operator>=(const basic_inplace_string<N, CharT, Traits>& lhs,
-					   const CharT* rhs)
+template <typename Lhs, typename CharT, std::size_t M, typename X = typename std::enable_if<detail::is_concat_operand_of<Lhs, CharT>::value>::type>
+inline INPLACE_STRING_CONSTEXPR detail::concat_expr<typename detail::concat_operand<Lhs>::type, detail::concat_piece<M - 1, CharT, typename Lhs::traits_type>>
+operator+(const Lhs& lhs, const CharT(&rhs)[M]) noexcept
 {
-	return !(lhs < rhs);
+	return {detail::concat_operand<Lhs>::make(lhs), detail::concat_piece<M - 1, CharT, typename Lhs::traits_type>::from_array(rhs)};
 }
 
-template <std::size_t N, typename CharT, typename Traits>
-inline bool operator>=(const CharT* lhs,
-					   const basic_inplace_string<N, CharT, Traits>& rhs)
+template <typename Rhs, typename CharT, std::size_t M, typename X = typename std::enable_if<detail::is_concat_operand_of<Rhs, CharT>::value>::type>
+inline INPLACE_STRING_CONSTEXPR detail::concat_expr<detail::concat_piece<M - 1, CharT, typename Rhs::traits_type>, typename detail::concat_operand<Rhs>::type>
+operator+(const CharT(&lhs)[M], const Rhs& rhs) noexcept
 {
-	return !(lhs < rhs);
+	return {detail::concat_piece<M - 1, CharT, typename Rhs::traits_type>::from_array(lhs), detail::concat_operand<Rhs>::make(rhs)};
 }
 
-template <std::size_t N, typename CharT, typename Traits, typename T, typename X = typename std::enable_if<std::is_convertible<const T&, basic_string_view<CharT, Traits>>::value>::type>
-inline bool operator>=(const basic_inplace_string<N, CharT, Traits>& lhs,
-					   T rhs)
+template <typename Lhs, typename X = typename std::enable_if<detail::concat_operand<Lhs>::value>::type>
+inline INPLACE_STRING_CONSTEXPR detail::concat_expr<typename detail::concat_operand<Lhs>::type, detail::concat_char<typename Lhs::value_type, typename Lhs::traits_type>>
+operator+(const Lhs& lhs, typename Lhs::value_type rhs) noexcept
 {
-	return !(lhs < rhs);
+	return {detail::concat_operand<Lhs>::make(lhs), {rhs}};
 }
 
-template <std::size_t N, typename CharT, typename Traits, typename T, typename X = typename std::enable_if<std::is_convertible<const T&, basic_string_view<CharT, Traits>>::value>::type>
-inline bool operator>=(T lhs,
-					   const basic_inplace_string<N, CharT, Traits>& rhs)
+template <typename Rhs, typename X = typename std::enable_if<detail::concat_operand<Rhs>::value>::type>
+inline INPLACE_STRING_CONSTEXPR detail::concat_expr<detail::concat_char<typename Rhs::value_type, typename Rhs::traits_type>, typename detail::concat_operand<Rhs>::type>
+operator+(typename Rhs::value_type lhs, const Rhs& rhs) noexcept
 {
-	return !(lhs < rhs);
+	return {{lhs}, detail::concat_operand<Rhs>::make(rhs)};
+}
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+inline std::basic_ostream<CharT, Traits>& operator<<(std::basic_ostream<CharT, Traits>& os, const basic_inplace_string<N, CharT, Traits, Policy>& str)
+{
+	return os.write(str.data(), static_cast<std::streamsize>(str.size()));
 }
 
 namespace detail
 {
 
+// Access to the get area of a stream buffer: the protected members are named through a derived class, and
+// the pointers to members obtained that way apply to any stream buffer.
 template <typename CharT, typename Traits>
-inline const CharT* search_substring(const CharT* first1, const CharT* last1, const CharT* first2, const CharT* last2)
+struct get_area : std::basic_streambuf<CharT, Traits>
 {
-	assert(last1 >= first1);
-	assert(last2 >= first2);
+	static const CharT* begin(std::basic_streambuf<CharT, Traits>* sb) { return (sb->*&get_area::gptr)(); }
+	static const CharT* end(std::basic_streambuf<CharT, Traits>* sb) { return (sb->*&get_area::egptr)(); }
+	static void bump(std::basic_streambuf<CharT, Traits>* sb, std::size_t count) { (sb->*&get_area::gbump)(static_cast<int>(count)); }
+};
 
-	const std::size_t size2 = static_cast<std::size_t>(last2 - first2);
+// Characters available without copying them: the get area of the buffer, refilled when empty. An unbuffered
+// stream buffer gives its characters one by one, through ch. Empty at end of file. in_avail() is not used, as
+// it counts characters the stream buffer may have outside of its get area.
+template <typename CharT, typename Traits>
+basic_string_view<CharT, Traits> buffered_chars(std::basic_streambuf<CharT, Traits>* sb, CharT& ch)
+{
+	const typename Traits::int_type c = sb->sgetc();
+	if (Traits::eq_int_type(c, Traits::eof()))
+		return {};
 
-	while (true)
-	{
-		const std::size_t size1 = static_cast<std::size_t>(last1 - first1);
-		if (size1 < size2)
-			return nullptr;
+	const CharT* const first = get_area<CharT, Traits>::begin(sb);
+	const std::size_t avail = static_cast<std::size_t>(get_area<CharT, Traits>::end(sb) - first);
+	if (avail > 0)
+		return {first, std::min<std::size_t>(avail, std::numeric_limits<int>::max())};
 
-		first1 = Traits::find(first1, size1, *first2);
-		if (first1 == nullptr)
-			return nullptr;
+	ch = Traits::to_char_type(c);
+	return {&ch, 1};
+}
 
-		if (Traits::compare(first1, first2, size2) == 0)
-			return first1;
+// Extracts the first count characters returned by buffered_chars.
+template <typename CharT, typename Traits>
+void consume(std::basic_streambuf<CharT, Traits>* sb, basic_string_view<CharT, Traits> chars, const CharT& ch, std::size_t count)
+{
+	if (chars.data() != &ch)
+		get_area<CharT, Traits>::bump(sb, count);
+	else if (count != 0)
+		sb->sbumpc();
+}
 
-		++first1;
-	}
+// Appends the first count characters returned by buffered_chars to str, straight from the buffer of the stream.
+// Small strings filled from the start copy their whole capacity when the buffer holds that many characters: a
+// fixed-size copy in registers, where a variable length would go through rep movs. commit_append drops the
+// characters past count.
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+void extract(std::basic_streambuf<CharT, Traits>* sb, basic_string_view<CharT, Traits> chars, const CharT& ch,
+			 basic_inplace_string<N, CharT, Traits, Policy>& str, std::size_t count)
+{
+	const auto span = str.prepare_append();
+	assert(count <= span.size);
+	if (N * sizeof(CharT) <= 64 && span.size == N && chars.size() >= N)
+		Traits::copy(span.data, chars.data(), N);
+	else
+		Traits::copy(span.data, chars.data(), count);
+	str.commit_append(count);
+	consume(sb, chars, ch, count);
+}
 
-	return nullptr;
+// First whitespace of [first, last): ctype<char>::is is an inline table lookup, where scan_is is a call into
+// the library that tests the characters one by one as well.
+template <typename CharT>
+const CharT* find_space(const std::ctype<CharT>& ctype, const CharT* first, const CharT* last)
+{
+	return ctype.scan_is(std::ctype_base::space, first, last);
 }
 
+inline const char* find_space(const std::ctype<char>& ctype, const char* first, const char* last)
+{
+	while (first != last && !ctype.is(std::ctype_base::space, *first))
+		++first;
+	return first;
 }
 
-template <std::size_t N> using inplace_string = basic_inplace_string<N, char>;
-template <std::size_t N> using inplace_wstring = basic_inplace_string<N, wchar_t>;
-template <std::size_t N> using inplace_u16string = basic_inplace_string<N, char16_t>;
-template <std::size_t N> using inplace_u32string = basic_inplace_string<N, char32_t>;
+template <typename CharT>
+const CharT* find_non_space(const std::ctype<CharT>& ctype, const CharT* first, const CharT* last)
+{
+	return ctype.scan_not(std::ctype_base::space, first, last);
+}
 
-namespace std
+inline const char* find_non_space(const std::ctype<char>& ctype, const char* first, const char* last)
 {
+	while (first != last && ctype.is(std::ctype_base::space, *first))
+		++first;
+	return first;
+}
 
-template <std::size_t N, typename CharT, typename Traits>
-struct hash<basic_inplace_string<N, CharT, Traits>>
+// A field longer than the capacity: with the throwing policy, the stream fails and the rest of the field stays
+// in the stream. Other policies get one more character and apply their overflow handling to it, then the rest
+// of the field is dropped: true is returned then.
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+bool extract_overflow(std::basic_streambuf<CharT, Traits>* sb, basic_inplace_string<N, CharT, Traits, Policy>& str,
+					  std::ios_base::iostate& state)
 {
-	size_t operator()(const basic_inplace_string<N, CharT, Traits>& str) const
+	if (Policy::overflow == inplace_string_overflow::throw_exception)
 	{
-		using view = basic_string_view<CharT, Traits>;
+		state |= std::ios_base::failbit;
+		return false;
+	}
+
+	str.push_back(Traits::to_char_type(sb->sgetc()));
+	return true;
+}
+
+}
 
-		const view v(str.data(), str.size());
-		return std::hash<view>()(v);
+// Extracts a whitespace-delimited word, as for std::string: leading whitespace is skipped unless noskipws is
+// set, at most width() characters are extracted when it is positive, and failbit is set when nothing is.
+// The word is copied straight from the buffer of the stream, without going through a temporary. A word
+// longer than the capacity is handled as in getline.
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+std::basic_istream<CharT, Traits>& operator>>(std::basic_istream<CharT, Traits>& is, basic_inplace_string<N, CharT, Traits, Policy>& str)
+{
+	std::ios_base::iostate state = std::ios_base::goodbit;
+	const typename std::basic_istream<CharT, Traits>::sentry sentry(is, true);
+	if (sentry)
+	{
+		str.clear();
+
+		const std::ctype<CharT>& ctype = std::use_facet<std::ctype<CharT>>(is.getloc());
+		std::basic_streambuf<CharT, Traits>* const sb = is.rdbuf();
+		std::size_t limit = is.width() > 0 ? static_cast<std::size_t>(is.width()) : std::size_t(-1);
+		std::size_t extracted = 0;
+		bool discard = false;
+		CharT ch;
+
+		// The leading whitespace is skipped here rather than by the sentry, a buffer at a time
+		while (is.flags() & std::ios_base::skipws)
+		{
+			const basic_string_view<CharT, Traits> chars = detail::buffered_chars(sb, ch);
+			if (chars.empty())
+				break;
+
+			const std::size_t blank = static_cast<std::size_t>(detail::find_non_space(ctype, chars.data(), chars.data() + chars.size()) - chars.data());
+			detail::consume(sb, chars, ch, blank);
+			if (blank != chars.size())
+				break;
+		}
+
+		while (limit != 0)
+		{
+			const basic_string_view<CharT, Traits> chars = detail::buffered_chars(sb, ch);
+			if (chars.empty())
+			{
+				state |= std::ios_base::eofbit;
+				break;
+			}
+
+			const CharT* const first = chars.data();
+			const std::size_t word = std::min(static_cast<std::size_t>(detail::find_space(ctype, first, first + chars.size()) - first), limit);
+			if (discard)
+			{
+				detail::consume(sb, chars, ch, word);
+				extracted += word;
+				limit -= word;
+			}
+			else
+			{
+				const std::size_t count = std::min(word, str.max_size() - str.size());
+				detail::extract(sb, chars, ch, str, count);
+				extracted += count;
+				limit -= count;
+				if (count != word)
+				{
+					if (!detail::extract_overflow(sb, str, state))
+						break;
+					discard = true;
+					continue;
+				}
+			}
+
+			if (word != chars.size())
+				break;
+		}
+
+		if (extracted == 0)
+			state |= std::ios_base::failbit;
+		is.width(0);
 	}
-};
+	else
+		state |= std::ios_base::failbit;
+
+	is.setstate(state);
+	return is;
+}
+
+// Extracts characters up to delim, which is extracted but not stored, as for std::string: failbit is set when
+// nothing is extracted, eofbit when the end of the stream is reached first. The delimiter is searched in the
+// buffer of the stream and the line is copied from it. A line longer than the capacity sets
+// failbit with the throwing policy, leaving the rest of the line in the stream; the other overflow policies
+// apply to the first character that does not fit, and the rest of the line is dropped.
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+std::basic_istream<CharT, Traits>& getline(std::basic_istream<CharT, Traits>& is, basic_inplace_string<N, CharT, Traits, Policy>& str, CharT delim)
+{
+	std::ios_base::iostate state = std::ios_base::goodbit;
+	const typename std::basic_istream<CharT, Traits>::sentry sentry(is, true);
+	if (sentry)
+	{
+		str.clear();
+
+		std::basic_streambuf<CharT, Traits>* const sb = is.rdbuf();
+		std::size_t extracted = 0;
+		bool discard = false;
+		CharT ch;
+
+		for (;;)
+		{
+			const basic_string_view<CharT, Traits> chars = detail::buffered_chars(sb, ch);
+			if (chars.empty())
+			{
+				state |= std::ios_base::eofbit;
+				break;
+			}
+
+			const CharT* const hit = Traits::find(chars.data(), chars.size(), delim);
+			const std::size_t line = hit != nullptr ? static_cast<std::size_t>(hit - chars.data()) : chars.size();
+			if (discard)
+			{
+				detail::consume(sb, chars, ch, line);
+				extracted += line;
+			}
+			else
+			{
+				const std::size_t count = std::min(line, str.max_size() - str.size());
+				detail::extract(sb, chars, ch, str, count);
+				extracted += count;
+				if (count != line)
+				{
+					if (!detail::extract_overflow(sb, str, state))
+						break;
+					discard = true;
+					continue;
+				}
+			}
+
+			if (hit != nullptr)
+			{
+				sb->sbumpc();
+				++extracted;
+				break;
+			}
+		}
+
+		if (extracted == 0)
+			state |= std::ios_base::failbit;
+	}
+	else
+		state |= std::ios_base::failbit;
+
+	is.setstate(state);
+	return is;
+}
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+std::basic_istream<CharT, Traits>& getline(std::basic_istream<CharT, Traits>& is, basic_inplace_string<N, CharT, Traits, Policy>& str)
+{
+	return getline(is, str, is.widen('\n'));
+}
+
+template <std::size_t N, std::size_t M, typename CharT, typename Traits, typename Policy, typename OtherPolicy>
+inline INPLACE_STRING_CONSTEXPR bool operator==(const basic_inplace_string<N, CharT, Traits, Policy>& lhs,
+					   const basic_inplace_string<M, CharT, Traits, OtherPolicy>& rhs)
+{
+	return lhs.size() == rhs.size() && Traits::compare(lhs.data(), rhs.data(), lhs.size()) == 0;
+}
+
+namespace detail
+{
+
+struct generic_equal_tag {};
+struct register_equal_tag {};
+struct whole_block_equal_tag {};
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+inline INPLACE_STRING_CONSTEXPR bool equal(const basic_inplace_string<N, CharT, Traits, Policy>& lhs,
+				  const basic_inplace_string<N, CharT, Traits, Policy>& rhs, generic_equal_tag)
+{
+	return lhs.size() == rhs.size() && Traits::compare(lhs.data(), rhs.data(), lhs.size()) == 0;
+}
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+inline INPLACE_STRING_CONSTEXPR bool equal(const basic_inplace_string<N, CharT, Traits, Policy>& lhs,
+				  const basic_inplace_string<N, CharT, Traits, Policy>& rhs, register_equal_tag)
+{
+	return register_equal<N>(lhs.data(), lhs.size(), rhs.data(), rhs.size());
+}
+
+// Zero-padded storage is canonical: the size lives in the last character or the trailer, the rest past the
+// string is zero.
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+inline INPLACE_STRING_CONSTEXPR bool equal(const basic_inplace_string<N, CharT, Traits, Policy>& lhs,
+				  const basic_inplace_string<N, CharT, Traits, Policy>& rhs, whole_block_equal_tag)
+{
+	return std::memcmp(lhs.data(), rhs.data(), size_field_of<N, CharT, Policy>::storage * sizeof(CharT)) == 0;
+}
+
+}
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+inline INPLACE_STRING_CONSTEXPR bool operator==(const basic_inplace_string<N, CharT, Traits, Policy>& lhs,
+					   const basic_inplace_string<N, CharT, Traits, Policy>& rhs)
+{
+	if (lhs.hash_differs(rhs))
+		return false;
+
+	if (detail::is_constant_evaluated())
+		return detail::equal(lhs, rhs, detail::generic_equal_tag{});
+
+	using tag = typename std::conditional<Policy::zero_padded && detail::is_bitwise_comparable<CharT, Traits>::value,
+		detail::whole_block_equal_tag,
+		typename std::conditional<detail::is_register_comparable<N, CharT, Traits>::value,
+			detail::register_equal_tag,
+			detail::generic_equal_tag>::type>::type;
+	return detail::equal(lhs, rhs, tag{});
+}
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+inline INPLACE_STRING_CONSTEXPR bool operator==(const basic_inplace_string<N, CharT, Traits, Policy>& lhs,
+					   const CharT* rhs)
+{
+	assert(rhs != nullptr);
+	return lhs.size() == Traits::length(rhs) && Traits::compare(lhs.data(), rhs, lhs.size()) == 0;
+}
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+inline INPLACE_STRING_CONSTEXPR bool operator==(const CharT* lhs,
+					   const basic_inplace_string<N, CharT, Traits, Policy>& rhs)
+{
+	return rhs == lhs;
+}
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy, typename T, typename X = typename std::enable_if<std::is_convertible<const T&, basic_string_view<CharT, Traits>>::value>::type>
+inline INPLACE_STRING_CONSTEXPR bool operator==(const basic_inplace_string<N, CharT, Traits, Policy>& lhs,
+					   T rhs)
+{
+	basic_string_view<CharT, Traits> sv = rhs;
+	return lhs.size() == sv.size() && Traits::compare(lhs.data(), sv.data(), lhs.size()) == 0;
+}
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy, typename T, typename X = typename std::enable_if<std::is_convertible<const T&, basic_string_view<CharT, Traits>>::value>::type>
+inline INPLACE_STRING_CONSTEXPR bool operator==(T lhs,
+					   const basic_inplace_string<N, CharT, Traits, Policy>& rhs)
+{
+	return rhs == lhs;
+}
+
+template <std::size_t N, std::size_t M, typename CharT, typename Traits, typename Policy, typename OtherPolicy>
+inline INPLACE_STRING_CONSTEXPR bool operator!=(const basic_inplace_string<N, CharT, Traits, Policy>& lhs,
+					   const basic_inplace_string<M, CharT, Traits, OtherPolicy>& rhs)
+{
+	return !(lhs == rhs);
+}
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+inline INPLACE_STRING_CONSTEXPR bool operator!=(const basic_inplace_string<N, CharT, Traits, Policy>& lhs,
+					   const CharT* rhs)
+{
+	assert(rhs != nullptr);
+	return lhs.size() != Traits::length(rhs) || Traits::compare(lhs.data(), rhs, lhs.size()) != 0;
+}
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+inline INPLACE_STRING_CONSTEXPR bool operator!=(const CharT* lhs,
+					   const basic_inplace_string<N, CharT, Traits, Policy>& rhs)
+{
+	return rhs != lhs;
+}
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy, typename T, typename X = typename std::enable_if<std::is_convertible<const T&, basic_string_view<CharT, Traits>>::value>::type>
+inline INPLACE_STRING_CONSTEXPR bool operator!=(const basic_inplace_string<N, CharT, Traits, Policy>& lhs,
+					   T rhs)
+{
+	return !(lhs == rhs);
+}
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy, typename T, typename X = typename std::enable_if<std::is_convertible<const T&, basic_string_view<CharT, Traits>>::value>::type>
+inline INPLACE_STRING_CONSTEXPR bool operator!=(T lhs,
+					   const basic_inplace_string<N, CharT, Traits, Policy>& rhs)
+{
+	return rhs != lhs;
+}
+
+template <std::size_t N, std::size_t M, typename CharT, typename Traits, typename Policy, typename OtherPolicy>
+inline INPLACE_STRING_CONSTEXPR bool operator<(const basic_inplace_string<N, CharT, Traits, Policy>& lhs,
+					  const basic_inplace_string<M, CharT, Traits, OtherPolicy>& rhs)
+{
+	return lhs.compare(rhs) < 0;
+}
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+inline INPLACE_STRING_CONSTEXPR bool operator<(const basic_inplace_string<N, CharT, Traits, Policy>& lhs,
+					  const CharT* rhs)
+{
+	return lhs.compare(rhs) < 0;
+}
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+inline INPLACE_STRING_CONSTEXPR bool operator<(const CharT* lhs,
+					  const basic_inplace_string<N, CharT, Traits, Policy>& rhs)
+{
+	return rhs.compare(lhs) > 0;
+}
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy, typename T, typename X = typename std::enable_if<std::is_convertible<const T&, basic_string_view<CharT, Traits>>::value>::type>
+inline INPLACE_STRING_CONSTEXPR bool operator<(const basic_inplace_string<N, CharT, Traits, Policy>& lhs,
+					  T rhs)
+{
+	basic_string_view<CharT, Traits> view = rhs;
+	return lhs.compare(view) < 0;
+}
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy, typename T, typename X = typename std::enable_if<std::is_convertible<const T&, basic_string_view<CharT, Traits>>::value>::type>
+inline INPLACE_STRING_CONSTEXPR bool operator<(T lhs,
+					  const basic_inplace_string<N, CharT, Traits, Policy>& rhs)
+{
+	return rhs.compare(lhs) > 0;
+}
+
+template <std::size_t N, std::size_t M, typename CharT, typename Traits, typename Policy, typename OtherPolicy>
+inline INPLACE_STRING_CONSTEXPR bool operator>(const basic_inplace_string<N, CharT, Traits, Policy>& lhs,
+					  const basic_inplace_string<M, CharT, Traits, OtherPolicy>& rhs)
+{
+	return rhs < lhs;
+}
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+inline INPLACE_STRING_CONSTEXPR bool operator>(const basic_inplace_string<N, CharT, Traits, Policy>& lhs,
+					  const CharT* rhs)
+{
+	return rhs < lhs;
+}
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+inline INPLACE_STRING_CONSTEXPR bool operator>(const CharT* lhs,
+					  const basic_inplace_string<N, CharT, Traits, Policy>& rhs)
+{
+	return rhs < lhs;
+}
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy, typename T, typename X = typename std::enable_if<std::is_convertible<const T&, basic_string_view<CharT, Traits>>::value>::type>
+inline INPLACE_STRING_CONSTEXPR bool operator>(const basic_inplace_string<N, CharT, Traits, Policy>& lhs,
+					  T rhs)
+{
+	return rhs < lhs;
+}
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy, typename T, typename X = typename std::enable_if<std::is_convertible<const T&, basic_string_view<CharT, Traits>>::value>::type>
+inline INPLACE_STRING_CONSTEXPR bool operator>(T lhs,
+					  const basic_inplace_string<N, CharT, Traits, Policy>& rhs)
+{
+	return rhs < lhs;
+}
+
+template <std::size_t N, std::size_t M, typename CharT, typename Traits, typename Policy, typename OtherPolicy>
+inline INPLACE_STRING_CONSTEXPR bool operator<=(const basic_inplace_string<N, CharT, Traits, Policy>& lhs,
+					   const basic_inplace_string<M, CharT, Traits, OtherPolicy>& rhs)
+{
+	return !(rhs < lhs);
+}
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+inline INPLACE_STRING_CONSTEXPR bool operator<=(const basic_inplace_string<N, CharT, Traits, Policy>& lhs,
+					   const CharT* rhs)
+{
+	return !(rhs < lhs);
+}
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+inline INPLACE_STRING_CONSTEXPR bool operator<=(const CharT* lhs,
+					   const basic_inplace_string<N, CharT, Traits, Policy>& rhs)
+{
+	return !(rhs < lhs);
+}
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy, typename T, typename X = typename std::enable_if<std::is_convertible<const T&, basic_string_view<CharT, Traits>>::value>::type>
+inline INPLACE_STRING_CONSTEXPR bool operator<=(const basic_inplace_string<N, CharT, Traits, Policy>& lhs,
+					   T rhs)
+{
+	return !(rhs < lhs);
+}
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy, typename T, typename X = typename std::enable_if<std::is_convertible<const T&, basic_string_view<CharT, Traits>>::value>::type>
+inline INPLACE_STRING_CONSTEXPR bool operator<=(T lhs,
+					   const basic_inplace_string<N, CharT, Traits, Policy>& rhs)
+{
+	return !(rhs < lhs);
+}
+
+template <std::size_t N, std::size_t M, typename CharT, typename Traits, typename Policy, typename OtherPolicy>
+inline INPLACE_STRING_CONSTEXPR bool operator>=(const basic_inplace_string<N, CharT, Traits, Policy>& lhs,
+					   const basic_inplace_string<M, CharT, Traits, OtherPolicy>& rhs)
+{
+	return !(lhs < rhs);
+}
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+inline INPLACE_STRING_CONSTEXPR bool operator>=(const basic_inplace_string<N, CharT, Traits, Policy>& lhs,
+					   const CharT* rhs)
+{
+	return !(lhs < rhs);
+}
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+inline INPLACE_STRING_CONSTEXPR bool operator>=(const CharT* lhs,
+					   const basic_inplace_string<N, CharT, Traits, Policy>& rhs)
+{
+	return !(lhs < rhs);
+}
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy, typename T, typename X = typename std::enable_if<std::is_convertible<const T&, basic_string_view<CharT, Traits>>::value>::type>
+inline INPLACE_STRING_CONSTEXPR bool operator>=(const basic_inplace_string<N, CharT, Traits, Policy>& lhs,
+					   T rhs)
+{
+	return !(lhs < rhs);
+}
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy, typename T, typename X = typename std::enable_if<std::is_convertible<const T&, basic_string_view<CharT, Traits>>::value>::type>
+inline INPLACE_STRING_CONSTEXPR bool operator>=(T lhs,
+					   const basic_inplace_string<N, CharT, Traits, Policy>& rhs)
+{
+	return !(lhs < rhs);
+}
+
+namespace detail
+{
+
+// Set of characters for the find_*_of family: a 256-bit membership bitmap for the characters below 256, wider
+// characters fall back to a lookup in the set itself.
+template <typename CharT, typename Traits, bool Bitmap = is_bitwise_comparable<CharT, Traits>::value>
+class char_set
+{
+public:
+	char_set(const CharT* set, std::size_t count) noexcept :
+		_set(set),
+		_count(count)
+	{}
+
+	bool contains(CharT ch) const noexcept { return Traits::find(_set, _count, ch) != nullptr; }
+
+private:
+	const CharT* _set;
+	std::size_t _count;
+};
+
+template <typename CharT, typename Traits>
+class char_set<CharT, Traits, true>
+{
+	using unsigned_type = typename std::make_unsigned<CharT>::type;
+
+public:
+	char_set(const CharT* set, std::size_t count) noexcept :
+		_set(set),
+		_count(count)
+	{
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			const unsigned_type ch = static_cast<unsigned_type>(set[i]);
+			if (ch < 256)
+				_bitmap[ch / 64] |= std::uint64_t(1) << (ch % 64);
+			else
+				_has_wide_chars = true;
+		}
+	}
+
+	bool contains(CharT ch) const noexcept
+	{
+		const unsigned_type c = static_cast<unsigned_type>(ch);
+		if (c < 256)
+			return (_bitmap[c / 64] >> (c % 64)) & 1;
+
+		return _has_wide_chars && Traits::find(_set, _count, ch) != nullptr;
+	}
+
+private:
+	std::array<std::uint64_t, 4> _bitmap = {};
+	const CharT* _set;
+	std::size_t _count;
+	bool _has_wide_chars = false;
+};
+
+inline unsigned count_trailing_zeros(unsigned mask) noexcept
+{
+	assert(mask != 0);
+#if defined _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return static_cast<unsigned>(index);
+#else
+	return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+inline unsigned highest_bit(unsigned mask) noexcept
+{
+	assert(mask != 0);
+#if defined _MSC_VER
+	unsigned long index;
+	_BitScanReverse(&index, mask);
+	return static_cast<unsigned>(index);
+#else
+	return 31u - static_cast<unsigned>(__builtin_clz(mask));
+#endif
+}
+
+#if defined INPLACE_STRING_SSE2
+
+inline bool cpu_has_avx2() noexcept
+{
+#if defined __AVX2__
+	return true;
+#elif defined _MSC_VER
+	static const bool avx2 = []
+	{
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7)
+			return false;
+
+		// AVX2 also needs the OS to save the ymm registers
+		__cpuid(info, 1);
+		const bool osxsave_avx = (info[2] & (1 << 27)) && (info[2] & (1 << 28));
+		if (!osxsave_avx || (_xgetbv(0) & 6) != 6)
+			return false;
+
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+	}();
+	return avx2;
+#else
+	static const bool avx2 = __builtin_cpu_supports("avx2") != 0;
+	return avx2;
+#endif
+}
+
+inline bool cpu_has_ssse3() noexcept
+{
+#if defined __SSSE3__
+	return true;
+#elif defined _MSC_VER
+	static const bool ssse3 = []
+	{
+		int info[4];
+		__cpuid(info, 1);
+		return (info[2] & (1 << 9)) != 0;
+	}();
+	return ssse3;
+#else
+	static const bool ssse3 = __builtin_cpu_supports("ssse3") != 0;
+	return ssse3;
+#endif
+}
+
+
+template <typename CharT, typename Traits>
+struct is_simd_searchable :
+	public std::integral_constant<bool,
+		is_bitwise_comparable<CharT, Traits>::value
+		&& (sizeof(CharT) == 1 || sizeof(CharT) == 2 || sizeof(CharT) == 4)>
+{};
+
+template <std::size_t CharSize>
+struct sse2_ops;
+
+template <>
+struct sse2_ops<1>
+{
+	static constexpr unsigned lanes_mask = 0xFFFFu;
+	template <typename CharT> static __m128i broadcast(CharT ch) { return _mm_set1_epi8(static_cast<char>(ch)); }
+	static __m128i cmpeq(__m128i a, __m128i b) { return _mm_cmpeq_epi8(a, b); }
+};
+
+template <>
+struct sse2_ops<2>
+{
+	static constexpr unsigned lanes_mask = 0x5555u;
+	template <typename CharT> static __m128i broadcast(CharT ch) { return _mm_set1_epi16(static_cast<short>(ch)); }
+	static __m128i cmpeq(__m128i a, __m128i b) { return _mm_cmpeq_epi16(a, b); }
+};
+
+template <>
+struct sse2_ops<4>
+{
+	static constexpr unsigned lanes_mask = 0x1111u;
+	template <typename CharT> static __m128i broadcast(CharT ch) { return _mm_set1_epi32(static_cast<int>(ch)); }
+	static __m128i cmpeq(__m128i a, __m128i b) { return _mm_cmpeq_epi32(a, b); }
+};
+
+template <std::size_t CharSize>
+struct avx2_ops;
+
+template <>
+struct avx2_ops<1>
+{
+	static constexpr unsigned lanes_mask = 0xFFFFFFFFu;
+	template <typename CharT> INPLACE_STRING_TARGET_AVX2 static __m256i broadcast(CharT ch) { return _mm256_set1_epi8(static_cast<char>(ch)); }
+	INPLACE_STRING_TARGET_AVX2 static __m256i cmpeq(__m256i a, __m256i b) { return _mm256_cmpeq_epi8(a, b); }
+};
+
+template <>
+struct avx2_ops<2>
+{
+	static constexpr unsigned lanes_mask = 0x55555555u;
+	template <typename CharT> INPLACE_STRING_TARGET_AVX2 static __m256i broadcast(CharT ch) { return _mm256_set1_epi16(static_cast<short>(ch)); }
+	INPLACE_STRING_TARGET_AVX2 static __m256i cmpeq(__m256i a, __m256i b) { return _mm256_cmpeq_epi16(a, b); }
+};
+
+template <>
+struct avx2_ops<4>
+{
+	static constexpr unsigned lanes_mask = 0x11111111u;
+	template <typename CharT> INPLACE_STRING_TARGET_AVX2 static __m256i broadcast(CharT ch) { return _mm256_set1_epi32(static_cast<int>(ch)); }
+	INPLACE_STRING_TARGET_AVX2 static __m256i cmpeq(__m256i a, __m256i b) { return _mm256_cmpeq_epi32(a, b); }
+};
+
+// Candidates are the positions where both the first and the last character of the needle match, only those
+// are verified with memcmp. The caller guarantees at least one full vector of candidate positions, the tail
+// is handled with a last block overlapping the previous one.
+template <typename CharT>
+inline const CharT* search_candidates(const CharT* first1, const CharT* first2, std::size_t size2, unsigned mask)
+{
+	while (mask != 0)
+	{
+		const CharT* candidate = first1 + count_trailing_zeros(mask) / sizeof(CharT);
+		if (std::memcmp(candidate + 1, first2 + 1, (size2 - 2) * sizeof(CharT)) == 0)
+			return candidate;
+
+		mask &= mask - 1;
+	}
+
+	return nullptr;
+}
+
+// first and last are the first and last characters of the needle, broadcast to all the lanes.
+template <typename CharT>
+inline const CharT* search_substring_sse2(const CharT* first1, std::size_t size1, const CharT* first2, std::size_t size2, __m128i first, __m128i last)
+{
+	using ops = sse2_ops<sizeof(CharT)>;
+	constexpr std::size_t lanes = 16 / sizeof(CharT);
+
+	const std::size_t positions = size1 - size2 + 1;
+	assert(size2 >= 2 && positions >= lanes);
+
+	auto block_mask = [&](std::size_t i)
+	{
+		const __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first1 + i));
+		const __m128i block_last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first1 + i + size2 - 1));
+		const __m128i eq = _mm_and_si128(ops::cmpeq(first, block_first), ops::cmpeq(last, block_last));
+		return static_cast<unsigned>(_mm_movemask_epi8(eq)) & ops::lanes_mask;
+	};
+
+	std::size_t i = 0;
+	for (; i + lanes <= positions; i += lanes)
+		if (const CharT* res = search_candidates(first1 + i, first2, size2, block_mask(i)))
+			return res;
+
+	if (i == positions)
+		return nullptr;
+
+	const std::size_t tail = positions - lanes;
+	const unsigned seen = (1u << ((i - tail) * sizeof(CharT))) - 1;
+	return search_candidates(first1 + tail, first2, size2, block_mask(tail) & ~seen);
+}
+
+// Less than one vector of candidates: a plain loop beats one Traits::find call per candidate.
+template <typename CharT>
+inline const CharT* search_substring_short(const CharT* first1, std::size_t size1, const CharT* first2, std::size_t size2)
+{
+	assert(size2 >= 2 && size1 >= size2);
+
+	const CharT first_char = first2[0];
+	const CharT last_char = first2[size2 - 1];
+	const CharT* const end = first1 + (size1 - size2 + 1);
+
+	for (const CharT* candidate = first1; candidate != end; ++candidate)
+		if (*candidate == first_char && candidate[size2 - 1] == last_char
+				&& std::memcmp(candidate + 1, first2 + 1, (size2 - 2) * sizeof(CharT)) == 0)
+			return candidate;
+
+	return nullptr;
+}
+
+template <typename CharT>
+INPLACE_STRING_TARGET_AVX2
+inline const CharT* search_substring_avx2(const CharT* first1, std::size_t size1, const CharT* first2, std::size_t size2)
+{
+	using ops = avx2_ops<sizeof(CharT)>;
+	constexpr std::size_t lanes = 32 / sizeof(CharT);
+
+	const std::size_t positions = size1 - size2 + 1;
+	assert(size2 >= 2 && positions >= lanes);
+
+	const __m256i first = ops::broadcast(first2[0]);
+	const __m256i last = ops::broadcast(first2[size2 - 1]);
+
+	std::size_t i = 0;
+	for (; i + lanes <= positions; i += lanes)
+	{
+		const __m256i block_first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first1 + i));
+		const __m256i block_last = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first1 + i + size2 - 1));
+		const __m256i eq = _mm256_and_si256(ops::cmpeq(first, block_first), ops::cmpeq(last, block_last));
+		const unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(eq)) & ops::lanes_mask;
+
+		if (const CharT* res = search_candidates(first1 + i, first2, size2, mask))
+			return res;
+	}
+
+	if (i == positions)
+		return nullptr;
+
+	const std::size_t tail = positions - lanes;
+	const __m256i block_first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first1 + tail));
+	const __m256i block_last = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first1 + tail + size2 - 1));
+	const __m256i eq = _mm256_and_si256(ops::cmpeq(first, block_first), ops::cmpeq(last, block_last));
+	const unsigned seen = (1u << ((i - tail) * sizeof(CharT))) - 1;
+	const unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(eq)) & ops::lanes_mask & ~seen;
+
+	return search_candidates(first1 + tail, first2, size2, mask);
+}
+
+// Loads the block of 16 bytes starting at character index block, out of a storage of Count characters. Count
+// being a compile-time constant, the only partial block is the last one when the storage size isn't a multiple
+// of 16 bytes; it is copied to a local vector instead of reading past the object.
+template <std::size_t Count, typename CharT>
+inline __m128i load_block(const CharT* data, std::size_t block)
+{
+	constexpr std::size_t lanes = 16 / sizeof(CharT);
+
+	if (block + lanes <= Count)
+		return _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + block));
+
+	alignas(16) CharT tail[lanes] = {};
+	std::memcpy(tail, data + block, (Count - block) * sizeof(CharT));
+	return _mm_load_si128(reinterpret_cast<const __m128i*>(tail));
+}
+
+// Masks of the lanes of the block starting at character index block which are within [first, last).
+template <typename CharT>
+inline unsigned lanes_from(std::size_t block, std::size_t first)
+{
+	return first > block ? ~0u << ((first - block) * sizeof(CharT)) : ~0u;
+}
+
+template <typename CharT>
+inline unsigned lanes_until(std::size_t block, std::size_t last)
+{
+	return last - block < 16 / sizeof(CharT) ? (1u << ((last - block) * sizeof(CharT))) - 1 : ~0u;
+}
+
+// The whole storage of Count characters is scanned in 16-byte blocks, and the lanes outside of [pos, size)
+// are masked off.
+template <std::size_t Count, typename CharT>
+inline std::size_t find_char_sse2(const CharT* data, std::size_t pos, std::size_t size, CharT ch)
+{
+	using ops = sse2_ops<sizeof(CharT)>;
+	constexpr std::size_t lanes = 16 / sizeof(CharT);
+
+	assert(pos < size && size <= Count);
+	const __m128i needle = ops::broadcast(ch);
+
+	for (std::size_t block = pos - pos % lanes; block < size; block += lanes)
+	{
+		const __m128i chars = load_block<Count>(data, block);
+		const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(ops::cmpeq(chars, needle)))
+				& ops::lanes_mask & lanes_from<CharT>(block, pos) & lanes_until<CharT>(block, size);
+
+		if (mask != 0)
+			return block + count_trailing_zeros(mask) / sizeof(CharT);
+	}
+
+	return static_cast<std::size_t>(-1);
+}
+
+template <std::size_t Count, typename CharT>
+inline std::size_t find_last_char_sse2(const CharT* data, std::size_t last, CharT ch)
+{
+	using ops = sse2_ops<sizeof(CharT)>;
+	constexpr std::size_t lanes = 16 / sizeof(CharT);
+
+	assert(last < Count);
+	const __m128i needle = ops::broadcast(ch);
+
+	for (std::size_t block = last - last % lanes; ; block -= lanes)
+	{
+		const __m128i chars = load_block<Count>(data, block);
+		const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(ops::cmpeq(chars, needle)))
+				& ops::lanes_mask & lanes_until<CharT>(block, last + 1);
+
+		if (mask != 0)
+			return block + highest_bit(mask) / sizeof(CharT);
+
+		if (block == 0)
+			return static_cast<std::size_t>(-1);
+	}
+}
+
+// Nibble-shuffle set membership for single byte characters: the low nibble of each byte selects a row of the
+// 256-bit bitmap with pshufb, the high nibble selects the bit within the row.
+struct nibble_bitmap
+{
+	template <typename CharT>
+	nibble_bitmap(const CharT* set, std::size_t count) noexcept
+	{
+		static_assert(sizeof(CharT) == 1, "nibble lookups only apply to single byte characters");
+
+		alignas(16) unsigned char low[16] = {};
+		alignas(16) unsigned char high[16] = {};
+
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			const unsigned ch = static_cast<unsigned char>(set[i]);
+			unsigned char* rows = ch < 128 ? low : high;
+			rows[ch & 0xF] = static_cast<unsigned char>(rows[ch & 0xF] | (1u << ((ch >> 4) & 7)));
+		}
+
+		low_rows = _mm_load_si128(reinterpret_cast<const __m128i*>(low));
+		high_rows = _mm_load_si128(reinterpret_cast<const __m128i*>(high));
+	}
+
+	INPLACE_STRING_TARGET_SSSE3
+	unsigned match(__m128i chars) const noexcept
+	{
+		const __m128i nibble = _mm_set1_epi8(0x0F);
+		const __m128i bits = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+
+		const __m128i lo = _mm_and_si128(chars, nibble);
+		const __m128i hi = _mm_and_si128(_mm_srli_epi16(chars, 4), nibble);
+
+		const __m128i is_high = _mm_cmpgt_epi8(hi, _mm_set1_epi8(7));
+		const __m128i row = _mm_or_si128(_mm_and_si128(is_high, _mm_shuffle_epi8(high_rows, lo)),
+										 _mm_andnot_si128(is_high, _mm_shuffle_epi8(low_rows, lo)));
+		const __m128i bit = _mm_shuffle_epi8(bits, hi);
+
+		return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(row, bit), bit)));
+	}
+
+	__m128i low_rows;
+	__m128i high_rows;
+};
+
+template <std::size_t Count, typename CharT>
+INPLACE_STRING_TARGET_SSSE3
+inline std::size_t find_first_of_ssse3(const CharT* data, std::size_t pos, std::size_t size, const nibble_bitmap& set, bool not_of)
+{
+	static_assert(sizeof(CharT) == 1, "nibble lookups only apply to single byte characters");
+	assert(pos < size && size <= Count);
+
+	const unsigned flip = not_of ? 0xFFFFu : 0u;
+
+	for (std::size_t block = pos - pos % 16; block < size; block += 16)
+	{
+		const unsigned mask = (set.match(load_block<Count>(data, block)) ^ flip)
+				& lanes_from<CharT>(block, pos) & lanes_until<CharT>(block, size);
+
+		if (mask != 0)
+			return block + count_trailing_zeros(mask);
+	}
+
+	return static_cast<std::size_t>(-1);
+}
+
+template <std::size_t Count, typename CharT>
+INPLACE_STRING_TARGET_SSSE3
+inline std::size_t find_last_of_ssse3(const CharT* data, std::size_t last, const nibble_bitmap& set, bool not_of)
+{
+	static_assert(sizeof(CharT) == 1, "nibble lookups only apply to single byte characters");
+	assert(last < Count);
+
+	const unsigned flip = not_of ? 0xFFFFu : 0u;
+
+	for (std::size_t block = last - last % 16; ; block -= 16)
+	{
+		const unsigned mask = (set.match(load_block<Count>(data, block)) ^ flip) & lanes_until<CharT>(block, last + 1);
+
+		if (mask != 0)
+			return block + highest_bit(mask);
+
+		if (block == 0)
+			return static_cast<std::size_t>(-1);
+	}
+}
+
+#endif
+
+template <std::size_t Count, typename CharT, typename Traits>
+inline std::size_t find_char(const CharT* data, std::size_t pos, std::size_t size, CharT ch, std::false_type)
+{
+	const CharT* res = Traits::find(data + pos, size - pos, ch);
+	return res ? static_cast<std::size_t>(res - data) : static_cast<std::size_t>(-1);
+}
+
+template <std::size_t Count, typename CharT, typename Traits>
+inline std::size_t find_char(const CharT* data, std::size_t pos, std::size_t size, CharT ch, std::true_type)
+{
+#if defined INPLACE_STRING_SSE2
+	return find_char_sse2<Count>(data, pos, size, ch);
+#else
+	return find_char<Count, CharT, Traits>(data, pos, size, ch, std::false_type{});
+#endif
+}
+
+template <std::size_t Count, typename CharT, typename Traits>
+inline std::size_t find_char(const CharT* data, std::size_t pos, std::size_t size, CharT ch)
+{
+#if defined INPLACE_STRING_SSE2
+	using simd = typename is_simd_searchable<CharT, Traits>::type;
+#else
+	using simd = std::false_type;
+#endif
+
+	return find_char<Count, CharT, Traits>(data, pos, size, ch, simd{});
+}
+
+template <std::size_t Count, typename CharT, typename Traits>
+inline std::size_t find_last_char(const CharT* data, std::size_t last, CharT ch, std::false_type)
+{
+	for (std::size_t i = last; ; --i)
+	{
+		if (Traits::eq(data[i], ch))
+			return i;
+
+		if (i == 0)
+			return static_cast<std::size_t>(-1);
+	}
+}
+
+template <std::size_t Count, typename CharT, typename Traits>
+inline std::size_t find_last_char(const CharT* data, std::size_t last, CharT ch, std::true_type)
+{
+#if defined INPLACE_STRING_SSE2
+	return find_last_char_sse2<Count>(data, last, ch);
+#else
+	return find_last_char<Count, CharT, Traits>(data, last, ch, std::false_type{});
+#endif
+}
+
+template <std::size_t Count, typename CharT, typename Traits>
+inline std::size_t find_last_char(const CharT* data, std::size_t last, CharT ch)
+{
+#if defined INPLACE_STRING_SSE2
+	using simd = typename is_simd_searchable<CharT, Traits>::type;
+#else
+	using simd = std::false_type;
+#endif
+
+	return find_last_char<Count, CharT, Traits>(data, last, ch, simd{});
+}
+
+template <std::size_t Count, typename CharT, typename Traits>
+inline std::size_t find_first_of(const CharT* data, std::size_t pos, std::size_t size, const CharT* set, std::size_t count, bool not_of, std::false_type)
+{
+	const char_set<CharT, Traits> chars(set, count);
+
+	for (std::size_t i = pos; i < size; ++i)
+		if (chars.contains(data[i]) != not_of)
+			return i;
+
+	return static_cast<std::size_t>(-1);
+}
+
+template <std::size_t Count, typename CharT, typename Traits>
+inline std::size_t find_first_of(const CharT* data, std::size_t pos, std::size_t size, const CharT* set, std::size_t count, bool not_of, std::true_type)
+{
+#if defined INPLACE_STRING_SSE2
+	if (size - pos >= 16 && cpu_has_ssse3())
+		return find_first_of_ssse3<Count>(data, pos, size, nibble_bitmap(set, count), not_of);
+#endif
+
+	return find_first_of<Count, CharT, Traits>(data, pos, size, set, count, not_of, std::false_type{});
+}
+
+template <std::size_t Count, typename CharT, typename Traits>
+inline std::size_t find_first_of(const CharT* data, std::size_t pos, std::size_t size, const CharT* set, std::size_t count, bool not_of)
+{
+	assert(pos < size && size <= Count);
+	using nibble_lookup = std::integral_constant<bool, is_bitwise_comparable<CharT, Traits>::value && sizeof(CharT) == 1>;
+
+	return find_first_of<Count, CharT, Traits>(data, pos, size, set, count, not_of, nibble_lookup{});
+}
+
+template <std::size_t Count, typename CharT, typename Traits>
+inline std::size_t find_last_of(const CharT* data, std::size_t last, const CharT* set, std::size_t count, bool not_of, std::false_type)
+{
+	const char_set<CharT, Traits> chars(set, count);
+
+	for (std::size_t i = last; ; --i)
+	{
+		if (chars.contains(data[i]) != not_of)
+			return i;
+
+		if (i == 0)
+			return static_cast<std::size_t>(-1);
+	}
+}
+
+template <std::size_t Count, typename CharT, typename Traits>
+inline std::size_t find_last_of(const CharT* data, std::size_t last, const CharT* set, std::size_t count, bool not_of, std::true_type)
+{
+#if defined INPLACE_STRING_SSE2
+	if (last >= 16 && cpu_has_ssse3())
+		return find_last_of_ssse3<Count>(data, last, nibble_bitmap(set, count), not_of);
+#endif
+
+	return find_last_of<Count, CharT, Traits>(data, last, set, count, not_of, std::false_type{});
+}
+
+template <std::size_t Count, typename CharT, typename Traits>
+inline std::size_t find_last_of(const CharT* data, std::size_t last, const CharT* set, std::size_t count, bool not_of)
+{
+	assert(last < Count);
+	using nibble_lookup = std::integral_constant<bool, is_bitwise_comparable<CharT, Traits>::value && sizeof(CharT) == 1>;
+
+	return find_last_of<Count, CharT, Traits>(data, last, set, count, not_of, nibble_lookup{});
+}
+
+template <typename CharT, typename Traits>
+inline const CharT* search_substring_scalar(const CharT* first1, const CharT* last1, const CharT* first2, const CharT* last2)
+{
+	const std::size_t size2 = static_cast<std::size_t>(last2 - first2);
+	const CharT last_char = *(last2 - 1);
+
+	while (true)
+	{
+		const std::size_t size1 = static_cast<std::size_t>(last1 - first1);
+		if (size1 < size2)
+			return nullptr;
+
+		first1 = Traits::find(first1, size1 - size2 + 1, *first2);
+		if (first1 == nullptr)
+			return nullptr;
+
+		// checking the last character first rejects most candidates when the first one repeats
+		if (Traits::eq(first1[size2 - 1], last_char) && Traits::compare(first1, first2, size2) == 0)
+			return first1;
+
+		++first1;
+	}
+
+	return nullptr;
+}
+
+template <typename CharT, typename Traits>
+inline const CharT* search_substring(const CharT* first1, const CharT* last1, const CharT* first2, const CharT* last2, std::false_type)
+{
+	return search_substring_scalar<CharT, Traits>(first1, last1, first2, last2);
+}
+
+template <typename CharT, typename Traits>
+inline const CharT* search_substring(const CharT* first1, const CharT* last1, const CharT* first2, const CharT* last2, std::true_type)
+{
+#if defined INPLACE_STRING_SSE2
+	const std::size_t size1 = static_cast<std::size_t>(last1 - first1);
+	const std::size_t size2 = static_cast<std::size_t>(last2 - first2);
+
+	if (size2 >= 2 && size1 >= size2)
+	{
+		const std::size_t positions = size1 - size2 + 1;
+
+		if (positions >= 32 / sizeof(CharT) && cpu_has_avx2())
+			return search_substring_avx2(first1, size1, first2, size2);
+
+		if (positions >= 16 / sizeof(CharT))
+		{
+			using ops = sse2_ops<sizeof(CharT)>;
+			return search_substring_sse2(first1, size1, first2, size2, ops::broadcast(first2[0]), ops::broadcast(first2[size2 - 1]));
+		}
+
+		return search_substring_short(first1, size1, first2, size2);
+	}
+#endif
+
+	return search_substring_scalar<CharT, Traits>(first1, last1, first2, last2);
+}
+
+template <typename CharT, typename Traits>
+inline const CharT* search_substring(const CharT* first1, const CharT* last1, const CharT* first2, const CharT* last2)
+{
+	assert(last1 >= first1);
+	assert(last2 > first2);
+
+#if defined INPLACE_STRING_SSE2
+	using simd = typename is_simd_searchable<CharT, Traits>::type;
+#else
+	using simd = std::false_type;
+#endif
+
+	return search_substring<CharT, Traits>(first1, last1, first2, last2, simd{});
+}
+
+}
+
+template <std::size_t N> using inplace_string = basic_inplace_string<N, char>;
+template <std::size_t N> using inplace_wstring = basic_inplace_string<N, wchar_t>;
+template <std::size_t N> using inplace_u16string = basic_inplace_string<N, char16_t>;
+template <std::size_t N> using inplace_u32string = basic_inplace_string<N, char32_t>;
+
+template <std::size_t N, typename CharT = char>
+using cached_hash_inplace_string = basic_inplace_string<N, CharT, std::char_traits<CharT>, inplace_string_cached_hash_policy>;
+
+template <std::size_t N, typename CharT = char>
+using zero_padded_inplace_string = basic_inplace_string<N, CharT, std::char_traits<CharT>, inplace_string_zero_padded_policy>;
+
+template <std::size_t N, typename CharT = char>
+using truncating_inplace_string = basic_inplace_string<N, CharT, std::char_traits<CharT>, inplace_string_truncating_policy>;
+
+template <std::size_t N, typename CharT = char>
+using saturating_inplace_string = basic_inplace_string<N, CharT, std::char_traits<CharT>, inplace_string_saturating_policy>;
+
+template <std::size_t N, typename CharT = char>
+using unterminated_inplace_string = basic_inplace_string<N, CharT, std::char_traits<CharT>, inplace_string_unterminated_policy>;
+
+namespace detail
+{
+
+// Iterators over characters stored contiguously: pointers, the iterators of std::basic_string and std::vector,
+// and from C++20 on any std::contiguous_iterator.
+template <typename It, typename CharT, typename Traits>
+struct is_contiguous_iterator :
+	public std::integral_constant<bool,
+		std::is_same<It, CharT*>::value
+		|| std::is_same<It, const CharT*>::value
+		|| std::is_same<It, typename std::basic_string<CharT, Traits>::iterator>::value
+		|| std::is_same<It, typename std::basic_string<CharT, Traits>::const_iterator>::value
+		|| std::is_same<It, typename std::vector<CharT>::iterator>::value
+		|| std::is_same<It, typename std::vector<CharT>::const_iterator>::value
+#if defined __cpp_lib_concepts
+		|| (std::contiguous_iterator<It> && std::is_same<typename std::iterator_traits<It>::value_type, CharT>::value)
+#endif
+	>
+{};
+
+}
+
+// Searches one needle in many strings: the needle is preprocessed once, at construction. With SSE2, the first
+// and last characters of the needle are broadcast once and each search runs the first/last character filter
+// without any dispatch. Otherwise needles of at least 8 characters use Boyer-Moore-Horspool, the skip table
+// being indexed by the low byte of the characters.
+// Can also be used with std::search, on contiguous ranges.
+template <typename CharT, typename Traits = std::char_traits<CharT>>
+class basic_inplace_string_searcher
+{
+public:
+	using traits_type = Traits;
+	using value_type = CharT;
+	using size_type = std::size_t;
+
+	static constexpr const size_type npos = static_cast<size_type>(-1);
+
+	explicit basic_inplace_string_searcher(basic_string_view<CharT, Traits> needle);
+
+	template <std::size_t N, typename Policy>
+	size_type find(const basic_inplace_string<N, CharT, Traits, Policy>& str, size_type pos = 0) const noexcept;
+
+	template <std::size_t N, typename Policy>
+	bool contains(const basic_inplace_string<N, CharT, Traits, Policy>& str) const noexcept { return find(str) != npos; }
+
+	template <typename RandomIt>
+	std::pair<RandomIt, RandomIt> operator()(RandomIt first, RandomIt last) const;
+
+	size_type size() const noexcept { return _needle.size(); }
+
+private:
+#if defined INPLACE_STRING_SSE2
+	using simd = typename detail::is_simd_searchable<CharT, Traits>::type;
+#else
+	using simd = std::false_type;
+#endif
+
+	static constexpr size_type min_skip_table_size = 8;
+
+	static std::size_t skip_index(CharT ch) noexcept
+	{
+		return static_cast<std::size_t>(static_cast<typename std::make_unsigned<CharT>::type>(ch) & 0xFF);
+	}
+
+	const CharT* search(const CharT* first, const CharT* last) const noexcept;
+	const CharT* search(const CharT* first, const CharT* last, std::true_type) const noexcept;
+	const CharT* search(const CharT* first, const CharT* last, std::false_type) const noexcept;
+
+	std::basic_string<CharT, Traits> _needle;
+#if defined INPLACE_STRING_SSE2
+	__m128i _first_chars;
+	__m128i _last_chars;
+#endif
+	std::array<size_type, 256> _skip;
+	bool _use_skip_table;
+};
+
+template <typename CharT, typename Traits>
+basic_inplace_string_searcher<CharT, Traits>::basic_inplace_string_searcher(basic_string_view<CharT, Traits> needle) :
+	_needle(needle.data(), needle.size()),
+	_use_skip_table(!simd::value && detail::is_bitwise_comparable<CharT, Traits>::value && needle.size() >= min_skip_table_size)
+{
+#if defined INPLACE_STRING_SSE2
+	if (simd::value && !_needle.empty())
+	{
+		using ops = detail::sse2_ops<simd::value ? sizeof(CharT) : 1>;
+		_first_chars = ops::broadcast(_needle.front());
+		_last_chars = ops::broadcast(_needle.back());
+	}
+#endif
+
+	if (!_use_skip_table)
+		return;
+
+	const size_type sz = _needle.size();
+	_skip.fill(sz);
+
+	for (size_type i = 0; i + 1 < sz; ++i)
+		_skip[skip_index(_needle[i])] = sz - 1 - i;
+}
+
+template <typename CharT, typename Traits>
+const CharT* basic_inplace_string_searcher<CharT, Traits>::search(const CharT* first, const CharT* last) const noexcept
+{
+	const size_type sz = _needle.size();
+	assert(sz != 0);
+
+	if (static_cast<size_type>(last - first) < sz)
+		return nullptr;
+
+	if (sz == 1)
+		return traits_type::find(first, static_cast<size_type>(last - first), _needle[0]);
+
+	return search(first, last, simd{});
+}
+
+template <typename CharT, typename Traits>
+const CharT* basic_inplace_string_searcher<CharT, Traits>::search(const CharT* first, const CharT* last, std::true_type) const noexcept
+{
+#if defined INPLACE_STRING_SSE2
+	const size_type size1 = static_cast<size_type>(last - first);
+	if (size1 - _needle.size() + 1 >= 16 / sizeof(CharT))
+		return detail::search_substring_sse2(first, size1, _needle.data(), _needle.size(), _first_chars, _last_chars);
+
+	return detail::search_substring_short(first, size1, _needle.data(), _needle.size());
+#else
+	return search(first, last, std::false_type{});
+#endif
+}
+
+template <typename CharT, typename Traits>
+const CharT* basic_inplace_string_searcher<CharT, Traits>::search(const CharT* first, const CharT* last, std::false_type) const noexcept
+{
+	const size_type sz = _needle.size();
+
+	if (!_use_skip_table)
+		return detail::search_substring<CharT, Traits>(first, last, _needle.data(), _needle.data() + sz);
+
+	const CharT last_char = _needle[sz - 1];
+	for (const CharT* candidate = first; candidate <= last - sz; candidate += _skip[skip_index(candidate[sz - 1])])
+	{
+		if (candidate[sz - 1] == last_char && std::memcmp(candidate, _needle.data(), (sz - 1) * sizeof(CharT)) == 0)
+			return candidate;
+	}
+
+	return nullptr;
+}
+
+template <typename CharT, typename Traits>
+template <std::size_t N, typename Policy>
+typename basic_inplace_string_searcher<CharT, Traits>::size_type
+basic_inplace_string_searcher<CharT, Traits>::find(const basic_inplace_string<N, CharT, Traits, Policy>& str, size_type pos) const noexcept
+{
+	if (pos > str.size())
+		return npos;
+
+	if (_needle.empty())
+		return pos;
+
+	const CharT* res = search(str.data() + pos, str.data() + str.size());
+	return res ? static_cast<size_type>(res - str.data()) : npos;
+}
+
+template <typename CharT, typename Traits>
+template <typename RandomIt>
+std::pair<RandomIt, RandomIt> basic_inplace_string_searcher<CharT, Traits>::operator()(RandomIt first, RandomIt last) const
+{
+	static_assert(detail::is_contiguous_iterator<RandomIt, CharT, Traits>::value,
+				  "basic_inplace_string_searcher: the range must be contiguous");
+
+	if (_needle.empty())
+		return {first, first};
+
+	if (first == last)
+		return {last, last};
+
+	const CharT* data = std::addressof(*first);
+	const CharT* res = search(data, data + (last - first));
+	if (res == nullptr)
+		return {last, last};
+
+	const RandomIt found = first + (res - data);
+	return {found, found + static_cast<typename std::iterator_traits<RandomIt>::difference_type>(_needle.size())};
+}
+
+using inplace_string_searcher = basic_inplace_string_searcher<char>;
+using inplace_wstring_searcher = basic_inplace_string_searcher<wchar_t>;
+using inplace_u16string_searcher = basic_inplace_string_searcher<char16_t>;
+using inplace_u32string_searcher = basic_inplace_string_searcher<char32_t>;
+
+#if INPLACE_STRING_HAS_TO_CHARS
+namespace detail
+{
+
+constexpr std::size_t decimal_digits(unsigned long long value) noexcept
+{
+	return value < 10 ? 1 : 1 + decimal_digits(value / 10);
+}
+
+// Longest output of std::to_chars(first, last, value) for any value of T: sign and digits for integers, sign,
+// max_digits10 digits, point and exponent for the shortest round-trip form of floating-point types.
+template <typename T, typename Enable = void>
+struct max_chars;
+
+template <typename T>
+struct max_chars<T, typename std::enable_if<std::is_integral<T>::value>::type> :
+	std::integral_constant<std::size_t, std::numeric_limits<T>::digits10 + 1 + std::is_signed<T>::value> {};
+
+template <typename T>
+struct max_chars<T, typename std::enable_if<std::is_floating_point<T>::value>::type> :
+	std::integral_constant<std::size_t, std::numeric_limits<T>::max_digits10 + 4
+		+ decimal_digits(std::max(std::numeric_limits<T>::max_exponent10,
+								  std::numeric_limits<T>::max_digits10 - std::numeric_limits<T>::min_exponent10))> {};
+
+// The types std::to_chars formats: integers and char, but no other character type, and floating-point types
+// when the library implements them.
+template <typename T>
+struct is_to_chars_number :
+	std::integral_constant<bool, (std::is_integral<T>::value && !std::is_same<T, bool>::value
+								  && !std::is_same<T, wchar_t>::value && !std::is_same<T, char16_t>::value
+								  && !std::is_same<T, char32_t>::value
+#if defined __cpp_char8_t
+								  && !std::is_same<T, char8_t>::value
+#endif
+								  )
+#if defined __cpp_lib_to_chars
+								 || std::is_floating_point<T>::value
+#endif
+	> {};
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy, typename T>
+basic_inplace_string<N, CharT, Traits, Policy>& append_number(basic_inplace_string<N, CharT, Traits, Policy>& str, T value, std::false_type)
+{
+	char buf[max_chars<T>::value];
+	const char* const last = std::to_chars(buf, buf + sizeof(buf), value).ptr;
+	return str.append(static_cast<const char*>(buf), last);
+}
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy, typename T>
+basic_inplace_string<N, CharT, Traits, Policy>& append_number(basic_inplace_string<N, CharT, Traits, Policy>& str, T value, std::true_type)
+{
+	const auto span = str.prepare_append();
+	const std::to_chars_result res = std::to_chars(span.data, span.data + span.size, value);
+	if (res.ec != std::errc{})
+		return append_number(str, value, std::false_type{});
+
+	str.commit_append(static_cast<std::size_t>(res.ptr - span.data));
+	return str;
+}
+
+// Default capacity of to_inplace_string: max_chars rounded up so that the string fills whole 8-byte words. Odd
+// sizes are copied with overlapping loads, which stall on the digits that were just stored byte by byte.
+template <typename T>
+struct to_inplace_string_capacity : std::integral_constant<std::size_t, (max_chars<T>::value + 8) / 8 * 8 - 1> {};
+
+}
+
+// Appends value as std::to_chars formats it: integers in base 10, floating-point values in their shortest
+// round-trip form. Narrow strings get the characters in place; when they do not fit, or for wider character
+// types, they go through a local buffer and then the overflow policy.
+template <std::size_t N, typename CharT, typename Traits, typename Policy, typename T,
+		  typename X = typename std::enable_if<detail::is_to_chars_number<T>::value>::type>
+basic_inplace_string<N, CharT, Traits, Policy>& append_number(basic_inplace_string<N, CharT, Traits, Policy>& str, T value)
+{
+	return detail::append_number(str, value, std::is_same<CharT, char>{});
+}
+
+// value in a string of capacity N, which must hold any value of T: there is no capacity check left at run time.
+// Without N, the capacity is the longest representation of a T rounded up to 8-byte words, so that
+// "ORD-" + to_inplace_string(id) has a capacity known at compile time too.
+template <std::size_t N, typename CharT = char, typename T,
+		  typename X = typename std::enable_if<detail::is_to_chars_number<T>::value>::type>
+basic_inplace_string<N, CharT> to_inplace_string(T value)
+{
+	static_assert(N >= detail::max_chars<T>::value, "to_inplace_string: capacity too small for this type");
+
+	basic_inplace_string<N, CharT> str;
+	append_number(str, value);
+	return str;
+}
+
+template <typename T, typename X = typename std::enable_if<detail::is_to_chars_number<T>::value>::type>
+basic_inplace_string<detail::to_inplace_string_capacity<T>::value, char> to_inplace_string(T value)
+{
+	return to_inplace_string<detail::to_inplace_string_capacity<T>::value>(value);
+}
+#endif
+
+namespace detail
+{
+
+// Eight ASCII digits, loaded little-endian, to their value: three multiplications instead of eight dependent
+// ones (Lemire's SWAR conversion).
+inline std::uint32_t parse_eight_digits(std::uint64_t word) noexcept
+{
+	word -= 0x3030303030303030ull;
+	word = word * 10 + (word >> 8);
+	return static_cast<std::uint32_t>((((word & 0x000000ff000000ffull) * 0x000f424000000064ull)
+									   + (((word >> 16) & 0x000000ff000000ffull) * 0x0000271000000001ull)) >> 32);
+}
+
+inline bool is_eight_digits(std::uint64_t word) noexcept
+{
+	return ((word & 0xf0f0f0f0f0f0f0f0ull) | (((word + 0x0606060606060606ull) & 0xf0f0f0f0f0f0f0f0ull) >> 4))
+		   == 0x3333333333333333ull;
+}
+
+template <typename CharT>
+struct is_swar_parsable :
+	std::integral_constant<bool, std::is_same<CharT, char>::value
+#if defined __BYTE_ORDER__ && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+								 && false
+#endif
+	> {};
+
+constexpr std::uint64_t max_u64 = std::numeric_limits<std::uint64_t>::max();
+
+// The overflow checks compare with constants: there is no division on the way.
+template <typename CharT>
+std::errc parse_digits(const CharT* first, const CharT* last, std::uint64_t& value, std::false_type) noexcept
+{
+	for (; first != last; ++first)
+	{
+		const std::uint64_t digit = static_cast<std::uint64_t>(*first) - static_cast<std::uint64_t>('0');
+		if (digit > 9)
+			return std::errc::invalid_argument;
+		if (value >= max_u64 / 10 && (value > max_u64 / 10 || digit > max_u64 % 10))
+			return std::errc::result_out_of_range;
+		value = value * 10 + digit;
+	}
+
+	return std::errc{};
+}
+
+inline std::errc parse_digits(const char* first, const char* last, std::uint64_t& value, std::true_type) noexcept
+{
+	for (; last - first >= 8; first += 8)
+	{
+		std::uint64_t word;
+		std::memcpy(&word, first, 8);
+		if (!is_eight_digits(word))
+			return std::errc::invalid_argument;
+
+		const std::uint32_t chunk = parse_eight_digits(word);
+		if (value >= max_u64 / 100000000 && (value > max_u64 / 100000000 || chunk > max_u64 % 100000000))
+			return std::errc::result_out_of_range;
+		value = value * 100000000 + chunk;
+	}
+
+	return parse_digits(first, last, value, std::false_type{});
+}
+
+// Accumulates the digits of [first, last) into value, eight at a time for narrow strings: invalid_argument
+// when the range is empty or has anything else than digits, result_out_of_range above 2^64 - 1.
+template <typename CharT>
+std::errc parse_digits(const CharT* first, const CharT* last, std::uint64_t& value) noexcept
+{
+	if (first == last)
+		return std::errc::invalid_argument;
+
+	return parse_digits(first, last, value, is_swar_parsable<CharT>{});
+}
+
+template <typename T>
+T negate_magnitude(std::uint64_t magnitude, std::true_type) noexcept
+{
+	return static_cast<T>(-static_cast<T>(magnitude - 1) - 1);
+}
+
+template <typename T>
+T negate_magnitude(std::uint64_t, std::false_type) noexcept
+{
+	return T(0);
+}
+
+// The parsed magnitude into a T: down to min() when negative
+template <typename T>
+std::errc narrow_parsed(std::uint64_t magnitude, bool negative, T& value) noexcept
+{
+	if (negative && magnitude != 0)
+	{
+		if (magnitude - 1 > static_cast<std::uint64_t>(std::numeric_limits<T>::max()))
+			return std::errc::result_out_of_range;
+		value = negate_magnitude<T>(magnitude, std::is_signed<T>{});
+		return std::errc{};
+	}
+
+	if (magnitude > static_cast<std::uint64_t>(std::numeric_limits<T>::max()))
+		return std::errc::result_out_of_range;
+	value = static_cast<T>(magnitude);
+	return std::errc{};
+}
+
+}
+
+// Numeric fields parsed in place, the whole string being the number: on success the result is stored in value
+// and the error code is empty; otherwise value is left untouched and the error code is invalid_argument for
+// an empty string or any character out of the syntax, result_out_of_range for a number T cannot represent.
+// Narrow strings convert eight digits at a time.
+
+// Digits only.
+template <typename T, std::size_t N, typename CharT, typename Traits, typename Policy>
+std::errc parse_uint(const basic_inplace_string<N, CharT, Traits, Policy>& str, T& value) noexcept
+{
+	static_assert(std::is_unsigned<T>::value && !std::is_same<T, bool>::value, "parse_uint: T must be an unsigned integer type");
+
+	std::uint64_t magnitude = 0;
+	const std::errc ec = detail::parse_digits(str.data(), str.data() + str.size(), magnitude);
+	return ec != std::errc{} ? ec : detail::narrow_parsed(magnitude, false, value);
+}
+
+// An optional '-', then digits.
+template <typename T, std::size_t N, typename CharT, typename Traits, typename Policy>
+std::errc parse_int(const basic_inplace_string<N, CharT, Traits, Policy>& str, T& value) noexcept
+{
+	static_assert(std::is_signed<T>::value && std::is_integral<T>::value, "parse_int: T must be a signed integer type");
+
+	const CharT* first = str.data();
+	const bool negative = str.size() != 0 && Traits::eq(*first, CharT('-'));
+	std::uint64_t magnitude = 0;
+	const std::errc ec = detail::parse_digits(first + negative, str.data() + str.size(), magnitude);
+	return ec != std::errc{} ? ec : detail::narrow_parsed(magnitude, negative, value);
+}
+
+// Fixed-point: an optional '-' when T is signed, digits, then optionally '.' and 1 to decimals digits. value is
+// the number times 10^decimals, so that "187.25" with 4 decimals gives 1872500. decimals is at most 19.
+template <typename T, std::size_t N, typename CharT, typename Traits, typename Policy>
+std::errc parse_decimal(const basic_inplace_string<N, CharT, Traits, Policy>& str, T& value, unsigned decimals) noexcept
+{
+	static_assert(std::is_integral<T>::value && !std::is_same<T, bool>::value, "parse_decimal: T must be an integer type");
+	assert(decimals <= 19);
+
+	const CharT* first = str.data();
+	const CharT* const last = first + str.size();
+	const bool negative = std::is_signed<T>::value && first != last && Traits::eq(*first, CharT('-'));
+	first += negative;
+
+	const CharT* point = Traits::find(first, static_cast<std::size_t>(last - first), CharT('.'));
+	if (point == nullptr)
+		point = last;
+	else if (static_cast<std::size_t>(last - point - 1) > decimals)
+		return std::errc::invalid_argument;
+
+	std::uint64_t magnitude = 0;
+	std::errc ec = detail::parse_digits(first, point, magnitude);
+	if (ec == std::errc{} && point != last)
+		ec = detail::parse_digits(point + 1, last, magnitude);
+	if (ec != std::errc{})
+		return ec;
+
+	for (std::size_t scale = point != last ? static_cast<std::size_t>(last - point - 1) : 0; scale != decimals; ++scale)
+	{
+		if (magnitude > std::numeric_limits<std::uint64_t>::max() / 10)
+			return std::errc::result_out_of_range;
+		magnitude *= 10;
+	}
+
+	return detail::narrow_parsed(magnitude, negative, value);
+}
+
+namespace detail
+{
+
+template <typename T>
+struct is_inplace_string : std::false_type {};
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+struct is_inplace_string<basic_inplace_string<N, CharT, Traits, Policy>> : std::true_type {};
+
+// 64x64 -> 128 bits multiplication, folded back to 64 bits: the mixing primitive of wyhash.
+inline std::uint64_t fold_multiply(std::uint64_t a, std::uint64_t b) noexcept
+{
+#if defined __SIZEOF_INT128__
+	__extension__ using uint128 = unsigned __int128;
+	const uint128 r = static_cast<uint128>(a) * b;
+	return static_cast<std::uint64_t>(r) ^ static_cast<std::uint64_t>(r >> 64);
+#elif defined _MSC_VER && defined _M_X64
+	std::uint64_t high;
+	const std::uint64_t low = _umul128(a, b, &high);
+	return low ^ high;
+#else
+	const std::uint64_t a_low = a & 0xffffffff, a_high = a >> 32;
+	const std::uint64_t b_low = b & 0xffffffff, b_high = b >> 32;
+	const std::uint64_t ll = a_low * b_low, lh = a_low * b_high, hl = a_high * b_low, hh = a_high * b_high;
+	const std::uint64_t mid = (ll >> 32) + (lh & 0xffffffff) + (hl & 0xffffffff);
+	const std::uint64_t low = (ll & 0xffffffff) | (mid << 32);
+	const std::uint64_t high = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+	return low ^ high;
+#endif
+}
+
+// Loads the 8 bytes at offset of a block of Bytes bytes: the load never reads past the block, the bytes
+// beyond len are cleared.
+template <std::size_t Bytes>
+inline std::uint64_t load_hash_word(const unsigned char* block, std::size_t offset, std::size_t len) noexcept
+{
+	if (offset >= len)
+		return 0;
+
+	std::uint64_t word = 0;
+	if (offset + 8 <= Bytes)
+		std::memcpy(&word, block + offset, 8);
+	else
+		std::memcpy(&word, block + offset, Bytes % 8);
+
+	const std::size_t valid = len - offset;
+	if (valid < 8)
+	{
+#if defined __BYTE_ORDER__ && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+		word &= ~(~std::uint64_t{0} >> (valid * 8));
+#else
+		word &= ~(~std::uint64_t{0} << (valid * 8));
+#endif
+	}
+
+	return word;
+}
+
+// Hash of the first len bytes of a block of Bytes bytes, wyhash-style: 16 bytes are mixed per multiplication.
+// As the block size is known at compile time, the loads are plain 8-byte loads at fixed offsets, masked past
+// len, instead of the tail handling of a variable-length hash. With len == Bytes there is no branch left.
+template <std::size_t Bytes>
+inline std::uint64_t hash_block(const void* data, std::size_t len) noexcept
+{
+	constexpr std::uint64_t secret0 = 0xa0761d6478bd642full;
+	constexpr std::uint64_t secret1 = 0xe7037ed1a0b428dbull;
+	constexpr std::uint64_t secret2 = 0x8ebc6af09c88c6e3ull;
+
+	const unsigned char* block = static_cast<const unsigned char*>(data);
+	std::uint64_t h = secret0 ^ len;
+
+	for (std::size_t offset = 0; offset < len; offset += 16)
+		h = fold_multiply(load_hash_word<Bytes>(block, offset, len) ^ secret1,
+						  load_hash_word<Bytes>(block, offset + 8, len) ^ h);
+
+	return fold_multiply(h ^ secret2, len ^ secret1);
+}
+
+}
+
+#if INPLACE_STRING_HAS_TO_CHARS
+namespace detail
+{
+
+template <typename T>
+struct type_identity
+{
+	using type = T;
+};
+
+constexpr std::size_t add_max_chars(std::size_t lhs, std::size_t rhs) noexcept
+{
+	return rhs > std::size_t(-1) - lhs ? std::size_t(-1) : lhs + rhs;
+}
+
+// Upper bound of the characters an argument formats to: npos for the string types that do not bound their
+// length. char is formatted as a character, whatever the character type of the string.
+template <typename CharT, typename T, typename Enable = void>
+struct format_max_chars : std::integral_constant<std::size_t, std::size_t(-1)> {};
+
+template <typename CharT, typename T>
+struct format_max_chars<CharT, T, typename std::enable_if<std::is_same<T, CharT>::value || std::is_same<T, char>::value>::type> :
+	std::integral_constant<std::size_t, 1> {};
+
+template <typename CharT, typename T>
+struct format_max_chars<CharT, T, typename std::enable_if<is_to_chars_number<T>::value && !std::is_same<T, char>::value>::type> :
+	max_chars<T> {};
+
+template <typename CharT, std::size_t N, typename Traits, typename Policy>
+struct format_max_chars<CharT, basic_inplace_string<N, CharT, Traits, Policy>> : std::integral_constant<std::size_t, N> {};
+
+template <typename CharT, std::size_t N>
+struct format_max_chars<CharT, CharT[N]> : std::integral_constant<std::size_t, N - 1> {};
+
+// Bound of the first count arguments: the ones that have a placeholder.
+template <typename CharT, typename... Args>
+constexpr std::size_t format_args_max_chars(std::size_t count) noexcept
+{
+	const std::size_t bounds[] = {format_max_chars<CharT, Args>::value..., 0};
+	std::size_t sum = 0;
+	for (std::size_t i = 0; i < count; ++i)
+		sum = add_max_chars(sum, bounds[i]);
+	return sum;
+}
+
+// Walks a format string: on_literal(str, count) gets the literal runs, "{{" and "}}" being unescaped, and
+// on_arg() is called for every "{}".
+template <typename CharT, typename Traits, typename Literal, typename Arg>
+constexpr void parse_format(basic_string_view<CharT, Traits> fmt, Literal&& on_literal, Arg&& on_arg)
+{
+	std::size_t begin = 0;
+	for (std::size_t i = 0; i < fmt.size(); ++i)
+	{
+		const bool open = Traits::eq(fmt[i], CharT('{'));
+		if (!open && !Traits::eq(fmt[i], CharT('}')))
+			continue;
+
+		on_literal(fmt.data() + begin, i - begin);
+		if (i + 1 < fmt.size() && Traits::eq(fmt[i + 1], fmt[i]))
+			begin = ++i;
+		else if (open && i + 1 < fmt.size() && Traits::eq(fmt[i + 1], CharT('}')))
+		{
+			on_arg();
+			begin = ++i + 1;
+		}
+		else
+			throw_helper<std::invalid_argument>("inplace_format: invalid format string");
+	}
+
+	on_literal(fmt.data() + begin, fmt.size() - begin);
+}
+
+// Output of a message known to fit: the characters are written through a pointer, without any capacity check.
+template <typename CharT, typename Traits>
+struct unchecked_format_sink
+{
+	void append(const CharT* str, std::size_t count)
+	{
+		Traits::copy(p, str, count);
+		p += count;
+	}
+
+	void push_back(CharT ch)
+	{
+		Traits::assign(*p++, ch);
+	}
+
+	template <typename T>
+	void append_number(T value)
+	{
+		append_number(value, std::is_same<CharT, char>{});
+	}
+
+	template <typename T>
+	void append_number(T value, std::true_type)
+	{
+		p = std::to_chars(p, p + max_chars<T>::value, value).ptr;
+	}
+
+	template <typename T>
+	void append_number(T value, std::false_type)
+	{
+		char buf[max_chars<T>::value];
+		const char* const last = std::to_chars(buf, buf + sizeof(buf), value).ptr;
+		for (const char* it = buf; it != last; ++it)
+			Traits::assign(*p++, static_cast<CharT>(*it));
+	}
+
+	CharT* p;
+};
+
+// Output of any other message: every piece goes through the overflow policy of the string.
+template <typename String>
+struct checked_format_sink
+{
+	using value_type = typename String::value_type;
+
+	void append(const value_type* s, std::size_t count)
+	{
+		str.append(s, count);
+	}
+
+	void push_back(value_type ch)
+	{
+		str.push_back(ch);
+	}
+
+	template <typename T>
+	void append_number(T value)
+	{
+		::append_number(str, value);
+	}
+
+	String& str;
+};
+
+template <typename CharT, typename Traits, typename Sink, typename T>
+void format_arg(Sink& sink, const T& value, std::integral_constant<int, 0>)
+{
+	sink.push_back(static_cast<CharT>(value));
+}
+
+template <typename CharT, typename Traits, typename Sink, typename T>
+void format_arg(Sink& sink, const T& value, std::integral_constant<int, 1>)
+{
+	sink.append_number(value);
+}
+
+template <typename CharT, typename Traits, typename Sink, typename T>
+void format_arg(Sink& sink, const T& value, std::integral_constant<int, 2>)
+{
+	const basic_string_view<CharT, Traits> view = value;
+	sink.append(view.data(), view.size());
+}
+
+template <typename CharT, typename Traits, typename Sink, typename T>
+void format_arg(Sink& sink, const T& value)
+{
+	using kind = std::integral_constant<int, std::is_same<T, CharT>::value || std::is_same<T, char>::value ? 0
+											 : is_to_chars_number<T>::value ? 1
+											 : std::is_convertible<const T&, basic_string_view<CharT, Traits>>::value ? 2 : 3>;
+	static_assert(kind::value != 3, "inplace_format: unsupported argument type");
+
+	format_arg<CharT, Traits>(sink, value, kind{});
+}
+
+template <typename CharT, typename Traits, typename Sink>
+void format_arg_at(Sink&, std::size_t)
+{
+	throw_helper<std::invalid_argument>("inplace_format: more placeholders than arguments");
+}
+
+// Formats the argument at index: a chain of comparisons that the compiler turns into a jump table.
+template <typename CharT, typename Traits, typename Sink, typename T, typename... Rest>
+void format_arg_at(Sink& sink, std::size_t index, const T& value, const Rest&... rest)
+{
+	if (index == 0)
+		format_arg<CharT, Traits>(sink, value);
+	else
+		format_arg_at<CharT, Traits>(sink, index - 1, rest...);
+}
+
+// Format strings with escaped braces are parsed again: the literal runs are not contiguous.
+template <typename CharT, typename Traits, typename Sink, typename... Args>
+void format_escaped(Sink& sink, basic_string_view<CharT, Traits> fmt, const Args&... args)
+{
+	std::size_t index = 0;
+	parse_format(fmt,
+				 [&](const CharT* first, std::size_t count) { sink.append(first, count); },
+				 [&]() { format_arg_at<CharT, Traits>(sink, index++, args...); });
+}
+
+}
+
+template <typename CharT, typename Traits, typename... Args>
+class basic_inplace_format_string;
+
+namespace detail
+{
+
+template <typename Sink, typename CharT, typename Traits, typename... Args>
+inline void format(Sink& sink, const basic_inplace_format_string<CharT, Traits, Args...>& fmt, const Args&... args);
+
+}
+
+// Format string of inplace_format_to: "{}" placeholders, formatted in order, and "{{" and "}}" for literal
+// braces. The string is parsed when it is built, at compile time from C++20 on: an invalid format string or a
+// placeholder without an argument then does not compile, and formatting only copies the literal runs between
+// the placeholders it found. max_size() bounds the formatted message from the literal and the types of the
+// arguments that have a placeholder, npos when a string argument does not bound its length.
+template <typename CharT, typename Traits, typename... Args>
+class basic_inplace_format_string
+{
+public:
+	template <typename S, typename X = typename std::enable_if<std::is_convertible<const S&, basic_string_view<CharT, Traits>>::value>::type>
+	INPLACE_STRING_CONSTEVAL basic_inplace_format_string(const S& str);
+
+	constexpr basic_string_view<CharT, Traits> get() const noexcept { return _str; }
+	constexpr std::size_t max_size() const noexcept { return _max_size; }
+
+private:
+	template <typename Sink, typename C, typename T, typename... A>
+	friend void detail::format(Sink& sink, const basic_inplace_format_string<C, T, A...>& fmt, const A&... args);
+
+	basic_string_view<CharT, Traits> _str;
+	std::size_t _max_size;
+	// Offsets of the placeholders, when the string has no escaped brace
+	std::array<std::size_t, sizeof...(Args)> _placeholders;
+	std::size_t _placeholder_count;
+	bool _escaped;
+};
+
+template <typename CharT, typename Traits, typename... Args>
+template <typename S, typename X>
+INPLACE_STRING_CONSTEVAL basic_inplace_format_string<CharT, Traits, Args...>::basic_inplace_format_string(const S& str)
+	: _str(str), _max_size(0), _placeholders{}, _placeholder_count(0), _escaped(false)
+{
+	std::size_t literal = 0;
+	std::size_t count = 0;
+	detail::parse_format(_str,
+		[&](const CharT* first, std::size_t n) {
+			literal += n;
+			// Literal runs are contiguous unless a brace was skipped
+			if (static_cast<std::size_t>(first - _str.data()) != literal - n + 2 * count)
+				_escaped = true;
+		},
+		[&]() {
+			if (count == sizeof...(Args))
+				detail::throw_helper<std::invalid_argument>("inplace_format: more placeholders than arguments");
+			_placeholders[count] = literal + 2 * count;
+			++count;
+		});
+
+	_placeholder_count = count;
+	_max_size = detail::add_max_chars(detail::format_args_max_chars<CharT, Args...>(count), literal);
+}
+
+namespace detail
+{
+
+// Inlined, the placeholder offsets of a constant format string are constants: the literal runs become
+// fixed-size copies.
+template <typename Sink, typename CharT, typename Traits, typename... Args>
+inline void format(Sink& sink, const basic_inplace_format_string<CharT, Traits, Args...>& fmt, const Args&... args)
+{
+	const basic_string_view<CharT, Traits> str = fmt._str;
+	if (fmt._escaped)
+		return format_escaped<CharT, Traits>(sink, str, args...);
+
+	std::size_t begin = 0;
+	std::size_t index = 0;
+	const auto format_next = [&](const auto& value) {
+		if (index == fmt._placeholder_count)
+			return;
+
+		const std::size_t pos = fmt._placeholders[index++];
+		sink.append(str.data() + begin, pos - begin);
+		format_arg<CharT, Traits>(sink, value);
+		begin = pos + 2;
+	};
+
+	(void)format_next;
+	(void)std::initializer_list<int>{(format_next(args), 0)...};
+	sink.append(str.data() + begin, str.size() - begin);
+}
+
+}
+
+template <typename... Args>
+using inplace_format_string = basic_inplace_format_string<char, std::char_traits<char>, typename detail::type_identity<Args>::type...>;
+
+// Appends the formatted message: integers and floating-point values as append_number writes them, characters,
+// and anything convertible to a string view. When max_size() of the format string fits in the room left, the
+// message is written without any capacity check; otherwise every piece goes through the overflow policy.
+template <std::size_t N, typename CharT, typename Traits, typename Policy, typename... Args>
+basic_inplace_string<N, CharT, Traits, Policy>& inplace_format_to(basic_inplace_string<N, CharT, Traits, Policy>& str,
+	typename detail::type_identity<basic_inplace_format_string<CharT, Traits, Args...>>::type fmt, const Args&... args)
+{
+	if (fmt.max_size() <= str.max_size() - str.size())
+	{
+		const auto span = str.prepare_append();
+		detail::unchecked_format_sink<CharT, Traits> sink{span.data};
+		detail::format(sink, fmt, args...);
+		str.commit_append(static_cast<std::size_t>(sink.p - span.data));
+	}
+	else
+	{
+		detail::checked_format_sink<basic_inplace_string<N, CharT, Traits, Policy>> sink{str};
+		detail::format(sink, fmt, args...);
+	}
+
+	return str;
+}
+
+template <std::size_t N, typename CharT = char, typename... Args>
+basic_inplace_string<N, CharT> inplace_format(
+	typename detail::type_identity<basic_inplace_format_string<CharT, std::char_traits<CharT>, Args...>>::type fmt, const Args&... args)
+{
+	basic_inplace_string<N, CharT> str;
+	inplace_format_to(str, fmt, args...);
+	return str;
+}
+#endif
+
+namespace detail
+{
+
+// Hashing the bytes only agrees with equality when Traits compares characters bitwise. Otherwise the hash is
+// disabled, as std::hash is for types without one: it cannot be constructed and has no call operator.
+template <typename String, bool Enabled>
+struct inplace_string_hash
+{
+	inplace_string_hash() = delete;
+	inplace_string_hash(const inplace_string_hash&) = delete;
+	inplace_string_hash& operator=(const inplace_string_hash&) = delete;
+};
+
+// The hash is tuned for open addressing: every bit of the result depends on every character.
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+struct inplace_string_hash<basic_inplace_string<N, CharT, Traits, Policy>, true>
+{
+	std::size_t operator()(const basic_inplace_string<N, CharT, Traits, Policy>& str) const noexcept
+	{
+		constexpr std::size_t bytes = size_field_of<N, CharT, Policy>::storage * sizeof(CharT);
+
+		return str.cached_hash([&str]
+		{
+			// With zero padding, the whole storage, size included, identifies the string.
+			const std::size_t len = Policy::zero_padded ? bytes : str.size() * sizeof(CharT);
+			return static_cast<std::size_t>(hash_block<bytes>(str.data(), len));
+		});
+	}
+};
+
+}
+
+namespace std
+{
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+struct hash<basic_inplace_string<N, CharT, Traits, Policy>> :
+	public detail::inplace_string_hash<basic_inplace_string<N, CharT, Traits, Policy>, detail::is_bitwise_comparable<CharT, Traits>::value>
+{};
 
 }
 
@@ -0,0 +1,591 @@
+#pragma once
+
+#include "inplace_string.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <iterator>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Sorts for ranges of basic_inplace_string, or of records sorted on a basic_inplace_string key.
+// As every character of a string sits at a fixed offset, strings of single-byte characters are radix sorted,
+// most significant character first: each pass buckets a range on one character, the strings ending there come
+// first, and only the buckets holding more than one string are sorted further. Small buckets finish with an
+// insertion sort comparing from the current depth on. Other character types fall back to std::sort and
+// std::stable_sort.
+// key(element) must return a const reference to the basic_inplace_string to sort on; it defaults to the
+// element itself.
+
+namespace detail
+{
+
+struct identity_key
+{
+	template <typename T>
+	const T& operator()(const T& value) const noexcept { return value; }
+};
+
+template <typename String>
+struct is_radix_sortable :
+	public std::integral_constant<bool,
+		sizeof(typename String::value_type) == 1
+		&& is_bitwise_comparable<typename String::value_type, typename String::traits_type>::value>
+{};
+
+// Bucket 0 holds the strings ending before depth, bucket c + 1 the ones with c at depth.
+constexpr std::size_t radix_buckets = 257;
+constexpr std::ptrdiff_t radix_insertion_threshold = 32;
+
+template <typename String>
+inline std::size_t radix_digit(const String& str, std::size_t depth) noexcept
+{
+	return depth < str.size() ? static_cast<std::size_t>(static_cast<unsigned char>(str.data()[depth])) + 1 : 0;
+}
+
+// lhs < rhs, knowing that their first depth characters are equal
+template <typename String>
+inline bool radix_less(const String& lhs, const String& rhs, std::size_t depth) noexcept
+{
+	const std::size_t lhs_size = lhs.size(), rhs_size = rhs.size();
+	const std::size_t count = std::min(lhs_size, rhs_size);
+	if (count > depth)
+	{
+		const int res = String::traits_type::compare(lhs.data() + depth, rhs.data() + depth, count - depth);
+		if (res != 0)
+			return res < 0;
+	}
+
+	return lhs_size < rhs_size;
+}
+
+// Stable
+template <typename RandomIt, typename Key>
+void radix_insertion_sort(RandomIt first, RandomIt last, Key& key, std::size_t depth)
+{
+	if (first == last)
+		return;
+
+	for (RandomIt it = first + 1; it != last; ++it)
+	{
+		if (!radix_less(key(*it), key(*(it - 1)), depth))
+			continue;
+
+		auto value = std::move(*it);
+		RandomIt hole = it;
+		do
+		{
+			*hole = std::move(*(hole - 1));
+			--hole;
+		} while (hole != first && radix_less(key(value), key(*(hole - 1)), depth));
+
+		*hole = std::move(value);
+	}
+}
+
+template <typename RandomIt>
+struct radix_range
+{
+	RandomIt first;
+	RandomIt last;
+	std::size_t depth;
+};
+
+// Counts the digits of [first, last) at depth. Returns false when every string falls in one bucket, in which case
+// there is nothing to move.
+template <typename RandomIt, typename Key>
+bool radix_count(RandomIt first, RandomIt last, Key& key, std::size_t depth, std::size_t* counts)
+{
+	std::fill(counts, counts + radix_buckets, std::size_t{0});
+	for (RandomIt it = first; it != last; ++it)
+		++counts[radix_digit(key(*it), depth)];
+
+	return counts[radix_digit(key(*first), depth)] != static_cast<std::size_t>(last - first);
+}
+
+// Pushes the buckets still to sort, the strings of bucket 0 being all equal
+template <typename RandomIt>
+void radix_push_buckets(std::vector<radix_range<RandomIt>>& ranges, RandomIt first, const std::size_t* counts, std::size_t depth)
+{
+	RandomIt bucket = first + static_cast<std::ptrdiff_t>(counts[0]);
+	for (std::size_t digit = 1; digit != radix_buckets; ++digit)
+	{
+		const RandomIt next = bucket + static_cast<std::ptrdiff_t>(counts[digit]);
+		if (counts[digit] > 1)
+			ranges.push_back({bucket, next, depth + 1});
+		bucket = next;
+	}
+}
+
+// American flag sort: the buckets are permuted in place, by cycles of swaps.
+template <typename RandomIt, typename Key>
+void radix_sort(RandomIt first, RandomIt last, Key& key)
+{
+	std::vector<radix_range<RandomIt>> ranges;
+	ranges.push_back({first, last, 0});
+
+	std::size_t counts[radix_buckets];
+	std::ptrdiff_t heads[radix_buckets], tails[radix_buckets];
+
+	while (!ranges.empty())
+	{
+		radix_range<RandomIt> range = ranges.back();
+		ranges.pop_back();
+
+		if (range.last - range.first <= radix_insertion_threshold)
+		{
+			radix_insertion_sort(range.first, range.last, key, range.depth);
+			continue;
+		}
+
+		if (!radix_count(range.first, range.last, key, range.depth, counts))
+		{
+			if (radix_digit(key(*range.first), range.depth) != 0)
+				ranges.push_back({range.first, range.last, range.depth + 1});
+			continue;
+		}
+
+		std::ptrdiff_t offset = 0;
+		for (std::size_t digit = 0; digit != radix_buckets; ++digit)
+		{
+			heads[digit] = offset;
+			offset += static_cast<std::ptrdiff_t>(counts[digit]);
+			tails[digit] = offset;
+		}
+
+		using std::swap;
+		for (std::size_t digit = 0; digit != radix_buckets; ++digit)
+		{
+			while (heads[digit] != tails[digit])
+			{
+				const std::size_t target = radix_digit(key(range.first[heads[digit]]), range.depth);
+				if (target == digit)
+					++heads[digit];
+				else
+					swap(range.first[heads[digit]], range.first[heads[target]++]);
+			}
+		}
+
+		radix_push_buckets(ranges, range.first, counts, range.depth);
+	}
+}
+
+// Sorts [first, last), whose first depth characters are equal. Each pass scatters a range into the buffer at
+// scratch, of last - first elements, in order, and moves it back.
+template <typename RandomIt, typename Key, typename ScratchIt>
+void stable_radix_sort(RandomIt first, RandomIt last, Key& key, std::size_t depth, ScratchIt scratch_first)
+{
+	std::vector<radix_range<RandomIt>> ranges;
+	ranges.push_back({first, last, depth});
+
+	std::size_t counts[radix_buckets];
+	std::ptrdiff_t heads[radix_buckets];
+
+	while (!ranges.empty())
+	{
+		radix_range<RandomIt> range = ranges.back();
+		ranges.pop_back();
+
+		if (range.last - range.first <= radix_insertion_threshold)
+		{
+			radix_insertion_sort(range.first, range.last, key, range.depth);
+			continue;
+		}
+
+		if (!radix_count(range.first, range.last, key, range.depth, counts))
+		{
+			if (radix_digit(key(*range.first), range.depth) != 0)
+				ranges.push_back({range.first, range.last, range.depth + 1});
+			continue;
+		}
+
+		std::ptrdiff_t offset = 0;
+		for (std::size_t digit = 0; digit != radix_buckets; ++digit)
+		{
+			heads[digit] = offset;
+			offset += static_cast<std::ptrdiff_t>(counts[digit]);
+		}
+
+		const ScratchIt scratch = scratch_first + (range.first - first);
+		for (RandomIt it = range.first; it != range.last; ++it)
+			scratch[heads[radix_digit(key(*it), range.depth)]++] = std::move(*it);
+		std::move(scratch, scratch + (range.last - range.first), range.first);
+
+		radix_push_buckets(ranges, range.first, counts, range.depth);
+	}
+}
+
+template <typename Key>
+struct key_less
+{
+	Key& key;
+
+	template <typename T>
+	bool operator()(const T& lhs, const T& rhs) const { return key(lhs) < key(rhs); }
+};
+
+template <typename RandomIt, typename Key>
+void inplace_string_sort(RandomIt first, RandomIt last, Key& key, std::true_type)
+{
+	radix_sort(first, last, key);
+}
+
+template <typename RandomIt, typename Key>
+void inplace_string_sort(RandomIt first, RandomIt last, Key& key, std::false_type)
+{
+	std::sort(first, last, key_less<Key>{key});
+}
+
+template <typename RandomIt, typename Key>
+void inplace_string_stable_sort(RandomIt first, RandomIt last, Key& key, std::true_type)
+{
+	std::vector<typename std::iterator_traits<RandomIt>::value_type> buffer(static_cast<std::size_t>(last - first));
+	stable_radix_sort(first, last, key, 0, buffer.begin());
+}
+
+template <typename RandomIt, typename Key>
+void inplace_string_stable_sort(RandomIt first, RandomIt last, Key& key, std::false_type)
+{
+	std::stable_sort(first, last, key_less<Key>{key});
+}
+
+template <typename RandomIt, typename Key>
+using sort_key_type = typename std::decay<decltype(std::declval<Key&>()(*std::declval<RandomIt>()))>::type;
+
+}
+
+// Sorts [first, last) in ascending order of key(element), as operator< does. Equal keys may be reordered.
+template <typename RandomIt, typename Key = detail::identity_key>
+void inplace_string_sort(RandomIt first, RandomIt last, Key key = Key())
+{
+	using string_type = detail::sort_key_type<RandomIt, Key>;
+	static_assert(detail::is_inplace_string<string_type>::value, "inplace_string_sort: key must be a basic_inplace_string");
+
+	if (last - first > 1)
+		detail::inplace_string_sort(first, last, key, detail::is_radix_sortable<string_type>());
+}
+
+// Same as inplace_string_sort, keeping the order of the elements with equal keys. Uses a buffer of last - first
+// default-constructed elements.
+template <typename RandomIt, typename Key = detail::identity_key>
+void inplace_string_stable_sort(RandomIt first, RandomIt last, Key key = Key())
+{
+	using string_type = detail::sort_key_type<RandomIt, Key>;
+	static_assert(detail::is_inplace_string<string_type>::value, "inplace_string_stable_sort: key must be a basic_inplace_string");
+
+	if (last - first > 1)
+		detail::inplace_string_stable_sort(first, last, key, detail::is_radix_sortable<string_type>());
+}
+
+// Parallel algorithms: threads is the number of threads to use, the calling one included; 0 stands for
+// std::thread::hardware_concurrency(). Threads are started for the duration of each call, and take their work
+// from a shared counter so that uneven tasks balance out. Small ranges are processed on the calling thread.
+// key() and the moves of the elements must not throw.
+
+namespace detail
+{
+
+// Below this number of elements per thread, starting threads costs more than it saves
+constexpr std::size_t parallel_grain = 1 << 14;
+
+inline unsigned parallel_threads(unsigned threads, std::size_t count) noexcept
+{
+	if (threads == 0)
+		threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+	return static_cast<unsigned>(std::min<std::size_t>(threads, std::max<std::size_t>(count / parallel_grain, 1)));
+}
+
+// Joins its threads when destroyed, even when starting one of them threw
+class thread_group
+{
+public:
+	thread_group() = default;
+	thread_group(const thread_group&) = delete;
+	thread_group& operator=(const thread_group&) = delete;
+
+	~thread_group()
+	{
+		for (std::thread& thread : _threads)
+			thread.join();
+	}
+
+	template <typename F>
+	void start(F& f, std::size_t count)
+	{
+		_threads.reserve(count);
+		for (std::size_t i = 0; i != count; ++i)
+			_threads.emplace_back(std::ref(f));
+	}
+
+private:
+	std::vector<std::thread> _threads;
+};
+
+// Calls f(0), ..., f(tasks - 1) on up to threads threads, the calling one included
+template <typename F>
+void parallel_for(unsigned threads, std::size_t tasks, F f)
+{
+	std::atomic<std::size_t> next{0};
+	auto worker = [&]
+	{
+		for (std::size_t task = next.fetch_add(1, std::memory_order_relaxed); task < tasks; task = next.fetch_add(1, std::memory_order_relaxed))
+			f(task);
+	};
+
+	if (tasks == 0)
+		return;
+
+	thread_group group;
+	group.start(worker, std::min<std::size_t>(threads, tasks) - 1);
+	worker();
+}
+
+// [first, last) split in count chunks of almost equal sizes
+template <typename RandomIt>
+struct chunks
+{
+	RandomIt first;
+	std::size_t size;
+	std::size_t count;
+
+	RandomIt begin(std::size_t chunk) const { return first + static_cast<std::ptrdiff_t>(size * chunk / count); }
+	RandomIt end(std::size_t chunk) const { return first + static_cast<std::ptrdiff_t>(size * (chunk + 1) / count); }
+};
+
+// Most significant digit first, as in stable_radix_sort, but the digits of a pass are counted and scattered by
+// chunks, in parallel. Buckets larger than a thread's share are then sorted the same way, one after the other,
+// and the other ones are sorted sequentially, in parallel with each other, the largest first.
+template <typename RandomIt, typename Key, typename ScratchIt>
+void parallel_radix_sort(unsigned threads, RandomIt first, RandomIt last, Key& key, std::size_t depth, ScratchIt scratch)
+{
+	const std::size_t count = static_cast<std::size_t>(last - first);
+	threads = parallel_threads(threads, count);
+	if (threads < 2)
+	{
+		stable_radix_sort(first, last, key, depth, scratch);
+		return;
+	}
+
+	const chunks<RandomIt> parts{first, count, threads};
+	std::vector<std::array<std::size_t, radix_buckets>> counts(threads);
+	std::array<std::size_t, radix_buckets> totals;
+
+	for (;;)
+	{
+		parallel_for(threads, threads, [&](std::size_t chunk)
+		{
+			auto& chunk_counts = counts[chunk];
+			chunk_counts.fill(0);
+			for (RandomIt it = parts.begin(chunk); it != parts.end(chunk); ++it)
+				++chunk_counts[radix_digit(key(*it), depth)];
+		});
+
+		totals.fill(0);
+		for (const auto& chunk_counts : counts)
+			for (std::size_t digit = 0; digit != radix_buckets; ++digit)
+				totals[digit] += chunk_counts[digit];
+
+		// Nothing to move while every string falls in the same bucket
+		const std::size_t digit = radix_digit(key(*first), depth);
+		if (totals[digit] != count)
+			break;
+		if (digit == 0)
+			return;
+		++depth;
+	}
+
+	// counts become the offsets where each chunk scatters its strings
+	std::size_t offset = 0;
+	for (std::size_t digit = 0; digit != radix_buckets; ++digit)
+	{
+		for (auto& chunk_counts : counts)
+		{
+			const std::size_t chunk_count = chunk_counts[digit];
+			chunk_counts[digit] = offset;
+			offset += chunk_count;
+		}
+	}
+
+	parallel_for(threads, threads, [&](std::size_t chunk)
+	{
+		auto& offsets = counts[chunk];
+		for (RandomIt it = parts.begin(chunk); it != parts.end(chunk); ++it)
+			scratch[static_cast<std::ptrdiff_t>(offsets[radix_digit(key(*it), depth)]++)] = std::move(*it);
+	});
+
+	parallel_for(threads, threads, [&](std::size_t chunk)
+	{
+		std::move(scratch + (parts.begin(chunk) - first), scratch + (parts.end(chunk) - first), parts.begin(chunk));
+	});
+
+	std::vector<radix_range<RandomIt>> buckets;
+	RandomIt bucket = first + static_cast<std::ptrdiff_t>(totals[0]);
+	for (std::size_t digit = 1; digit != radix_buckets; ++digit)
+	{
+		const RandomIt next = bucket + static_cast<std::ptrdiff_t>(totals[digit]);
+		if (totals[digit] > count / threads)
+			parallel_radix_sort(threads, bucket, next, key, depth + 1, scratch + (bucket - first));
+		else if (totals[digit] > 1)
+			buckets.push_back({bucket, next, depth + 1});
+		bucket = next;
+	}
+
+	std::sort(buckets.begin(), buckets.end(), [](const radix_range<RandomIt>& lhs, const radix_range<RandomIt>& rhs)
+	{
+		return lhs.last - lhs.first > rhs.last - rhs.first;
+	});
+
+	parallel_for(threads, buckets.size(), [&](std::size_t task)
+	{
+		const radix_range<RandomIt>& range = buckets[task];
+		stable_radix_sort(range.first, range.last, key, range.depth, scratch + (range.first - first));
+	});
+}
+
+template <typename RandomIt, typename Key>
+void inplace_string_parallel_sort(unsigned threads, RandomIt first, RandomIt last, Key& key, std::true_type)
+{
+	std::vector<typename std::iterator_traits<RandomIt>::value_type> buffer(static_cast<std::size_t>(last - first));
+	parallel_radix_sort(threads, first, last, key, 0, buffer.begin());
+}
+
+// Chunks sorted in parallel, then merged pairwise, each round of merges in parallel
+template <typename RandomIt, typename Key>
+void inplace_string_parallel_sort(unsigned threads, RandomIt first, RandomIt last, Key& key, std::false_type)
+{
+	const std::size_t count = static_cast<std::size_t>(last - first);
+	threads = parallel_threads(threads, count);
+
+	const chunks<RandomIt> parts{first, count, threads};
+	parallel_for(threads, threads, [&](std::size_t chunk)
+	{
+		std::stable_sort(parts.begin(chunk), parts.end(chunk), key_less<Key>{key});
+	});
+
+	for (std::size_t width = 1; width < threads; width *= 2)
+	{
+		parallel_for(threads, (threads + 2 * width - 1) / (2 * width), [&](std::size_t task)
+		{
+			const std::size_t chunk = task * 2 * width;
+			if (chunk + width < threads)
+				std::inplace_merge(parts.begin(chunk), parts.begin(chunk + width),
+								   parts.end(std::min<std::size_t>(chunk + 2 * width, threads) - 1), key_less<Key>{key});
+		});
+	}
+}
+
+template <typename Key>
+struct key_equal
+{
+	Key& key;
+
+	template <typename T>
+	bool operator()(const T& lhs, const T& rhs) const { return key(lhs) == key(rhs); }
+};
+
+// First element of a chunk starting a run of equal keys: the chunk's beginning, unless the previous chunk ends
+// with the same key
+template <typename RandomIt, typename Key>
+RandomIt first_run(const chunks<RandomIt>& parts, std::size_t chunk, Key& key)
+{
+	RandomIt it = parts.begin(chunk);
+	const RandomIt end = parts.end(chunk);
+	if (chunk != 0)
+	{
+		const auto& previous = key(*(it - 1));
+		while (it != end && key(*it) == previous)
+			++it;
+	}
+
+	return it;
+}
+
+}
+
+// Sorts [first, last) in ascending order of key(element), keeping the order of the elements with equal keys, on
+// up to threads threads. Uses a buffer of last - first default-constructed elements.
+template <typename RandomIt, typename Key = detail::identity_key>
+void inplace_string_parallel_sort(unsigned threads, RandomIt first, RandomIt last, Key key = Key())
+{
+	using string_type = detail::sort_key_type<RandomIt, Key>;
+	static_assert(detail::is_inplace_string<string_type>::value, "inplace_string_parallel_sort: key must be a basic_inplace_string");
+
+	if (last - first > 1)
+		detail::inplace_string_parallel_sort(threads, first, last, key, detail::is_radix_sortable<string_type>());
+}
+
+// std::unique on up to threads threads: removes all but the first element of every run of equal keys, and returns
+// the new end of the range. Each chunk of the range is compacted in parallel, then the chunks are moved together.
+template <typename RandomIt, typename Key = detail::identity_key>
+RandomIt inplace_string_parallel_unique(unsigned threads, RandomIt first, RandomIt last, Key key = Key())
+{
+	using string_type = detail::sort_key_type<RandomIt, Key>;
+	static_assert(detail::is_inplace_string<string_type>::value, "inplace_string_parallel_unique: key must be a basic_inplace_string");
+
+	const std::size_t count = static_cast<std::size_t>(last - first);
+	threads = detail::parallel_threads(threads, count);
+	if (threads < 2)
+		return std::unique(first, last, detail::key_equal<Key>{key});
+
+	const detail::chunks<RandomIt> parts{first, count, threads};
+
+	// Found before any element moves: the first run of a chunk is compared to the last element of the previous one
+	std::vector<RandomIt> runs(threads);
+	detail::parallel_for(threads, threads, [&](std::size_t chunk)
+	{
+		runs[chunk] = detail::first_run(parts, chunk, key);
+	});
+
+	std::vector<RandomIt> ends(threads);
+	detail::parallel_for(threads, threads, [&](std::size_t chunk)
+	{
+		const RandomIt begin = parts.begin(chunk);
+		const RandomIt end = std::unique(runs[chunk], parts.end(chunk), detail::key_equal<Key>{key});
+		ends[chunk] = runs[chunk] == begin ? end : std::move(runs[chunk], end, begin);
+	});
+
+	// Chunks that nothing was removed before are already in place
+	RandomIt res = ends[0];
+	for (std::size_t chunk = 1; chunk != threads; ++chunk)
+		res = res == parts.begin(chunk) ? ends[chunk] : std::move(parts.begin(chunk), ends[chunk], res);
+
+	return res;
+}
+
+// Writes a std::pair of the key and the number of elements of every run of equal keys in [first, last) to out,
+// which is the number of occurrences of every key when the range is sorted. Returns the end of the output.
+// The runs are counted by chunks, in parallel, and written in order from the calling thread.
+template <typename RandomIt, typename OutputIt, typename Key = detail::identity_key>
+OutputIt inplace_string_parallel_count_by_key(unsigned threads, RandomIt first, RandomIt last, OutputIt out, Key key = Key())
+{
+	using string_type = detail::sort_key_type<RandomIt, Key>;
+	static_assert(detail::is_inplace_string<string_type>::value, "inplace_string_parallel_count_by_key: key must be a basic_inplace_string");
+
+	const std::size_t count = static_cast<std::size_t>(last - first);
+	threads = detail::parallel_threads(threads, count);
+
+	const detail::chunks<RandomIt> parts{first, count, threads};
+	std::vector<std::vector<std::pair<string_type, std::size_t>>> groups(threads);
+	detail::parallel_for(threads, threads, [&](std::size_t chunk)
+	{
+		// Runs starting in this chunk, possibly ending in the next ones
+		RandomIt it = detail::first_run(parts, chunk, key);
+		const RandomIt end = parts.end(chunk);
+		while (it < end)
+		{
+			const auto& group = key(*it);
+			const RandomIt run = it;
+			while (++it != last && key(*it) == group) {}
+			groups[chunk].emplace_back(group, static_cast<std::size_t>(it - run));
+		}
+	});
+
+	for (const auto& chunk_groups : groups)
+		out = std::copy(chunk_groups.begin(), chunk_groups.end(), out);
+
+	return out;
+}
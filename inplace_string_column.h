@@ -0,0 +1,361 @@
+#pragma once
+
+#include "inplace_string.h"
+
+#include <cstdint>
+#include <vector>
+
+// Column of strings of at most N characters, stored as a structure of arrays: the characters in blocks of N,
+// zero-padded, the lengths in their own array and, with Prefixes, the first 8 bytes of every string in a third
+// one. Scans touching only lengths or prefixes read a fraction of the memory a vector of basic_inplace_string
+// would: 1 byte per string for the lengths of a column of N < 256, 8 bytes for the prefixes.
+// Elements are read as basic_string_view, or copied to basic_inplace_string, and written with push_back or set.
+template <std::size_t N,
+		  typename CharT = char,
+		  typename Traits = std::char_traits<CharT>,
+		  bool Prefixes = false>
+class basic_inplace_string_column
+{
+public:
+	using traits_type = Traits;
+	using value_type = CharT;
+	using size_type = std::size_t;
+	using string_view_type = basic_string_view<CharT, Traits>;
+	using string_type = basic_inplace_string<N, CharT, Traits>;
+	using length_type = typename std::conditional<(N <= 0xff), std::uint8_t,
+						typename std::conditional<(N <= 0xffff), std::uint16_t, std::uint32_t>::type>::type;
+
+	static constexpr const size_type npos = static_cast<size_type>(-1);
+	static constexpr const bool has_prefixes = Prefixes;
+
+	basic_inplace_string_column() = default;
+	explicit basic_inplace_string_column(size_type count) { resize(count); }
+
+	template <typename InputIt>
+	basic_inplace_string_column(InputIt first, InputIt last);
+
+	static constexpr size_type max_length() noexcept { return N; }
+
+	size_type size() const noexcept { return _lengths.size(); }
+	bool empty() const noexcept { return _lengths.empty(); }
+
+	void reserve(size_type count);
+	void resize(size_type count);
+	void clear() noexcept;
+
+	void push_back(string_view_type str);
+	void pop_back() noexcept;
+	void set(size_type index, string_view_type str);
+
+	string_view_type operator[](size_type index) const noexcept { assert(index < size()); return {block(index), _lengths[index]}; }
+	string_view_type at(size_type index) const;
+	string_type      get(size_type index) const { return string_type(operator[](index)); }
+	size_type        length(size_type index) const noexcept { assert(index < size()); return _lengths[index]; }
+
+	// Raw columns, for kernels of their own
+	const CharT*       chars() const noexcept { return _chars.data(); }
+	const length_type* lengths() const noexcept { return _lengths.data(); }
+
+	template <bool P = Prefixes, typename X = typename std::enable_if<P>::type>
+	const std::uint64_t* prefixes() const noexcept { return _prefixes.data(); }
+
+	// Index of the first string equal to str at or after pos, npos if there is none: lengths are scanned first,
+	// then the prefixes, and only the remaining candidates compare their characters.
+	size_type find(string_view_type str, size_type pos = 0) const noexcept;
+	size_type count(string_view_type str) const noexcept;
+
+	// Bulk filters: write the indices of the matching strings to out, in increasing order.
+	template <typename OutputIt>
+	OutputIt filter_length(size_type min_length, size_type max_length, OutputIt out) const;
+
+	template <typename OutputIt>
+	OutputIt filter_equal(string_view_type str, OutputIt out) const;
+
+	template <typename OutputIt>
+	OutputIt filter_prefix(string_view_type prefix, OutputIt out) const;
+
+	template <typename Predicate, typename OutputIt>
+	OutputIt filter(Predicate pred, OutputIt out) const;
+
+private:
+	static constexpr size_type prefix_chars = sizeof(std::uint64_t) / sizeof(CharT) < N ? sizeof(std::uint64_t) / sizeof(CharT) : N;
+
+	// Comparing prefixes as integers only agrees with Traits when Traits compares characters bitwise
+	static constexpr bool prefix_scan = Prefixes && detail::is_bitwise_comparable<CharT, Traits>::value;
+
+	const CharT* block(size_type index) const noexcept { return _chars.data() + index * N; }
+	CharT*       block(size_type index) noexcept       { return _chars.data() + index * N; }
+
+	void store(size_type index, string_view_type str) noexcept;
+
+	// Calls f(index) for the indices in [first, size()) whose length is in [min_length, max_length], until f
+	// returns false. Returns false if f stopped the scan.
+	template <typename F>
+	bool for_each_length(size_type first, size_type min_length, size_type max_length, F f) const;
+
+	static std::uint64_t load_prefix(const CharT* str, size_type count) noexcept
+	{
+		std::uint64_t prefix = 0;
+		std::memcpy(&prefix, str, std::min(count, prefix_chars) * sizeof(CharT));
+		return prefix;
+	}
+
+	bool equal_at(size_type index, string_view_type str, std::uint64_t prefix) const noexcept
+	{
+		if (prefix_scan && prefix_at(index) != prefix)
+			return false;
+		if (prefix_scan && str.size() <= prefix_chars)
+			return true;
+		return Traits::compare(block(index), str.data(), str.size()) == 0;
+	}
+
+	std::uint64_t prefix_at(size_type index) const noexcept { return Prefixes ? _prefixes[index] : 0; }
+
+	std::vector<CharT> _chars;
+	std::vector<length_type> _lengths;
+	std::vector<std::uint64_t> _prefixes;
+};
+
+template <std::size_t N, typename CharT, typename Traits, bool Prefixes>
+template <typename InputIt>
+basic_inplace_string_column<N, CharT, Traits, Prefixes>::basic_inplace_string_column(InputIt first, InputIt last)
+{
+	for (; first != last; ++first)
+		push_back(*first);
+}
+
+template <std::size_t N, typename CharT, typename Traits, bool Prefixes>
+void basic_inplace_string_column<N, CharT, Traits, Prefixes>::reserve(size_type count)
+{
+	_chars.reserve(count * N);
+	_lengths.reserve(count);
+	if (Prefixes)
+		_prefixes.reserve(count);
+}
+
+template <std::size_t N, typename CharT, typename Traits, bool Prefixes>
+void basic_inplace_string_column<N, CharT, Traits, Prefixes>::resize(size_type count)
+{
+	_chars.resize(count * N);
+	_lengths.resize(count);
+	if (Prefixes)
+		_prefixes.resize(count);
+}
+
+template <std::size_t N, typename CharT, typename Traits, bool Prefixes>
+void basic_inplace_string_column<N, CharT, Traits, Prefixes>::clear() noexcept
+{
+	_chars.clear();
+	_lengths.clear();
+	_prefixes.clear();
+}
+
+template <std::size_t N, typename CharT, typename Traits, bool Prefixes>
+void basic_inplace_string_column<N, CharT, Traits, Prefixes>::push_back(string_view_type str)
+{
+	if (str.size() > N)
+		detail::throw_helper<std::length_error>("basic_inplace_string_column::push_back: exceed maximum string length");
+
+	resize(size() + 1);
+	store(size() - 1, str);
+}
+
+template <std::size_t N, typename CharT, typename Traits, bool Prefixes>
+void basic_inplace_string_column<N, CharT, Traits, Prefixes>::pop_back() noexcept
+{
+	assert(!empty());
+	resize(size() - 1);
+}
+
+template <std::size_t N, typename CharT, typename Traits, bool Prefixes>
+void basic_inplace_string_column<N, CharT, Traits, Prefixes>::set(size_type index, string_view_type str)
+{
+	if (index >= size())
+		detail::throw_helper<std::out_of_range>("basic_inplace_string_column::set: out of range");
+	if (str.size() > N)
+		detail::throw_helper<std::length_error>("basic_inplace_string_column::set: exceed maximum string length");
+
+	store(index, str);
+}
+
+template <std::size_t N, typename CharT, typename Traits, bool Prefixes>
+typename basic_inplace_string_column<N, CharT, Traits, Prefixes>::string_view_type
+basic_inplace_string_column<N, CharT, Traits, Prefixes>::at(size_type index) const
+{
+	if (index >= size())
+		detail::throw_helper<std::out_of_range>("basic_inplace_string_column::at: out of range");
+
+	return operator[](index);
+}
+
+// Blocks stay zero-padded: prefixes of short strings are then comparable as plain integers.
+template <std::size_t N, typename CharT, typename Traits, bool Prefixes>
+void basic_inplace_string_column<N, CharT, Traits, Prefixes>::store(size_type index, string_view_type str) noexcept
+{
+	CharT* const dest = block(index);
+	Traits::copy(dest, str.data(), str.size());
+	Traits::assign(dest + str.size(), N - str.size(), CharT{});
+
+	_lengths[index] = static_cast<length_type>(str.size());
+	if (Prefixes)
+		_prefixes[index] = load_prefix(dest, N);
+}
+
+template <std::size_t N, typename CharT, typename Traits, bool Prefixes>
+template <typename F>
+bool basic_inplace_string_column<N, CharT, Traits, Prefixes>::for_each_length(size_type first, size_type min_length, size_type max_length, F f) const
+{
+	if (min_length > max_length || min_length > N)
+		return true;
+	max_length = std::min<size_type>(max_length, N);
+
+	const length_type* const lengths = _lengths.data();
+	const size_type count = size();
+	size_type i = first;
+
+#if defined INPLACE_STRING_SSE2
+	if (sizeof(length_type) == 1)
+	{
+		// length - min <= max - min, in unsigned 8-bit arithmetic, for 16 lengths at once
+		const __m128i low = _mm_set1_epi8(static_cast<char>(min_length));
+		const __m128i range = _mm_set1_epi8(static_cast<char>(max_length - min_length));
+
+		for (; i + 16 <= count; i += 16)
+		{
+			const __m128i block_lengths = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lengths + i));
+			const __m128i offset = _mm_sub_epi8(block_lengths, low);
+			unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(offset, range), range)));
+
+			for (; mask != 0; mask &= mask - 1)
+				if (!f(i + detail::count_trailing_zeros(mask)))
+					return false;
+		}
+	}
+#endif
+
+	for (; i < count; ++i)
+		if (static_cast<size_type>(lengths[i] - min_length) <= max_length - min_length && !f(i))
+			return false;
+
+	return true;
+}
+
+template <std::size_t N, typename CharT, typename Traits, bool Prefixes>
+typename basic_inplace_string_column<N, CharT, Traits, Prefixes>::size_type
+basic_inplace_string_column<N, CharT, Traits, Prefixes>::find(string_view_type str, size_type pos) const noexcept
+{
+	if (str.size() > N)
+		return npos;
+
+	const std::uint64_t prefix = prefix_scan ? load_prefix(str.data(), str.size()) : 0;
+	size_type res = npos;
+
+	for_each_length(pos, str.size(), str.size(), [&](size_type index)
+	{
+		if (!equal_at(index, str, prefix))
+			return true;
+
+		res = index;
+		return false;
+	});
+
+	return res;
+}
+
+template <std::size_t N, typename CharT, typename Traits, bool Prefixes>
+typename basic_inplace_string_column<N, CharT, Traits, Prefixes>::size_type
+basic_inplace_string_column<N, CharT, Traits, Prefixes>::count(string_view_type str) const noexcept
+{
+	if (str.size() > N)
+		return 0;
+
+	const std::uint64_t prefix = prefix_scan ? load_prefix(str.data(), str.size()) : 0;
+	size_type res = 0;
+
+	for_each_length(0, str.size(), str.size(), [&](size_type index)
+	{
+		res += equal_at(index, str, prefix);
+		return true;
+	});
+
+	return res;
+}
+
+template <std::size_t N, typename CharT, typename Traits, bool Prefixes>
+template <typename OutputIt>
+OutputIt basic_inplace_string_column<N, CharT, Traits, Prefixes>::filter_length(size_type min_length, size_type max_length, OutputIt out) const
+{
+	for_each_length(0, min_length, max_length, [&out](size_type index)
+	{
+		*out++ = index;
+		return true;
+	});
+
+	return out;
+}
+
+template <std::size_t N, typename CharT, typename Traits, bool Prefixes>
+template <typename OutputIt>
+OutputIt basic_inplace_string_column<N, CharT, Traits, Prefixes>::filter_equal(string_view_type str, OutputIt out) const
+{
+	if (str.size() > N)
+		return out;
+
+	const std::uint64_t prefix = prefix_scan ? load_prefix(str.data(), str.size()) : 0;
+
+	for_each_length(0, str.size(), str.size(), [&](size_type index)
+	{
+		if (equal_at(index, str, prefix))
+			*out++ = index;
+		return true;
+	});
+
+	return out;
+}
+
+// Prefixes that fit in the prefix column are matched there, masking the characters past the prefix: the
+// character blocks are not touched at all.
+template <std::size_t N, typename CharT, typename Traits, bool Prefixes>
+template <typename OutputIt>
+OutputIt basic_inplace_string_column<N, CharT, Traits, Prefixes>::filter_prefix(string_view_type prefix, OutputIt out) const
+{
+	if (prefix.size() > N)
+		return out;
+
+	if (prefix_scan && prefix.size() <= prefix_chars)
+	{
+		std::uint64_t mask = 0;
+		std::memset(&mask, 0xff, prefix.size() * sizeof(CharT));
+		const std::uint64_t value = load_prefix(prefix.data(), prefix.size());
+		const size_type min_length = prefix.size();
+
+		for (size_type i = 0, count = size(); i != count; ++i)
+			if ((prefix_at(i) & mask) == value && _lengths[i] >= min_length)
+				*out++ = i;
+
+		return out;
+	}
+
+	for_each_length(0, prefix.size(), N, [&](size_type index)
+	{
+		if (Traits::compare(block(index), prefix.data(), prefix.size()) == 0)
+			*out++ = index;
+		return true;
+	});
+
+	return out;
+}
+
+template <std::size_t N, typename CharT, typename Traits, bool Prefixes>
+template <typename Predicate, typename OutputIt>
+OutputIt basic_inplace_string_column<N, CharT, Traits, Prefixes>::filter(Predicate pred, OutputIt out) const
+{
+	for (size_type i = 0, count = size(); i != count; ++i)
+		if (pred(operator[](i)))
+			*out++ = i;
+
+	return out;
+}
+
+template <std::size_t N> using inplace_string_column = basic_inplace_string_column<N, char>;
+template <std::size_t N> using inplace_string_prefix_column = basic_inplace_string_column<N, char, std::char_traits<char>, true>;
@@ -0,0 +1,159 @@
+#pragma once
+
+#include "inplace_string.h"
+#include "inplace_flat_map.h"
+
+#include <cstdint>
+#include <vector>
+#include <limits>
+
+// Maps strings to dense 32-bit ids: the first interned string gets 0, the next new one 1, and so on. Ids never
+// change, and the reverse lookup is an index into a contiguous array of the interned strings.
+// Threading: interning is meant for a warm-up phase, from one thread. freeze() then makes the interner
+// read-only: from that point, every member can be called concurrently, and intern() of a string that is not
+// already known throws std::logic_error instead of inserting it.
+template <typename String>
+class basic_inplace_string_interner
+{
+	static_assert(detail::is_inplace_string<String>::value, "basic_inplace_string_interner: String must be a basic_inplace_string");
+
+public:
+	using string_type = String;
+	using id_type = std::uint32_t;
+	using size_type = std::size_t;
+	using const_iterator = typename std::vector<String>::const_iterator;
+	using string_view_type = basic_string_view<typename String::value_type, typename String::traits_type>;
+
+	static constexpr const id_type invalid_id = std::numeric_limits<id_type>::max();
+
+private:
+	template <typename K>
+	using if_view = typename std::enable_if<std::is_convertible<const K&, string_view_type>::value
+											&& !std::is_same<K, String>::value>::type;
+
+public:
+	basic_inplace_string_interner() = default;
+	explicit basic_inplace_string_interner(size_type capacity);
+
+	id_type intern(const String& str);
+
+	template <typename K, typename X = if_view<K>>
+	id_type intern(const K& str);
+
+	// invalid_id when the string is not interned
+	id_type find(const String& str) const noexcept;
+
+	template <typename K, typename X = if_view<K>>
+	id_type find(const K& str) const noexcept;
+
+	bool contains(const String& str) const noexcept { return find(str) != invalid_id; }
+
+	template <typename K, typename X = if_view<K>>
+	bool contains(const K& str) const noexcept { return find(str) != invalid_id; }
+
+	const String& operator[](id_type id) const noexcept { assert(id < _strings.size()); return _strings[id]; }
+	const String& at(id_type id) const;
+
+	const String* data() const noexcept { return _strings.data(); }
+	size_type size() const noexcept { return _strings.size(); }
+	bool empty() const noexcept { return _strings.empty(); }
+
+	const_iterator begin() const noexcept { return _strings.begin(); }
+	const_iterator end() const noexcept { return _strings.end(); }
+
+	void reserve(size_type capacity);
+
+	void freeze() noexcept { _frozen = true; }
+	bool frozen() const noexcept { return _frozen; }
+
+private:
+	inplace_flat_map<String, id_type> _ids;
+	std::vector<String> _strings;
+	bool _frozen = false;
+};
+
+template <typename String>
+basic_inplace_string_interner<String>::basic_inplace_string_interner(size_type capacity)
+{
+	reserve(capacity);
+}
+
+template <typename String>
+typename basic_inplace_string_interner<String>::id_type
+basic_inplace_string_interner<String>::intern(const String& str)
+{
+	if (_frozen)
+	{
+		const id_type id = find(str);
+		if (id == invalid_id)
+			detail::throw_helper<std::logic_error>("basic_inplace_string_interner::intern: new string in a frozen interner");
+		return id;
+	}
+
+	if (_strings.size() == invalid_id)
+		detail::throw_helper<std::length_error>("basic_inplace_string_interner::intern: exceed maximum number of ids");
+
+	const auto res = _ids.try_emplace(str, static_cast<id_type>(_strings.size()));
+	if (res.second)
+	{
+		// The id must not outlive a failed insertion in _strings
+		try
+		{
+			_strings.push_back(str);
+		}
+		catch (...)
+		{
+			_ids.erase(res.first);
+			throw;
+		}
+	}
+
+	return res.first->second;
+}
+
+template <typename String>
+template <typename K, typename X>
+typename basic_inplace_string_interner<String>::id_type
+basic_inplace_string_interner<String>::intern(const K& s)
+{
+	const string_view_type str = s;
+	if (str.size() > String::max_size())
+		detail::throw_helper<std::length_error>("basic_inplace_string_interner::intern: exceed maximum string length");
+
+	return intern(String(str));
+}
+
+template <typename String>
+typename basic_inplace_string_interner<String>::id_type
+basic_inplace_string_interner<String>::find(const String& str) const noexcept
+{
+	const auto it = _ids.find(str);
+	return it != _ids.end() ? it->second : invalid_id;
+}
+
+template <typename String>
+template <typename K, typename X>
+typename basic_inplace_string_interner<String>::id_type
+basic_inplace_string_interner<String>::find(const K& str) const noexcept
+{
+	const auto it = _ids.find(str);
+	return it != _ids.end() ? it->second : invalid_id;
+}
+
+template <typename String>
+const String& basic_inplace_string_interner<String>::at(id_type id) const
+{
+	if (id >= _strings.size())
+		detail::throw_helper<std::out_of_range>("basic_inplace_string_interner::at: out of range");
+
+	return _strings[id];
+}
+
+template <typename String>
+void basic_inplace_string_interner<String>::reserve(size_type capacity)
+{
+	_ids.reserve(capacity);
+	_strings.reserve(capacity);
+}
+
+template <std::size_t N> using inplace_string_interner = basic_inplace_string_interner<inplace_string<N>>;
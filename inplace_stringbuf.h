@@ -0,0 +1,205 @@
+#pragma once
+
+#include "inplace_string.h"
+
+#include <streambuf>
+#include <istream>
+#include <ostream>
+#include <limits>
+
+// Stream buffer writing into, and reading from, the storage of a basic_inplace_string: operator<< formats
+// straight into the string, without the heap buffer of a std::basic_stringbuf. Output is appended to the
+// initial contents of the string. Input reads the characters written so far.
+// When the string is full, the overflow policy of the string decides: throw_exception drops the write that
+// does not fit and the stream sets badbit, truncate drops the characters that do not fit and the stream stays
+// good, saturate also raises overflowed() on the string, and terminate calls std::terminate.
+template <std::size_t N,
+		  typename CharT = char,
+		  typename Traits = std::char_traits<CharT>,
+		  typename Policy = inplace_string_default_policy>
+class basic_inplace_stringbuf : public std::basic_streambuf<CharT, Traits>
+{
+public:
+	using char_type = CharT;
+	using traits_type = Traits;
+	using int_type = typename Traits::int_type;
+	using pos_type = typename Traits::pos_type;
+	using off_type = typename Traits::off_type;
+	using string_type = basic_inplace_string<N, CharT, Traits, Policy>;
+	using string_view_type = basic_string_view<CharT, Traits>;
+
+	basic_inplace_stringbuf() { reset(); }
+	explicit basic_inplace_stringbuf(const string_type& str) : _str(str) { reset(); }
+
+	// The get and put areas point into the buffer itself
+	basic_inplace_stringbuf(const basic_inplace_stringbuf&) = delete;
+	basic_inplace_stringbuf& operator=(const basic_inplace_stringbuf&) = delete;
+
+	string_type str() const;
+	void str(const string_type& str);
+
+	// The characters written so far, without copying them
+	string_view_type view() const noexcept { return string_view_type(_str.data(), static_cast<std::size_t>(this->pptr() - _str.data())); }
+
+protected:
+	int_type overflow(int_type c) override;
+	std::streamsize xsputn(const char_type* s, std::streamsize count) override;
+	int_type underflow() override;
+
+private:
+	void reset() noexcept;
+	void advance(std::size_t count) noexcept;
+	bool put_full(char_type c);
+
+	string_type _str;
+};
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+typename basic_inplace_stringbuf<N, CharT, Traits, Policy>::string_type
+basic_inplace_stringbuf<N, CharT, Traits, Policy>::str() const
+{
+	// The copy holds the characters of the put area too, past its size
+	string_type str(_str);
+	str.commit_append(static_cast<std::size_t>(this->pptr() - this->pbase()));
+	return str;
+}
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+void basic_inplace_stringbuf<N, CharT, Traits, Policy>::str(const string_type& str)
+{
+	_str = str;
+	reset();
+}
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+typename basic_inplace_stringbuf<N, CharT, Traits, Policy>::int_type
+basic_inplace_stringbuf<N, CharT, Traits, Policy>::overflow(int_type c)
+{
+	if (Traits::eq_int_type(c, Traits::eof()))
+		return Traits::not_eof(c);
+
+	if (this->pptr() != this->epptr())
+	{
+		*this->pptr() = Traits::to_char_type(c);
+		this->pbump(1);
+		return c;
+	}
+
+	return put_full(Traits::to_char_type(c)) ? c : Traits::eof();
+}
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+std::streamsize basic_inplace_stringbuf<N, CharT, Traits, Policy>::xsputn(const char_type* s, std::streamsize count)
+{
+	const std::streamsize room = this->epptr() - this->pptr();
+	if (count > room && Policy::overflow == inplace_string_overflow::throw_exception)
+		return 0;
+
+	const std::streamsize n = std::min(count, room);
+	Traits::copy(this->pptr(), s, static_cast<std::size_t>(n));
+	advance(static_cast<std::size_t>(n));
+
+	if (n != count)
+		put_full(s[n]);
+
+	return count;
+}
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+typename basic_inplace_stringbuf<N, CharT, Traits, Policy>::int_type
+basic_inplace_stringbuf<N, CharT, Traits, Policy>::underflow()
+{
+	// Extend the get area to the characters written since
+	if (this->pptr() > this->egptr())
+		this->setg(this->eback(), this->gptr(), this->pptr());
+
+	return this->gptr() != this->egptr() ? Traits::to_int_type(*this->gptr()) : Traits::eof();
+}
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+void basic_inplace_stringbuf<N, CharT, Traits, Policy>::reset() noexcept
+{
+	const auto span = _str.prepare_append();
+	this->setg(_str.data(), _str.data(), span.data);
+	this->setp(span.data, span.data + span.size);
+}
+
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+void basic_inplace_stringbuf<N, CharT, Traits, Policy>::advance(std::size_t count) noexcept
+{
+	// pbump takes an int, capacities go up to 2^32 - 1
+	for (; count > static_cast<std::size_t>(std::numeric_limits<int>::max()); count -= std::numeric_limits<int>::max())
+		this->pbump(std::numeric_limits<int>::max());
+
+	this->pbump(static_cast<int>(count));
+}
+
+// The put area is full: the string applies its overflow policy to c. false when the write fails.
+template <std::size_t N, typename CharT, typename Traits, typename Policy>
+bool basic_inplace_stringbuf<N, CharT, Traits, Policy>::put_full(char_type c)
+{
+	if (Policy::overflow == inplace_string_overflow::throw_exception)
+		return false;
+
+	_str.commit_append(static_cast<std::size_t>(this->pptr() - this->pbase()));
+	this->setp(this->pptr(), this->pptr());
+	_str.push_back(c);
+	return true;
+}
+
+// Output stream formatting into a basic_inplace_string, through a basic_inplace_stringbuf
+template <std::size_t N,
+		  typename CharT = char,
+		  typename Traits = std::char_traits<CharT>,
+		  typename Policy = inplace_string_default_policy>
+class basic_inplace_ostringstream : public std::basic_ostream<CharT, Traits>
+{
+public:
+	using stringbuf_type = basic_inplace_stringbuf<N, CharT, Traits, Policy>;
+	using string_type = typename stringbuf_type::string_type;
+	using string_view_type = typename stringbuf_type::string_view_type;
+
+	basic_inplace_ostringstream() : std::basic_ostream<CharT, Traits>(nullptr) { std::basic_ios<CharT, Traits>::rdbuf(&_buf); }
+	explicit basic_inplace_ostringstream(const string_type& str) : std::basic_ostream<CharT, Traits>(nullptr), _buf(str) { std::basic_ios<CharT, Traits>::rdbuf(&_buf); }
+
+	stringbuf_type* rdbuf() const noexcept { return const_cast<stringbuf_type*>(&_buf); }
+
+	string_type str() const { return _buf.str(); }
+	void str(const string_type& str) { _buf.str(str); }
+	string_view_type view() const noexcept { return _buf.view(); }
+
+private:
+	stringbuf_type _buf;
+};
+
+// Input stream reading a basic_inplace_string, through a basic_inplace_stringbuf
+template <std::size_t N,
+		  typename CharT = char,
+		  typename Traits = std::char_traits<CharT>,
+		  typename Policy = inplace_string_default_policy>
+class basic_inplace_istringstream : public std::basic_istream<CharT, Traits>
+{
+public:
+	using stringbuf_type = basic_inplace_stringbuf<N, CharT, Traits, Policy>;
+	using string_type = typename stringbuf_type::string_type;
+	using string_view_type = typename stringbuf_type::string_view_type;
+
+	basic_inplace_istringstream() : std::basic_istream<CharT, Traits>(nullptr) { std::basic_ios<CharT, Traits>::rdbuf(&_buf); }
+	explicit basic_inplace_istringstream(const string_type& str) : std::basic_istream<CharT, Traits>(nullptr), _buf(str) { std::basic_ios<CharT, Traits>::rdbuf(&_buf); }
+
+	stringbuf_type* rdbuf() const noexcept { return const_cast<stringbuf_type*>(&_buf); }
+
+	string_type str() const { return _buf.str(); }
+	void str(const string_type& str) { _buf.str(str); }
+	string_view_type view() const noexcept { return _buf.view(); }
+
+private:
+	stringbuf_type _buf;
+};
+
+template <std::size_t N, typename Policy = inplace_string_default_policy> using inplace_stringbuf = basic_inplace_stringbuf<N, char, std::char_traits<char>, Policy>;
+template <std::size_t N, typename Policy = inplace_string_default_policy> using inplace_wstringbuf = basic_inplace_stringbuf<N, wchar_t, std::char_traits<wchar_t>, Policy>;
+template <std::size_t N, typename Policy = inplace_string_default_policy> using inplace_ostringstream = basic_inplace_ostringstream<N, char, std::char_traits<char>, Policy>;
+template <std::size_t N, typename Policy = inplace_string_default_policy> using inplace_wostringstream = basic_inplace_ostringstream<N, wchar_t, std::char_traits<wchar_t>, Policy>;
+template <std::size_t N, typename Policy = inplace_string_default_policy> using inplace_istringstream = basic_inplace_istringstream<N, char, std::char_traits<char>, Policy>;
+template <std::size_t N, typename Policy = inplace_string_default_policy> using inplace_wistringstream = basic_inplace_istringstream<N, wchar_t, std::char_traits<wchar_t>, Policy>;
@@ -1,8 +1,22 @@
 #include "inplace_string.h"
+#include "inplace_flat_map.h"
+#include "inplace_string_interner.h"
+#include "inplace_string_column.h"
+#include "inplace_string_algorithm.h"
+#include "inplace_stringbuf.h"
 
 #include <gtest/gtest.h>
 
 #include <fstream>
+#include <set>
+#include <unordered_set>
+#include <unordered_map>
+#include <thread>
+#include <list>
+#include <deque>
+#include <sstream>
+#include <iomanip>
+#include <iterator>
 
 using my_string = inplace_string<31>;
 
@@ -183,6 +197,125 @@ TEST(inplace_string, big_inplace_string)
 	}
 }
 
+template <typename String>
+static void check_size_trailer(std::size_t sizeof_expected)
+{
+	EXPECT_EQ(sizeof_expected, sizeof(String));
+
+	String s;
+	EXPECT_TRUE(s.empty());
+	EXPECT_EQ(0u, s.size());
+
+	const std::string line(String::max_size(), 'x');
+	s.append("8=FIX.4.4|35=D|");
+	EXPECT_EQ(15u, s.size());
+	EXPECT_EQ(10u, s.find("35"));
+
+	s = String(line.data(), line.size() - 1);
+	EXPECT_EQ(line.size() - 1, s.size());
+	s.push_back('y');
+	EXPECT_EQ(String::max_size(), s.size());
+	if (String::policy_type::null_terminated)
+	{
+		EXPECT_EQ('\0', s.data()[s.size()]);
+	}
+	EXPECT_THROW(s.push_back('z'), std::length_error);
+
+	s.erase(0, String::max_size() - 3);
+	EXPECT_EQ("xxy", s);
+	const std::size_t half = String::max_size() / 2;
+	s.insert(std::size_t(0), half, '-');
+	EXPECT_EQ(half + 3, s.size());
+	EXPECT_EQ(half, s.find('x'));
+
+	String t(s);
+	EXPECT_EQ(s, t);
+	EXPECT_EQ(std::hash<String>()(s), std::hash<String>()(t));
+	t.pop_back();
+	EXPECT_NE(s, t);
+	EXPECT_LT(t, s);
+	t.swap(s);
+	EXPECT_EQ(half + 2, s.size());
+	EXPECT_EQ(half + 3, t.size());
+}
+
+// The size lives in the last character up to 255 characters, in a 16- or 32-bit trailer above
+TEST(inplace_string, size_trailer)
+{
+	using trailer_policy = inplace_string_size_trailer_policy;
+
+	check_size_trailer<inplace_string<255>>(256);
+	check_size_trailer<basic_inplace_string<255, char, std::char_traits<char>, trailer_policy>>(258);
+	check_size_trailer<inplace_string<4096>>(4099);
+	check_size_trailer<zero_padded_inplace_string<4096>>(4099);
+	check_size_trailer<inplace_string<70000>>(70005);
+
+	// Embedded zeros: the trailer tells apart strings with the same characters
+	zero_padded_inplace_string<300> a(string_view("ab\0", 3)), b("ab");
+	EXPECT_NE(a, b);
+	EXPECT_NE(std::hash<zero_padded_inplace_string<300>>()(a), std::hash<zero_padded_inplace_string<300>>()(b));
+
+	basic_inplace_string<15, char, std::char_traits<char>, trailer_policy> small("FIX");
+	EXPECT_EQ(18u, sizeof(small));
+	EXPECT_EQ(3u, small.size());
+	EXPECT_EQ("FIX", small);
+	EXPECT_EQ(inplace_u16string<300>(u"wide"), u"wide");
+}
+
+struct unterminated_zero_padded_policy : inplace_string_zero_padded_policy
+{
+	static constexpr bool null_terminated = false;
+};
+
+// Without terminator: the same footprint, mutations leave the character past the end alone
+TEST(inplace_string, unterminated)
+{
+	using field = unterminated_inplace_string<7>;
+	static_assert(sizeof(field) == sizeof(inplace_string<7>), "same footprint");
+
+	field s("AAPL");
+	EXPECT_EQ(4u, s.size());
+	EXPECT_EQ("AAPL", string_view(s));
+	s.append("XYZ");
+	EXPECT_EQ(field::max_size(), s.size());
+	EXPECT_EQ("AAPLXYZ", s);
+	EXPECT_THROW(s.push_back('!'), std::length_error);
+
+	s.pop_back();
+	EXPECT_EQ("AAPLXY", s);
+	EXPECT_EQ('Z', s.data()[6]);
+	s.erase(1, 3);
+	EXPECT_EQ("AXY", s);
+	s.insert(1, "AP");
+	EXPECT_EQ("AAPXY", s);
+	s.replace(3, 2, "L");
+	EXPECT_EQ("AAPL", s);
+	s.resize(6, '.');
+	EXPECT_EQ("AAPL..", s);
+
+	EXPECT_EQ(field("AAPL.."), s);
+	EXPECT_EQ(std::hash<field>()(field("AAPL..")), std::hash<field>()(s));
+	EXPECT_EQ(std::string("AAPL.."), std::string(string_view(s)));
+	std::ostringstream oss;
+	oss << s;
+	EXPECT_EQ("AAPL..", oss.str());
+
+	s.clear();
+	EXPECT_TRUE(s.empty());
+
+	// With a trailer, the size starts right after the characters
+	using line = unterminated_inplace_string<300>;
+	EXPECT_EQ(302u, sizeof(line));
+	check_size_trailer<line>(302);
+
+	using padded = basic_inplace_string<300, char, std::char_traits<char>, unterminated_zero_padded_policy>;
+	padded a(string_view("ab\0", 3)), b("ab");
+	EXPECT_NE(a, b);
+	EXPECT_NE(std::hash<padded>()(a), std::hash<padded>()(b));
+	a.pop_back();
+	EXPECT_EQ(b, a);
+}
+
 TEST(inplace_string, at)
 {
 	my_string s("foobar");
@@ -1003,15 +1136,67 @@ TEST(inplace_string, replace)
 		EXPECT_EQ("FOOBAR", std::string(s.c_str()));
 	}
 	{
+		// As std::string, count is clamped to the characters after pos
 		my_string s = "foobar";
 		EXPECT_NO_THROW(s.replace(std::size_t(6), 6, std::string("FOOBAR")));
-		EXPECT_EQ("foobar", std::string(s.c_str()));
+		EXPECT_EQ("foobarFOOBAR", std::string(s.c_str()));
+	}
+	{
+		using view = basic_string_view<char, std::char_traits<char>>;
+		const std::size_t npos = inplace_string<7>::npos;
+
+		inplace_string<7> s = "hello";
+		s.replace(3, npos, view("XY"));
+		EXPECT_EQ("helXY", s);
+		s = "hello";
+		s.replace(3, 10, "XY", 2);
+		EXPECT_EQ("helXY", s);
+		s = "hello";
+		s.replace(3, npos, 4, 'z');
+		EXPECT_EQ("helzzzz", s);
+
+		s = "hello";
+		EXPECT_THROW(s.replace(3, 5, "ABCDEFG", 7), std::length_error);
+		EXPECT_THROW(s.replace(3, npos, view("ABCDEFG")), std::length_error);
+		EXPECT_THROW(s.replace(0, npos, 8, 'z'), std::length_error);
+		EXPECT_EQ("hello", s);
+
+		truncating_inplace_string<7> t = "hello";
+		t.replace(3, npos, view("ABCDEFG"));
+		EXPECT_EQ("helABCD", t);
+		t = "hello";
+		t.replace(3, 5, "ABCDEFG", 7);
+		EXPECT_EQ("helABCD", t);
+		t = "hello";
+		t.replace(1, 10, 9, 'z');
+		EXPECT_EQ("hzzzzzz", t);
+		t = "hello";
+		t.replace(3, npos, "XY", 2);
+		EXPECT_EQ("helXY", t);
 	}
 	{
 		my_string s = "foobar";
 		EXPECT_THROW(s.replace(std::size_t(7), 1, std::string("FOOBAR")), std::out_of_range);
 		EXPECT_EQ(6, s.size());
 	}
+	{
+		// Only the characters after the replaced range are moved: the storage that follows is untouched
+		struct guarded
+		{
+			my_string s;
+			char guard[16];
+		} g;
+		g.s = my_string(28, 'a');
+		std::fill(std::begin(g.guard), std::end(g.guard), '#');
+
+		g.s.replace(0, 5, "ABCDEFG", 7);
+		EXPECT_EQ("ABCDEFG" + std::string(23, 'a'), std::string(g.s.c_str()));
+		g.s.replace(1, 3, "XY", 2);
+		EXPECT_EQ("AXYEFG" + std::string(23, 'a'), std::string(g.s.c_str()));
+		g.s.replace(26, 3, "XYZ", 3);
+		EXPECT_EQ("AXYEFG" + std::string(20, 'a') + "XYZ", std::string(g.s.c_str()));
+		EXPECT_EQ(std::string(16, '#'), std::string(g.guard, sizeof(g.guard)));
+	}
 	{
 		std::string str("FOOBARBAZ");
 		my_string s = "foobar";
@@ -1149,6 +1334,437 @@ TEST(inplace_string, resize)
 	EXPECT_THROW(s.resize(my_string::max_size() + 1), std::length_error);
 }
 
+TEST(inplace_string, resize_and_overwrite)
+{
+	my_string s("foobar");
+	s.resize_and_overwrite(10, [](char* buf, std::size_t n) {
+		EXPECT_EQ(10, n);
+		EXPECT_EQ("foobar", std::string(buf, 6));
+		std::memcpy(buf + 6, "baz!", 4);
+		return n - 1;
+	});
+	EXPECT_EQ("foobarbaz", s);
+	EXPECT_EQ("foobarbaz", std::string(s.c_str()));
+
+	s.resize_and_overwrite(3, [](char* buf, std::size_t) { buf[0] = 'F'; return 2; });
+	EXPECT_EQ("Fo", s);
+
+	EXPECT_THROW(s.resize_and_overwrite(my_string::max_size() + 1, [](char*, std::size_t n) { return n; }), std::length_error);
+	EXPECT_EQ("Fo", s);
+
+	truncating_inplace_string<7> t;
+	t.resize_and_overwrite(20, [](char* buf, std::size_t n) { std::memset(buf, 'x', n); return n; });
+	EXPECT_EQ("xxxxxxx", t);
+
+	zero_padded_inplace_string<15> z("foobar");
+	z.resize_and_overwrite(12, [](char* buf, std::size_t n) { std::memset(buf, 'x', n); return 4; });
+	EXPECT_EQ("xxxx", z);
+	EXPECT_EQ(z, zero_padded_inplace_string<15>("xxxx"));
+	for (std::size_t i = z.size(); i != z.max_size(); ++i)
+		EXPECT_EQ('\0', z.data()[i]);
+}
+
+TEST(inplace_string, prepare_append)
+{
+	my_string s("foo");
+	my_string::write_span span = s.prepare_append();
+	EXPECT_EQ(s.data() + 3, span.data);
+	EXPECT_EQ(my_string::max_size() - 3, span.size);
+
+	std::memcpy(span.data, "barbaz", 6);
+	s.commit_append(3);
+	EXPECT_EQ("foobar", s);
+	EXPECT_EQ("foobar", std::string(s.c_str()));
+
+	span = s.prepare_append();
+	std::memset(span.data, 'x', span.size);
+	s.commit_append(span.size);
+	EXPECT_EQ(my_string::max_size(), s.size());
+	EXPECT_EQ(0, s.prepare_append().size);
+
+	zero_padded_inplace_string<15> z("foo");
+	auto zspan = z.prepare_append();
+	std::memcpy(zspan.data, "barbaz", 6);
+	z.commit_append(3);
+	EXPECT_EQ(z, zero_padded_inplace_string<15>("foobar"));
+	for (std::size_t i = z.size(); i != z.max_size(); ++i)
+		EXPECT_EQ('\0', z.data()[i]);
+
+	cached_hash_inplace_string<15> h("foo");
+	const std::size_t foo_hash = std::hash<cached_hash_inplace_string<15>>()(h);
+	auto hspan = h.prepare_append();
+	hspan.data[0] = '!';
+	h.commit_append(1);
+	EXPECT_NE(foo_hash, std::hash<cached_hash_inplace_string<15>>()(h));
+	EXPECT_EQ(std::hash<cached_hash_inplace_string<15>>()(cached_hash_inplace_string<15>("foo!")),
+			  std::hash<cached_hash_inplace_string<15>>()(h));
+}
+
+TEST(inplace_string, append_number)
+{
+	my_string s("ORD-");
+	append_number(s, 123456);
+	EXPECT_EQ("ORD-123456", s);
+	EXPECT_EQ("ORD-123456", std::string(s.c_str()));
+
+	append_number(append_number(s.append(" "), -42).append(" "), std::numeric_limits<std::uint32_t>::max());
+	EXPECT_EQ("ORD-123456 -42 4294967295", s);
+
+	s.clear();
+	append_number(s, std::numeric_limits<std::int64_t>::min());
+	EXPECT_EQ("-9223372036854775808", s);
+
+	inplace_string<7> small("px=");
+	EXPECT_THROW(append_number(small, 12345), std::length_error);
+	EXPECT_EQ("px=", small);
+	append_number(small, 1234);
+	EXPECT_EQ("px=1234", small);
+
+	truncating_inplace_string<7> truncated("px=");
+	append_number(truncated, 123456);
+	EXPECT_EQ("px=1234", truncated);
+
+	zero_padded_inplace_string<15> padded;
+	append_number(padded, 7);
+	EXPECT_EQ(padded, zero_padded_inplace_string<15>("7"));
+
+	inplace_u16string<15> wide(u"qty=");
+	append_number(wide, 100u);
+	EXPECT_EQ(u"qty=100", wide);
+
+#if defined __cpp_lib_to_chars
+	s = "px=";
+	append_number(s, 187.25);
+	EXPECT_EQ("px=187.25", s);
+
+	s.clear();
+	append_number(s, 0.1f);
+	EXPECT_EQ("0.1", s);
+#endif
+}
+
+TEST(inplace_string, to_inplace_string)
+{
+	static_assert(detail::max_chars<int>::value == 11 && detail::max_chars<std::uint64_t>::value == 20, "digits and sign");
+	static_assert(std::is_same<decltype(to_inplace_string(0)), inplace_string<15>>::value, "sign and 10 digits");
+	static_assert(std::is_same<decltype(to_inplace_string(std::uint64_t{})), inplace_string<23>>::value, "20 digits");
+	static_assert(std::is_same<decltype(to_inplace_string<31>(0)), inplace_string<31>>::value, "explicit capacity");
+	static_assert(std::is_same<decltype(to_inplace_string<15, char16_t>(0)), inplace_u16string<15>>::value, "wide");
+
+	EXPECT_EQ("-2147483648", to_inplace_string(std::numeric_limits<int>::min()));
+	EXPECT_EQ("255", to_inplace_string(static_cast<unsigned char>(255)));
+	EXPECT_EQ(u"42", (to_inplace_string<15, char16_t>(42)));
+
+	const inplace_string<19> label = "ORD-" + to_inplace_string(123456);
+	EXPECT_EQ("ORD-123456", label);
+
+#if defined __cpp_lib_to_chars
+	static_assert(detail::max_chars<double>::value == 24 && detail::max_chars<float>::value == 15, "longest values");
+	static_assert(std::is_same<decltype(to_inplace_string(0.0)), inplace_string<31>>::value, "longest double");
+	EXPECT_EQ("-2.2250738585072014e-308", to_inplace_string(-std::numeric_limits<double>::min()));
+	EXPECT_EQ("-1.7976931348623157e+308", to_inplace_string(-std::numeric_limits<double>::max()));
+	EXPECT_EQ("-5e-324", to_inplace_string(-std::numeric_limits<double>::denorm_min()));
+	EXPECT_EQ("-1.1754944e-38", to_inplace_string(-std::numeric_limits<float>::min()));
+	EXPECT_EQ("187.25", to_inplace_string(187.25));
+#endif
+}
+
+TEST(inplace_string, inplace_format)
+{
+	const inplace_string<7> symbol("AAPL");
+	EXPECT_EQ("NEW AAPL qty=100 px=187.25 side=B", inplace_format<63>("NEW {} qty={} px={} side={}", symbol, 100, 187.25, 'B'));
+	EXPECT_EQ("{42} }{", inplace_format<15>("{{{}}} }}{{", 42));
+	EXPECT_EQ("no placeholder", inplace_format<15>("no placeholder"));
+	EXPECT_EQ("unused", inplace_format<15>("unused", 1, 2));
+
+	my_string s("id=");
+	inplace_format_to(s, "{}-{}", std::string("ORD"), std::numeric_limits<std::int64_t>::min());
+	EXPECT_EQ("id=ORD--9223372036854775808", s);
+	EXPECT_EQ("id=ORD--9223372036854775808", std::string(s.c_str()));
+
+	// Arguments bounding the message within the room left: written without capacity checks
+	inplace_format_to(s.erase(3), "{}{}", static_cast<std::int16_t>(-12345), inplace_string<7>("XNAS"));
+	EXPECT_EQ("id=-12345XNAS", s);
+
+	inplace_string<7> small;
+	EXPECT_THROW(inplace_format_to(small, "{} {}", "long", "message"), std::length_error);
+	EXPECT_THROW(inplace_format_to(small, "{}", 12345678), std::length_error);
+
+	truncating_inplace_string<7> truncated;
+	inplace_format_to(truncated, "{}={}", "px", 187.25);
+	EXPECT_EQ("px=187.", truncated);
+
+	zero_padded_inplace_string<15> padded("xxxxxxxxxxxxxxx");
+	padded.clear();
+	inplace_format_to(padded, "{}", 7);
+	EXPECT_EQ(padded, zero_padded_inplace_string<15>("7"));
+
+	EXPECT_EQ(L"qty=100 px=1.5 x", (inplace_format<31, wchar_t>(L"qty={} px={} {}", 100, 1.5, 'x')));
+	EXPECT_EQ(u"ABC-7", (inplace_format<15, char16_t>(u"{}-{}", inplace_u16string<7>(u"ABC"), 7)));
+
+#if INPLACE_STRING_HAS_CONSTEVAL
+	constexpr inplace_format_string<int, inplace_string<7>, char, const char*> bounded("id={} sym={}"), unbounded("id={} sym={} {} {}");
+	static_assert(bounded.max_size() == 11 + 7 + 8, "11 for an int, 7 for the string, 8 for the literal");
+	static_assert(unbounded.max_size() == std::size_t(-1), "no bound for a const char*");
+#else
+	EXPECT_THROW(inplace_format<15>("{} {}", 1), std::invalid_argument);
+	EXPECT_THROW(inplace_format<15>("{", 1), std::invalid_argument);
+	EXPECT_THROW(inplace_format<15>("{:x}", 1), std::invalid_argument);
+	EXPECT_THROW(inplace_format<15>("}", 1), std::invalid_argument);
+#endif
+}
+
+TEST(inplace_string, parse_uint)
+{
+	std::uint64_t u64 = 7;
+	EXPECT_EQ(std::errc{}, parse_uint(my_string("0"), u64));
+	EXPECT_EQ(0u, u64);
+	EXPECT_EQ(std::errc{}, parse_uint(my_string("123456789012"), u64));
+	EXPECT_EQ(123456789012u, u64);
+	EXPECT_EQ(std::errc{}, parse_uint(my_string("18446744073709551615"), u64));
+	EXPECT_EQ(std::numeric_limits<std::uint64_t>::max(), u64);
+	EXPECT_EQ(std::errc::result_out_of_range, parse_uint(my_string("18446744073709551616"), u64));
+	EXPECT_EQ(std::errc::result_out_of_range, parse_uint(my_string("100000000000000000000"), u64));
+	EXPECT_EQ(std::numeric_limits<std::uint64_t>::max(), u64);
+
+	EXPECT_EQ(std::errc::invalid_argument, parse_uint(my_string(""), u64));
+	EXPECT_EQ(std::errc::invalid_argument, parse_uint(my_string("-1"), u64));
+	EXPECT_EQ(std::errc::invalid_argument, parse_uint(my_string(" 1"), u64));
+	EXPECT_EQ(std::errc::invalid_argument, parse_uint(my_string("1234567/"), u64));
+	EXPECT_EQ(std::errc::invalid_argument, parse_uint(my_string("12345678:"), u64));
+	EXPECT_EQ(std::errc::invalid_argument, parse_uint(my_string("1234:678"), u64));
+	EXPECT_EQ(std::errc::invalid_argument, parse_uint(my_string("1234567890123456x"), u64));
+
+	// Every position of a non-digit in the SWAR chunks and the tail
+	for (std::size_t i = 0; i != 20; ++i)
+	{
+		for (const char c : {'/', ':', 'a', ' ', '\0', '\x80'})
+		{
+			my_string field(20, '1');
+			field[i] = c;
+			EXPECT_EQ(std::errc::invalid_argument, parse_uint(field, u64)) << i << ' ' << int(c);
+		}
+	}
+
+	std::uint8_t u8 = 0;
+	EXPECT_EQ(std::errc{}, parse_uint(inplace_string<3>("255"), u8));
+	EXPECT_EQ(255, u8);
+	EXPECT_EQ(std::errc::result_out_of_range, parse_uint(inplace_string<3>("256"), u8));
+
+	unsigned u = 0;
+	EXPECT_EQ(std::errc{}, parse_uint(inplace_u16string<15>(u"4294967295"), u));
+	EXPECT_EQ(4294967295u, u);
+	EXPECT_EQ(std::errc::invalid_argument, parse_uint(inplace_u16string<15>(u"42٠"), u));
+}
+
+TEST(inplace_string, parse_int)
+{
+	int i = 0;
+	EXPECT_EQ(std::errc{}, parse_int(my_string("-2147483648"), i));
+	EXPECT_EQ(std::numeric_limits<int>::min(), i);
+	EXPECT_EQ(std::errc{}, parse_int(my_string("2147483647"), i));
+	EXPECT_EQ(std::numeric_limits<int>::max(), i);
+	EXPECT_EQ(std::errc{}, parse_int(my_string("-0"), i));
+	EXPECT_EQ(0, i);
+	EXPECT_EQ(std::errc::result_out_of_range, parse_int(my_string("2147483648"), i));
+	EXPECT_EQ(std::errc::result_out_of_range, parse_int(my_string("-2147483649"), i));
+	EXPECT_EQ(std::errc::invalid_argument, parse_int(my_string("-"), i));
+	EXPECT_EQ(std::errc::invalid_argument, parse_int(my_string("+1"), i));
+	EXPECT_EQ(std::errc::invalid_argument, parse_int(my_string("--1"), i));
+	EXPECT_EQ(0, i);
+
+	std::int64_t i64 = 0;
+	EXPECT_EQ(std::errc{}, parse_int(my_string("-9223372036854775808"), i64));
+	EXPECT_EQ(std::numeric_limits<std::int64_t>::min(), i64);
+	EXPECT_EQ(std::errc::result_out_of_range, parse_int(my_string("9223372036854775808"), i64));
+
+	std::int8_t i8 = 0;
+	EXPECT_EQ(std::errc{}, parse_int(inplace_string<7>("-128"), i8));
+	EXPECT_EQ(-128, i8);
+	EXPECT_EQ(std::errc::result_out_of_range, parse_int(inplace_string<7>("128"), i8));
+}
+
+TEST(inplace_string, parse_decimal)
+{
+	std::int64_t px = 0;
+	EXPECT_EQ(std::errc{}, parse_decimal(my_string("187.25"), px, 4));
+	EXPECT_EQ(1872500, px);
+	EXPECT_EQ(std::errc{}, parse_decimal(my_string("-0.0001"), px, 4));
+	EXPECT_EQ(-1, px);
+	EXPECT_EQ(std::errc{}, parse_decimal(my_string("42"), px, 2));
+	EXPECT_EQ(4200, px);
+	EXPECT_EQ(std::errc{}, parse_decimal(my_string("12345678.12345678"), px, 8));
+	EXPECT_EQ(1234567812345678, px);
+	EXPECT_EQ(std::errc{}, parse_decimal(my_string("7"), px, 0));
+	EXPECT_EQ(7, px);
+
+	EXPECT_EQ(std::errc::invalid_argument, parse_decimal(my_string("187.255"), px, 2));
+	EXPECT_EQ(std::errc::invalid_argument, parse_decimal(my_string("187."), px, 2));
+	EXPECT_EQ(std::errc::invalid_argument, parse_decimal(my_string(".25"), px, 2));
+	EXPECT_EQ(std::errc::invalid_argument, parse_decimal(my_string("1.2.3"), px, 2));
+	EXPECT_EQ(std::errc::invalid_argument, parse_decimal(my_string("1e5"), px, 2));
+	EXPECT_EQ(std::errc::result_out_of_range, parse_decimal(my_string("92233720368547758.08"), px, 2));
+	EXPECT_EQ(std::errc::result_out_of_range, parse_decimal(my_string("100000000000"), px, 9));
+	EXPECT_EQ(7, px);
+
+	std::uint32_t qty = 0;
+	EXPECT_EQ(std::errc{}, parse_decimal(my_string("42.5"), qty, 1));
+	EXPECT_EQ(425u, qty);
+	EXPECT_EQ(std::errc::invalid_argument, parse_decimal(my_string("-42.5"), qty, 1));
+}
+
+TEST(inplace_string, operator_extraction)
+{
+	std::istringstream iss("  AAPL\tMSFT\n\nGOOG  BRK.B");
+	my_string s("previous");
+	iss >> s;
+	EXPECT_EQ("AAPL", s);
+	EXPECT_EQ("AAPL", std::string(s.c_str()));
+	iss >> s;
+	EXPECT_EQ("MSFT", s);
+	iss >> s;
+	EXPECT_EQ("GOOG", s);
+	EXPECT_TRUE(iss.good());
+	iss >> s;
+	EXPECT_EQ("BRK.B", s);
+	EXPECT_TRUE(iss.eof());
+	EXPECT_FALSE(iss.fail());
+	iss >> s;
+	EXPECT_TRUE(iss.fail());
+
+	std::istringstream width("ABCDEFGH");
+	width >> std::setw(3) >> s;
+	EXPECT_EQ("ABC", s);
+	EXPECT_EQ(0, width.width());
+	width >> s;
+	EXPECT_EQ("DEFGH", s);
+
+	// Longer than the capacity: the stream fails and keeps the rest, or the policy drops it
+	std::istringstream overflow("ABCDEFGHIJ KL");
+	inplace_string<7> small;
+	overflow >> small;
+	EXPECT_EQ("ABCDEFG", small);
+	EXPECT_TRUE(overflow.fail());
+	overflow.clear();
+	overflow >> small;
+	EXPECT_EQ("HIJ", small);
+
+	std::istringstream truncate("ABCDEFGHIJ KL");
+	saturating_inplace_string<7> saturated;
+	truncate >> saturated;
+	EXPECT_EQ("ABCDEFG", saturated);
+	EXPECT_TRUE(saturated.overflowed());
+	EXPECT_FALSE(truncate.fail());
+	truncate >> saturated;
+	EXPECT_EQ("KL", saturated);
+
+	std::istringstream blank(" \t\n ");
+	blank >> s;
+	EXPECT_TRUE(blank.fail());
+	EXPECT_TRUE(blank.eof());
+
+	std::istringstream noskip(" word");
+	noskip >> std::noskipws >> s;
+	EXPECT_TRUE(noskip.fail());
+	EXPECT_TRUE(s.empty());
+
+	std::wistringstream wide(L" wide words");
+	inplace_wstring<7> w;
+	wide >> w;
+	EXPECT_EQ(L"wide", w);
+}
+
+namespace
+{
+
+// Stream buffer without a get area: every character goes through underflow and uflow
+class unbuffered_streambuf : public std::streambuf
+{
+public:
+	explicit unbuffered_streambuf(std::string str) : _str(std::move(str)) {}
+
+protected:
+	int_type underflow() override { return _pos < _str.size() ? traits_type::to_int_type(_str[_pos]) : traits_type::eof(); }
+	int_type uflow() override { return _pos < _str.size() ? traits_type::to_int_type(_str[_pos++]) : traits_type::eof(); }
+
+private:
+	std::string _str;
+	std::size_t _pos = 0;
+};
+
+}
+
+TEST(inplace_string, getline)
+{
+	std::istringstream iss("first line\n\nthird  line\nlast");
+	my_string s("previous");
+	EXPECT_TRUE(getline(iss, s));
+	EXPECT_EQ("first line", s);
+	EXPECT_EQ("first line", std::string(s.c_str()));
+	EXPECT_TRUE(getline(iss, s));
+	EXPECT_EQ("", s);
+	EXPECT_TRUE(getline(iss, s));
+	EXPECT_EQ("third  line", s);
+	EXPECT_TRUE(getline(iss, s));
+	EXPECT_EQ("last", s);
+	EXPECT_TRUE(iss.eof());
+	EXPECT_FALSE(getline(iss, s));
+
+	std::istringstream fields("8=FIX.4.2|35=D|");
+	EXPECT_TRUE(getline(fields, s, '|'));
+	EXPECT_EQ("8=FIX.4.2", s);
+	EXPECT_TRUE(getline(fields, s, '|'));
+	EXPECT_EQ("35=D", s);
+	EXPECT_FALSE(getline(fields, s, '|'));
+
+	// Longer than the capacity: the stream fails and keeps the rest, or the policy drops it
+	std::istringstream overflow("ABCDEFGHIJ\nKL\n");
+	inplace_string<7> small;
+	EXPECT_FALSE(getline(overflow, small));
+	EXPECT_EQ("ABCDEFG", small);
+	overflow.clear();
+	EXPECT_TRUE(getline(overflow, small));
+	EXPECT_EQ("HIJ", small);
+
+	std::istringstream truncate("ABCDEFGHIJ\nKL\n");
+	truncating_inplace_string<7> truncated;
+	EXPECT_TRUE(getline(truncate, truncated));
+	EXPECT_EQ("ABCDEFG", truncated);
+	EXPECT_TRUE(getline(truncate, truncated));
+	EXPECT_EQ("KL", truncated);
+
+	std::istringstream exact("ABCDEFG\n");
+	EXPECT_TRUE(getline(exact, small));
+	EXPECT_EQ("ABCDEFG", small);
+
+	// Lines across refills of a small file buffer
+	const std::string path = std::tmpnam(nullptr);
+	{
+		std::ofstream out(path);
+		for (int i = 0; i < 10000; ++i)
+			out << "ID" << i << '\n';
+	}
+	std::ifstream in(path);
+	char buffer[7];
+	in.rdbuf()->pubsetbuf(buffer, sizeof(buffer));
+	int count = 0;
+	for (my_string line; getline(in, line); ++count)
+		ASSERT_EQ("ID" + std::to_string(count), line);
+	EXPECT_EQ(10000, count);
+	in.close();
+	std::remove(path.c_str());
+
+	unbuffered_streambuf sb("one two\nthree");
+	std::istream unbuffered(&sb);
+	unbuffered >> s;
+	EXPECT_EQ("one", s);
+	EXPECT_TRUE(getline(unbuffered, s));
+	EXPECT_EQ(" two", s);
+	EXPECT_TRUE(getline(unbuffered, s));
+	EXPECT_EQ("three", s);
+	EXPECT_TRUE(unbuffered.eof());
+}
+
 TEST(inplace_string, swap)
 {
 	my_string s("foobar");
@@ -1175,7 +1791,9 @@ TEST(inplace_string, find)
 	EXPECT_EQ(npos, s.find("zar"));
 	EXPECT_EQ(npos, s.find("foobarz"));
 	EXPECT_EQ(npos, s.find("foofoofoofoo"));
-	EXPECT_EQ(npos, s.find(""));
+	EXPECT_EQ(0, s.find(""));
+	EXPECT_EQ(6, s.find("", 6));
+	EXPECT_EQ(npos, s.find("", 7));
 
 	EXPECT_EQ(3, s.find("bar", 1));
 	EXPECT_EQ(3, s.find("bar", 3));
@@ -1217,3 +1835,1427 @@ TEST(inplace_string, find)
 	EXPECT_EQ(npos, s.find('b', 4));
 }
 
+
+template <typename CharT>
+void check_find_against_std_string()
+{
+	using string = basic_inplace_string<255, CharT>;
+	using std_string = std::basic_string<CharT>;
+
+	// small alphabet so that first and last characters of the needle match at many positions
+	unsigned state = 42;
+	auto next_char = [&state]()
+	{
+		state = state * 1103515245u + 12345u;
+		return static_cast<CharT>('a' + (state >> 16) % 3);
+	};
+
+	for (std::size_t size = 0; size <= string::max_size(); size += 7)
+	{
+		std_string haystack;
+		for (std::size_t i = 0; i < size; ++i)
+			haystack.push_back(next_char());
+		const string s(haystack.data(), haystack.size());
+
+		for (std::size_t needle_size = 1; needle_size <= 9; ++needle_size)
+		{
+			std_string needle;
+			for (std::size_t i = 0; i < needle_size; ++i)
+				needle.push_back(next_char());
+
+			EXPECT_EQ(haystack.find(needle), s.find(needle.data(), 0, needle.size()));
+			EXPECT_EQ(haystack.find(needle, size / 3), s.find(needle.data(), size / 3, needle.size()));
+
+			if (size >= needle_size)
+			{
+				const std_string tail = haystack.substr(size - needle_size);
+				EXPECT_EQ(haystack.find(tail), s.find(tail.data(), 0, tail.size()));
+			}
+		}
+	}
+}
+
+TEST(inplace_string, find_long)
+{
+	check_find_against_std_string<char>();
+	check_find_against_std_string<wchar_t>();
+	check_find_against_std_string<char16_t>();
+	check_find_against_std_string<char32_t>();
+
+	{
+		inplace_string<255> s(200, ' ');
+		s += "XY";
+		EXPECT_EQ(198, s.find("  XY"));
+		EXPECT_EQ(inplace_string<255>::npos, s.find("  XZ"));
+		EXPECT_EQ(0, s.find("  "));
+	}
+}
+
+template <typename String>
+void check_find_char_against_std_string()
+{
+	using char_type = typename String::value_type;
+	using std_string = std::basic_string<char_type>;
+
+	for (std::size_t size = 0; size <= String::max_size(); ++size)
+	{
+		std_string str;
+		for (std::size_t i = 0; i < size; ++i)
+			str.push_back(static_cast<char_type>('a' + i % 5));
+		const String s(str.data(), str.size());
+
+		for (std::size_t pos = 0; pos <= size + 1; ++pos)
+			for (char c = 'a'; c != 'g'; ++c)
+				EXPECT_EQ(str.find(static_cast<char_type>(c), pos), s.find(static_cast<char_type>(c), pos));
+	}
+}
+
+TEST(inplace_string, find_char)
+{
+	check_find_char_against_std_string<inplace_string<7>>();
+	check_find_char_against_std_string<inplace_string<15>>();
+	check_find_char_against_std_string<inplace_string<20>>();
+	check_find_char_against_std_string<inplace_string<63>>();
+	check_find_char_against_std_string<inplace_u16string<7>>();
+	check_find_char_against_std_string<inplace_u16string<12>>();
+	check_find_char_against_std_string<inplace_u16string<31>>();
+	check_find_char_against_std_string<inplace_u32string<9>>();
+	check_find_char_against_std_string<inplace_wstring<17>>();
+
+	// characters left past the end by a shorter string must not match
+	my_string s("foobar");
+	s.resize(3);
+	EXPECT_EQ(my_string::npos, s.find('b'));
+	EXPECT_EQ(my_string::npos, s.find('r'));
+}
+
+TEST(inplace_string, rfind)
+{
+	my_string s("foobarfoobar");
+	const my_string::size_type npos = my_string::npos;
+
+	EXPECT_EQ(6, s.rfind("foo"));
+	EXPECT_EQ(6, s.rfind("foo", 6));
+	EXPECT_EQ(0, s.rfind("foo", 5));
+	EXPECT_EQ(0, s.rfind("foo", 4));
+	EXPECT_EQ(9, s.rfind("bar"));
+	EXPECT_EQ(npos, s.rfind("baz"));
+	EXPECT_EQ(npos, s.rfind("foobarfoobarfoobar"));
+	EXPECT_EQ(12, s.rfind(""));
+	EXPECT_EQ(3, s.rfind("", 3));
+	EXPECT_EQ(3, s.rfind("barbaz", 8, 3));
+	EXPECT_EQ(9, s.rfind(std::string("bar")));
+	EXPECT_EQ(9, s.rfind(string_view("bar")));
+	EXPECT_EQ(3, s.rfind(my_string("bar"), 8));
+
+	EXPECT_EQ(11, s.rfind('r'));
+	EXPECT_EQ(5, s.rfind('r', 10));
+	EXPECT_EQ(5, s.rfind('r', 5));
+	EXPECT_EQ(npos, s.rfind('r', 4));
+	EXPECT_EQ(npos, s.rfind('z'));
+	EXPECT_EQ(npos, my_string().rfind('z'));
+}
+
+TEST(inplace_string, find_first_of)
+{
+	my_string s("foo bar;baz");
+	const my_string::size_type npos = my_string::npos;
+
+	EXPECT_EQ(3, s.find_first_of(" ;"));
+	EXPECT_EQ(7, s.find_first_of(" ;", 4));
+	EXPECT_EQ(npos, s.find_first_of(" ;", 8));
+	EXPECT_EQ(npos, s.find_first_of(""));
+	EXPECT_EQ(3, s.find_first_of(' '));
+	EXPECT_EQ(3, s.find_first_of(std::string(";, ")));
+	EXPECT_EQ(3, s.find_first_of(string_view(";, ")));
+	EXPECT_EQ(7, s.find_first_of(my_string(";"), 2));
+
+	EXPECT_EQ(3, s.find_first_not_of("abfor"));
+	EXPECT_EQ(1, s.find_first_not_of('f'));
+	EXPECT_EQ(0, s.find_first_not_of(""));
+	EXPECT_EQ(npos, s.find_first_not_of("abfor ;z"));
+
+	EXPECT_EQ(7, s.find_last_of(" ;"));
+	EXPECT_EQ(3, s.find_last_of(" ;", 6));
+	EXPECT_EQ(npos, s.find_last_of(" ;", 2));
+	EXPECT_EQ(10, s.find_last_of('z'));
+
+	EXPECT_EQ(7, s.find_last_not_of("abz"));
+	EXPECT_EQ(9, s.find_last_not_of('z'));
+	EXPECT_EQ(10, s.find_last_not_of(""));
+	EXPECT_EQ(npos, s.find_last_not_of("abfor ;z"));
+	EXPECT_EQ(npos, my_string().find_last_not_of("a"));
+}
+
+template <typename String>
+void check_find_of_against_std_string(const std::basic_string<typename String::value_type>& alphabet)
+{
+	using char_type = typename String::value_type;
+	using std_string = std::basic_string<char_type>;
+
+	unsigned state = 7;
+	auto next_char = [&]()
+	{
+		state = state * 1103515245u + 12345u;
+		return alphabet[(state >> 16) % alphabet.size()];
+	};
+
+	for (std::size_t size = 0; size <= String::max_size(); size += 3)
+	{
+		std_string str;
+		for (std::size_t i = 0; i < size; ++i)
+			str.push_back(next_char());
+		const String s(str.data(), str.size());
+
+		for (std::size_t set_size = 0; set_size <= 4; ++set_size)
+		{
+			std_string set;
+			for (std::size_t i = 0; i < set_size; ++i)
+				set.push_back(next_char());
+
+			for (std::size_t pos : {std::size_t(0), size / 2, size, String::npos})
+			{
+				EXPECT_EQ(str.find_first_of(set, pos), s.find_first_of(set.data(), pos, set.size()));
+				EXPECT_EQ(str.find_first_not_of(set, pos), s.find_first_not_of(set.data(), pos, set.size()));
+				EXPECT_EQ(str.find_last_of(set, pos), s.find_last_of(set.data(), pos, set.size()));
+				EXPECT_EQ(str.find_last_not_of(set, pos), s.find_last_not_of(set.data(), pos, set.size()));
+				EXPECT_EQ(str.rfind(set, pos), s.rfind(set.data(), pos, set.size()));
+
+				if (!set.empty())
+				{
+					EXPECT_EQ(str.rfind(set[0], pos), s.rfind(set[0], pos));
+				}
+			}
+		}
+	}
+}
+
+TEST(inplace_string, find_of_long)
+{
+	check_find_of_against_std_string<inplace_string<255>>(std::string("ab \t\x80\xff"));
+	check_find_of_against_std_string<inplace_string<20>>(std::string("abc"));
+	check_find_of_against_std_string<inplace_u16string<100>>(std::u16string(u"abĀš￿"));
+	check_find_of_against_std_string<inplace_u32string<40>>(std::u32string(U"ab\U0001F600"));
+}
+
+TEST(inplace_string, searcher)
+{
+	const inplace_string_searcher bar("bar");
+	EXPECT_EQ(3, bar.find(my_string("foobarbar")));
+	EXPECT_EQ(6, bar.find(my_string("foobarbar"), 4));
+	EXPECT_EQ(my_string::npos, bar.find(my_string("foobaz")));
+	EXPECT_TRUE(bar.contains(inplace_string<6>("foobar")));
+	EXPECT_FALSE(bar.contains(inplace_string<6>("foo")));
+
+	const inplace_string_searcher long_needle("barbazbarbaz");
+	EXPECT_EQ(12, long_needle.find(my_string("foobarbazbarbarbazbarbaz")));
+	EXPECT_EQ(my_string::npos, long_needle.find(my_string("foobarbazbarbarbazbar")));
+
+	const std::string str("foobarbazbarbarbazbarbaz");
+	auto res = std::search(str.begin(), str.end(), long_needle);
+	EXPECT_EQ(str.begin() + 12, res);
+
+	const my_string s("foobar");
+	EXPECT_EQ(s.begin() + 3, std::search(s.begin(), s.end(), bar));
+	EXPECT_EQ(s.begin(), std::search(s.begin(), s.end(), inplace_string_searcher("")));
+	EXPECT_EQ(s.end(), std::search(s.begin(), s.end(), inplace_string_searcher("baz")));
+
+	// Same results as member find and std::string on the edges
+	const inplace_string_searcher empty("");
+	EXPECT_EQ(s.find(""), empty.find(s));
+	EXPECT_EQ(s.find("", 4), empty.find(s, 4));
+	EXPECT_EQ(s.find("", 6), empty.find(s, 6));
+	EXPECT_EQ(s.find("", 7), empty.find(s, 7));
+	EXPECT_EQ(s.find("bar", 6), bar.find(s, 6));
+	EXPECT_EQ(my_string().find(""), empty.find(my_string()));
+	EXPECT_EQ(std::string("foobar").find("", 6), empty.find(s, 6));
+
+	const std::vector<char> chars(str.begin(), str.end());
+	EXPECT_EQ(chars.begin() + 12, std::search(chars.begin(), chars.end(), long_needle));
+
+	// std::search only accepts contiguous ranges
+	static_assert(detail::is_contiguous_iterator<const char*, char, std::char_traits<char>>::value, "pointer");
+	static_assert(detail::is_contiguous_iterator<std::string::const_iterator, char, std::char_traits<char>>::value, "std::string");
+	static_assert(!detail::is_contiguous_iterator<std::deque<char>::iterator, char, std::char_traits<char>>::value, "std::deque");
+	static_assert(!detail::is_contiguous_iterator<std::vector<int>::iterator, char, std::char_traits<char>>::value, "other characters");
+}
+
+template <typename String>
+void check_searcher_against_find()
+{
+	using char_type = typename String::value_type;
+	using std_string = std::basic_string<char_type>;
+
+	unsigned state = 3;
+	auto next_char = [&state]()
+	{
+		state = state * 1103515245u + 12345u;
+		return static_cast<char_type>((state >> 16) % 2 ? 'a' : (sizeof(char_type) == 1 ? 'b' : 0x161));
+	};
+
+	for (std::size_t needle_size = 1; needle_size <= 20; ++needle_size)
+	{
+		std_string needle;
+		for (std::size_t i = 0; i < needle_size; ++i)
+			needle.push_back(next_char());
+
+		const basic_inplace_string_searcher<char_type> searcher(needle);
+
+		for (std::size_t size = 0; size <= String::max_size(); size += 5)
+		{
+			std_string str;
+			for (std::size_t i = 0; i < size; ++i)
+				str.push_back(next_char());
+			const String s(str.data(), str.size());
+
+			EXPECT_EQ(s.find(needle.data(), 0, needle.size()), searcher.find(s));
+			EXPECT_EQ(s.find(needle.data(), size / 2, needle.size()), searcher.find(s, size / 2));
+		}
+	}
+}
+
+TEST(inplace_string, searcher_long)
+{
+	check_searcher_against_find<inplace_string<255>>();
+	check_searcher_against_find<inplace_u16string<100>>();
+	check_searcher_against_find<inplace_u32string<64>>();
+}
+
+template <typename String>
+static bool is_zero_padded(const String& s)
+{
+	for (std::size_t i = s.size(); i < s.max_size(); ++i)
+		if (s.data()[i] != typename String::value_type{})
+			return false;
+
+	return true;
+}
+
+TEST(inplace_string, zero_padded)
+{
+	using padded = zero_padded_inplace_string<31>;
+
+	{
+		padded s = "foobarbaz";
+		s.erase(3, 3);
+		EXPECT_EQ("foobaz", s);
+		EXPECT_TRUE(is_zero_padded(s));
+	}
+	{
+		padded s = "foobarbaz";
+		s.resize(2);
+		EXPECT_EQ("fo", s);
+		EXPECT_TRUE(is_zero_padded(s));
+		s.resize(5, 'x');
+		EXPECT_EQ("foxxx", s);
+		EXPECT_TRUE(is_zero_padded(s));
+	}
+	{
+		padded s = "foobar";
+		s.pop_back();
+		s.pop_back();
+		EXPECT_EQ("foob", s);
+		EXPECT_TRUE(is_zero_padded(s));
+	}
+	{
+		padded s = "foobarbaz";
+		s.replace(0, 6, "X");
+		EXPECT_EQ("Xbaz", s);
+		EXPECT_TRUE(is_zero_padded(s));
+		s.replace(1, 3, 1, 'y');
+		EXPECT_EQ("Xy", s);
+		EXPECT_TRUE(is_zero_padded(s));
+		s.replace(2, 6, "FOOBAR");
+		EXPECT_TRUE(is_zero_padded(s));
+	}
+	{
+		padded s = "foobarbaz";
+		s.clear();
+		EXPECT_TRUE(s.empty());
+		EXPECT_TRUE(is_zero_padded(s));
+	}
+	{
+		padded s(std::string("foobarbaz"), 3, 3);
+		EXPECT_EQ("bar", s);
+		EXPECT_TRUE(is_zero_padded(s));
+	}
+}
+
+TEST(inplace_string, zero_padded_compare)
+{
+	using padded = zero_padded_inplace_string<31>;
+
+	padded a = "foobarbaz";
+	padded b = "foo";
+	a.erase(3);
+	EXPECT_TRUE(a == b);
+	EXPECT_FALSE(a != b);
+	EXPECT_EQ(std::hash<padded>()(a), std::hash<padded>()(b));
+
+	b.push_back('x');
+	EXPECT_FALSE(a == b);
+	a.push_back('x');
+	EXPECT_TRUE(a == b);
+
+	padded c;
+	padded d = "a";
+	d.pop_back();
+	EXPECT_TRUE(c == d);
+	EXPECT_EQ(std::hash<padded>()(c), std::hash<padded>()(d));
+
+	zero_padded_inplace_string<7, char16_t> u = u"foobar";
+	zero_padded_inplace_string<7, char16_t> v = u"foo";
+	u.resize(3);
+	EXPECT_TRUE(u == v);
+
+	EXPECT_TRUE(a == my_string("foox"));
+}
+
+template <typename String>
+static void check_hash()
+{
+	using char_type = typename String::value_type;
+	const std::hash<String> hasher;
+
+	std::set<std::size_t> hashes;
+	for (std::size_t size = 0; size <= String::max_size(); ++size)
+	{
+		String s(size, char_type('a'));
+		String garbage(String::max_size(), char_type('z'));
+		garbage.resize(0);
+		garbage.append(size, char_type('a'));
+		EXPECT_EQ(hasher(s), hasher(garbage));
+
+		hashes.insert(hasher(s));
+		for (std::size_t i = 0; i < size; ++i)
+		{
+			String t = s;
+			t[i] = char_type('b');
+			hashes.insert(hasher(t));
+		}
+	}
+
+	const std::size_t max = String::max_size();
+	EXPECT_EQ(1 + max + max * (max + 1) / 2, hashes.size());
+}
+
+TEST(inplace_string, hash)
+{
+	check_hash<inplace_string<7>>();
+	check_hash<inplace_string<10>>();
+	check_hash<inplace_string<15>>();
+	check_hash<inplace_string<31>>();
+	check_hash<inplace_string<40>>();
+	check_hash<inplace_u16string<5>>();
+	check_hash<inplace_u32string<13>>();
+	check_hash<zero_padded_inplace_string<31>>();
+
+	inplace_string<15> s = "foo";
+	s.push_back('\0');
+	EXPECT_NE(std::hash<inplace_string<15>>()(s), std::hash<inplace_string<15>>()("foo"));
+
+	// every output bit has to be usable as a bucket index
+	std::size_t ones = 0;
+	for (int i = 0; i < 256; ++i)
+		ones |= std::hash<inplace_string<15>>()(inplace_string<15>(std::to_string(i)));
+	EXPECT_EQ(~std::size_t{0}, ones);
+}
+
+TEST(inplace_string, cached_hash)
+{
+	using cached = cached_hash_inplace_string<15>;
+	const std::hash<cached> hasher;
+	const auto expected = [](const char* str)
+	{
+		return std::hash<inplace_string<15>>()(inplace_string<15>(str));
+	};
+
+	cached s = "foobar";
+	EXPECT_EQ(expected("foobar"), hasher(s));
+	EXPECT_EQ(expected("foobar"), hasher(s));
+
+	s.append("baz");
+	EXPECT_EQ(expected("foobarbaz"), hasher(s));
+	s.erase(0, 3);
+	EXPECT_EQ(expected("barbaz"), hasher(s));
+	s.replace(0, 3, "BAR");
+	EXPECT_EQ(expected("BARbaz"), hasher(s));
+	s.insert(0, "x");
+	EXPECT_EQ(expected("xBARbaz"), hasher(s));
+	s.pop_back();
+	EXPECT_EQ(expected("xBARba"), hasher(s));
+	s.resize(2);
+	EXPECT_EQ(expected("xB"), hasher(s));
+	s[0] = 'y';
+	EXPECT_EQ(expected("yB"), hasher(s));
+	s.at(1) = 'z';
+	EXPECT_EQ(expected("yz"), hasher(s));
+	*s.begin() = 'a';
+	EXPECT_EQ(expected("az"), hasher(s));
+	s.data()[1] = 'b';
+	EXPECT_EQ(expected("ab"), hasher(s));
+	s.back() = 'c';
+	EXPECT_EQ(expected("ac"), hasher(s));
+	s.clear();
+	EXPECT_EQ(expected(""), hasher(s));
+
+	cached a = "foo";
+	cached b = "bar";
+	hasher(a);
+	hasher(b);
+	EXPECT_FALSE(a == b);
+	b = a;
+	EXPECT_TRUE(a == b);
+	b.swap(a);
+	EXPECT_EQ(expected("foo"), hasher(a));
+	EXPECT_EQ(expected("foo"), hasher(b));
+
+	cached c = "foo";
+	EXPECT_TRUE(a == c);
+	EXPECT_TRUE(c == a);
+
+	std::unordered_set<cached> set = {"foo", "bar", "baz"};
+	EXPECT_EQ(1u, set.count(c));
+	EXPECT_EQ(0u, set.count(cached("qux")));
+
+	// A pointer taken before hashing must not be written through: data() is called again after hashing,
+	// which drops the hash
+	cached d = "AAPL";
+	const cached e = "MSFT";
+	hasher(d);
+	hasher(e);
+	std::copy(e.begin(), e.end(), d.data());
+	EXPECT_TRUE(d == e);
+	EXPECT_EQ(hasher(e), hasher(d));
+}
+
+TEST(inplace_string, overflow_policy)
+{
+	using truncating = truncating_inplace_string<7>;
+	static_assert(sizeof(truncating) == sizeof(inplace_string<7>), "no storage for the truncating policy");
+
+	truncating s(string_view("ABCDEFGHIJ"));
+	EXPECT_EQ("ABCDEFG", s);
+	EXPECT_FALSE(s.overflowed());
+
+	s = "AB";
+	s.append("CDEFGHIJ");
+	EXPECT_EQ("ABCDEFG", s);
+	s.push_back('H');
+	EXPECT_EQ("ABCDEFG", s);
+	s.append(3, 'x');
+	EXPECT_EQ("ABCDEFG", s);
+
+	// Only the inserted characters that fit, the tail is kept
+	s = "AB";
+	s.insert(1, "0123456789");
+	EXPECT_EQ("A01234B", s);
+	s = "AB";
+	s.insert(std::size_t(1), 9, '-');
+	EXPECT_EQ("A-----B", s);
+	s = "AB";
+	const std::list<char> digits = {'1', '2', '3', '4', '5', '6'};
+	s.insert(s.begin() + 1, digits.begin(), digits.end());
+	EXPECT_EQ("A12345B", s);
+	s = "AB";
+	std::istringstream iss("123456");
+	s.insert(s.begin() + 1, std::istreambuf_iterator<char>(iss), std::istreambuf_iterator<char>());
+	EXPECT_EQ("A12345B", s);
+
+	s = "ABCDE";
+	s.replace(1, 1, "0123456789");
+	EXPECT_EQ("A012CDE", s);
+	s = "ABCDE";
+	s.replace(1, 1, 9, '-');
+	EXPECT_EQ("A---CDE", s);
+	s = "ABCDE";
+	s.replace(s.begin() + 1, s.begin() + 2, digits.begin(), digits.end());
+	EXPECT_EQ("A123CDE", s);
+
+	s = "AB";
+	s.resize(100, '.');
+	EXPECT_EQ("AB.....", s);
+
+	// Errors on positions still throw
+	EXPECT_THROW(s.insert(8, "x"), std::out_of_range);
+
+	using saturating = saturating_inplace_string<7>;
+	saturating t("ABC");
+	t.append("DEFG");
+	EXPECT_EQ("ABCDEFG", t);
+	EXPECT_FALSE(t.overflowed());
+	t.push_back('H');
+	EXPECT_EQ("ABCDEFG", t);
+	EXPECT_TRUE(t.overflowed());
+
+	// The flag sticks until cleared
+	t.erase(0, 4);
+	EXPECT_TRUE(t.overflowed());
+	saturating u = t;
+	EXPECT_TRUE(u.overflowed());
+	t.clear_overflow();
+	EXPECT_FALSE(t.overflowed());
+	t.swap(u);
+	EXPECT_TRUE(t.overflowed());
+	EXPECT_FALSE(u.overflowed());
+	t.clear();
+	EXPECT_FALSE(t.overflowed());
+
+	EXPECT_FALSE(saturating(string_view("ABCDEFG")).overflowed());
+	EXPECT_TRUE(saturating(string_view("ABCDEFGH")).overflowed());
+
+	using terminating = basic_inplace_string<7, char, std::char_traits<char>, inplace_string_terminating_policy>;
+	terminating v("ABCDEFG");
+	EXPECT_DEATH(v.push_back('H'), "");
+}
+
+template <typename String>
+static void check_register_compare()
+{
+	const char alphabet[] = {'\0', '\x01', 'a', 'b', '\x7f', '\x80', '\xff'};
+	unsigned state = 1;
+	const auto next = [&state](unsigned bound)
+	{
+		state = state * 1103515245u + 12345u;
+		return (state >> 16) % bound;
+	};
+
+	for (int i = 0; i < 20000; ++i)
+	{
+		std::string a, b;
+		for (unsigned j = next(String::max_size() + 1); j != 0; --j)
+			a.push_back(alphabet[next(sizeof(alphabet))]);
+		b = a.substr(0, next(static_cast<unsigned>(a.size()) + 1));
+		for (unsigned j = next(3); j != 0 && b.size() < String::max_size(); --j)
+			b.push_back(alphabet[next(sizeof(alphabet))]);
+
+		// garbage past the end of the strings must not be compared
+		String sa(String::max_size(), 'x'), sb(String::max_size(), 'y');
+		sa.resize(0);
+		sa.append(a.data(), a.size());
+		sb.resize(0);
+		sb.append(b.data(), b.size());
+
+		const int expected = a.compare(b);
+		const int cmp = sa.compare(sb);
+		EXPECT_EQ(expected < 0, cmp < 0);
+		EXPECT_EQ(expected == 0, cmp == 0);
+		EXPECT_EQ(expected > 0, cmp > 0);
+		EXPECT_EQ(a < b, sa < sb);
+		EXPECT_EQ(a == b, sa == sb);
+		EXPECT_EQ(b == a, sb == sa);
+
+		sa.swap(sb);
+		EXPECT_EQ(b, std::string(sa));
+		EXPECT_EQ(a, std::string(sb));
+	}
+}
+
+TEST(inplace_string, register_compare)
+{
+	check_register_compare<inplace_string<1>>();
+	check_register_compare<inplace_string<7>>();
+	check_register_compare<inplace_string<8>>();
+	check_register_compare<inplace_string<9>>();
+	check_register_compare<inplace_string<15>>();
+	check_register_compare<inplace_string<16>>();
+}
+
+TEST(inplace_flat_map, insert_find_erase)
+{
+	using map = inplace_flat_map<inplace_string<15>, int>;
+
+	map m;
+	EXPECT_TRUE(m.empty());
+	EXPECT_TRUE(m.find("foo") == m.end());
+	EXPECT_EQ(0u, m.erase("foo"));
+
+	EXPECT_TRUE(m.insert({"foo", 1}).second);
+	EXPECT_FALSE(m.insert({"foo", 2}).second);
+	EXPECT_TRUE(m.try_emplace("bar", 3).second);
+	m["baz"] = 4;
+	EXPECT_TRUE(m.insert_or_assign("foo", 5).first->second == 5);
+
+	EXPECT_EQ(3u, m.size());
+	EXPECT_EQ(5, m.at("foo"));
+	EXPECT_EQ(3, m.at(std::string("bar")));
+	EXPECT_EQ(4, m.at(string_view("baz")));
+	EXPECT_EQ(4, m.at(inplace_string<15>("baz")));
+	EXPECT_THROW(m.at("qux"), std::out_of_range);
+	EXPECT_EQ(1u, m.count("bar"));
+	EXPECT_FALSE(m.contains("a string longer than the keys"));
+
+	EXPECT_EQ(1u, m.erase("bar"));
+	EXPECT_FALSE(m.contains("bar"));
+	EXPECT_EQ(2u, m.size());
+
+	int sum = 0;
+	for (const auto& kv : m)
+		sum += kv.second;
+	EXPECT_EQ(9, sum);
+
+	const auto it = m.erase(m.find("foo"));
+	EXPECT_TRUE(it == m.end() || it->first == "baz");
+	EXPECT_EQ(1u, m.size());
+
+	m.clear();
+	EXPECT_TRUE(m.empty());
+	EXPECT_TRUE(m.begin() == m.end());
+}
+
+TEST(inplace_flat_map, against_unordered_map)
+{
+	using key = inplace_string<15>;
+	inplace_flat_map<key, std::string> m;
+	std::unordered_map<std::string, std::string> expected;
+
+	unsigned state = 1;
+	const auto next = [&state](unsigned bound)
+	{
+		state = state * 1103515245u + 12345u;
+		return (state >> 16) % bound;
+	};
+
+	for (int i = 0; i < 50000; ++i)
+	{
+		const std::string k = "key" + std::to_string(next(2000));
+		switch (next(3))
+		{
+			case 0:
+				EXPECT_EQ(expected.emplace(k, k).second, m.try_emplace(key(k), k).second);
+				break;
+			case 1:
+				EXPECT_EQ(expected.erase(k), m.erase(k));
+				break;
+			default:
+				EXPECT_EQ(expected.count(k), m.count(k));
+				break;
+		}
+	}
+
+	ASSERT_EQ(expected.size(), m.size());
+	EXPECT_LE(m.load_factor(), m.max_load_factor());
+
+	std::size_t visited = 0;
+	for (const auto& kv : m)
+	{
+		EXPECT_EQ(std::string(kv.first), kv.second);
+		EXPECT_EQ(1u, expected.count(kv.second));
+		++visited;
+	}
+	EXPECT_EQ(expected.size(), visited);
+
+	const auto copy = m;
+	EXPECT_EQ(m.size(), copy.size());
+	for (const auto& kv : expected)
+		EXPECT_EQ(kv.second, copy.at(kv.first));
+
+	auto moved = std::move(m);
+	EXPECT_EQ(copy.size(), moved.size());
+	EXPECT_TRUE(m.empty());
+	m = moved;
+	EXPECT_EQ(moved.size(), m.size());
+}
+
+TEST(inplace_flat_map, reserve)
+{
+	inplace_flat_map<inplace_u16string<7>, int> m(1000);
+	const std::size_t capacity = m.capacity();
+	EXPECT_GE(capacity * 7 / 8, 1000u);
+
+	for (int i = 0; i < 1000; ++i)
+		m[inplace_u16string<7>(static_cast<std::size_t>(i % 7) + 1, static_cast<char16_t>(0x4e00 + i))] = i;
+
+	EXPECT_EQ(1000u, m.size());
+	EXPECT_EQ(capacity, m.capacity());
+	EXPECT_EQ(42, m.at(inplace_u16string<7>(42 % 7 + 1, static_cast<char16_t>(0x4e00 + 42))));
+}
+
+TEST(inplace_string_interner, intern)
+{
+	inplace_string_interner<15> interner;
+	EXPECT_TRUE(interner.empty());
+	EXPECT_EQ(interner.invalid_id, interner.find("foo"));
+
+	EXPECT_EQ(0u, interner.intern("foo"));
+	EXPECT_EQ(1u, interner.intern(std::string("bar")));
+	EXPECT_EQ(0u, interner.intern(inplace_string<15>("foo")));
+	EXPECT_EQ(2u, interner.intern(string_view("baz")));
+	EXPECT_THROW(interner.intern("a string longer than the keys"), std::length_error);
+
+	EXPECT_EQ(3u, interner.size());
+	EXPECT_EQ(1u, interner.find("bar"));
+	EXPECT_TRUE(interner.contains("baz"));
+	EXPECT_FALSE(interner.contains("qux"));
+
+	EXPECT_EQ("foo", interner[0]);
+	EXPECT_EQ("bar", interner.at(1));
+	EXPECT_EQ("baz", interner.data()[2]);
+	EXPECT_THROW(interner.at(3), std::out_of_range);
+
+	std::vector<std::string> strings(interner.begin(), interner.end());
+	EXPECT_EQ((std::vector<std::string>{"foo", "bar", "baz"}), strings);
+}
+
+TEST(inplace_string_interner, frozen)
+{
+	inplace_string_interner<15> interner(1000);
+	for (int i = 0; i < 1000; ++i)
+		EXPECT_EQ(static_cast<std::uint32_t>(i), interner.intern("name" + std::to_string(i)));
+
+	interner.freeze();
+	EXPECT_TRUE(interner.frozen());
+	EXPECT_EQ(42u, interner.intern("name42"));
+	EXPECT_THROW(interner.intern("name1000"), std::logic_error);
+	EXPECT_EQ(1000u, interner.size());
+
+	// read path: concurrent lookups in both directions
+	std::vector<std::thread> readers;
+	std::vector<int> errors(4);
+	for (std::size_t t = 0; t < errors.size(); ++t)
+	{
+		readers.emplace_back([&interner, &errors, t]
+		{
+			for (std::uint32_t id = 0; id < 1000; ++id)
+			{
+				const auto& name = interner[id];
+				errors[t] += interner.intern(name) != id;
+				errors[t] += interner.find(string_view(name)) != id;
+			}
+		});
+	}
+
+	for (auto& reader : readers)
+		reader.join();
+
+	EXPECT_EQ((std::vector<int>{0, 0, 0, 0}), errors);
+}
+
+template <typename Column>
+static void check_column()
+{
+	std::vector<std::string> strings;
+	unsigned state = 1;
+	for (int i = 0; i < 1000; ++i)
+	{
+		state = state * 1103515245u + 12345u;
+		std::string str;
+		for (unsigned j = (state >> 16) % (Column::max_length() + 1); j != 0; --j)
+		{
+			state = state * 1103515245u + 12345u;
+			str.push_back("ab\0"[(state >> 16) % 3]);
+		}
+		strings.push_back(str);
+	}
+
+	const Column column(strings.begin(), strings.end());
+	ASSERT_EQ(strings.size(), column.size());
+	for (std::size_t i = 0; i < strings.size(); ++i)
+	{
+		EXPECT_EQ(strings[i], std::string(column[i]));
+		EXPECT_EQ(strings[i].size(), column.length(i));
+	}
+
+	const auto expected_filter = [&strings](auto pred)
+	{
+		std::vector<std::size_t> indices;
+		for (std::size_t i = 0; i < strings.size(); ++i)
+			if (pred(strings[i]))
+				indices.push_back(i);
+		return indices;
+	};
+
+	std::vector<std::size_t> indices;
+	column.filter_length(2, 5, std::back_inserter(indices));
+	EXPECT_EQ(expected_filter([](const std::string& s) { return s.size() >= 2 && s.size() <= 5; }), indices);
+
+	for (const std::string& needle : {std::string(), std::string("a"), std::string("ab"), std::string("ba\0", 3), strings[7], strings[500]})
+	{
+		indices.clear();
+		column.filter_equal(needle, std::back_inserter(indices));
+		const auto equal = expected_filter([&needle](const std::string& s) { return s == needle; });
+		EXPECT_EQ(equal, indices);
+		EXPECT_EQ(equal.size(), column.count(needle));
+		EXPECT_EQ(equal.empty() ? Column::npos : equal.front(), column.find(needle));
+		if (equal.size() > 1)
+		{
+			EXPECT_EQ(equal[1], column.find(needle, equal[0] + 1));
+		}
+
+		indices.clear();
+		column.filter_prefix(needle, std::back_inserter(indices));
+		EXPECT_EQ(expected_filter([&needle](const std::string& s) { return s.compare(0, needle.size(), needle) == 0; }), indices);
+	}
+
+	indices.clear();
+	column.filter([](string_view s) { return s.find('b') != string_view::npos; }, std::back_inserter(indices));
+	EXPECT_EQ(expected_filter([](const std::string& s) { return s.find('b') != std::string::npos; }), indices);
+
+	EXPECT_EQ(Column::npos, column.find(std::string(Column::max_length() + 1, 'a')));
+}
+
+TEST(inplace_string_column, kernels)
+{
+	check_column<inplace_string_column<5>>();
+	check_column<inplace_string_column<31>>();
+	check_column<inplace_string_prefix_column<5>>();
+	check_column<inplace_string_prefix_column<31>>();
+	check_column<basic_inplace_string_column<300, char, std::char_traits<char>, true>>();
+}
+
+TEST(inplace_string_column, modifiers)
+{
+	inplace_string_prefix_column<15> column;
+	column.push_back("foo");
+	column.push_back(inplace_string<15>("barbazquxquux"));
+	EXPECT_THROW(column.push_back("a string longer than the keys"), std::length_error);
+	EXPECT_EQ(2u, column.size());
+
+	column.set(0, "a");
+	EXPECT_EQ("a", column.at(0));
+	EXPECT_EQ(inplace_string<15>("barbazquxquux"), column.get(1));
+	EXPECT_EQ(0u, column.find("a"));
+	EXPECT_EQ(column.npos, column.find("foo"));
+	EXPECT_THROW(column.set(2, "b"), std::out_of_range);
+	EXPECT_THROW(column.at(2), std::out_of_range);
+
+	column.pop_back();
+	EXPECT_EQ(1u, column.size());
+	EXPECT_EQ(column.npos, column.find("barbazquxquux"));
+
+	column.clear();
+	EXPECT_TRUE(column.empty());
+}
+
+// Traits comparing ASCII letters regardless of case
+struct case_insensitive_traits : std::char_traits<char>
+{
+	static char fold(char c) noexcept { return c >= 'a' && c <= 'z' ? static_cast<char>(c - 'a' + 'A') : c; }
+
+	static bool eq(char a, char b) noexcept { return fold(a) == fold(b); }
+	static bool lt(char a, char b) noexcept { return fold(a) < fold(b); }
+
+	static int compare(const char* a, const char* b, std::size_t count) noexcept
+	{
+		for (std::size_t i = 0; i != count; ++i)
+			if (!eq(a[i], b[i]))
+				return lt(a[i], b[i]) ? -1 : 1;
+		return 0;
+	}
+
+	static const char* find(const char* str, std::size_t count, char ch) noexcept
+	{
+		for (std::size_t i = 0; i != count; ++i)
+			if (eq(str[i], ch))
+				return str + i;
+		return nullptr;
+	}
+};
+
+TEST(inplace_string_column, custom_traits)
+{
+	// The prefix column compares bitwise: it is bypassed for traits that do not
+	basic_inplace_string_column<15, char, case_insensitive_traits, true> column;
+	column.push_back("AAPL");
+	column.push_back("msft");
+	column.push_back("GooGLEinc");
+
+	EXPECT_EQ(0u, column.find("aapl"));
+	EXPECT_EQ(1u, column.count("MSFT"));
+	EXPECT_EQ(2u, column.find("googleINC"));
+
+	std::vector<std::size_t> rows;
+	column.filter_equal("Msft", std::back_inserter(rows));
+	EXPECT_EQ(std::vector<std::size_t>{1}, rows);
+
+	rows.clear();
+	column.filter_prefix("GOOG", std::back_inserter(rows));
+	EXPECT_EQ(std::vector<std::size_t>{2}, rows);
+
+	rows.clear();
+	column.filter_prefix("googlein", std::back_inserter(rows));
+	EXPECT_EQ(std::vector<std::size_t>{2}, rows);
+}
+
+TEST(inplace_string, hash_custom_traits)
+{
+	// Equal strings would hash differently under traits that do not compare bitwise: their hash is disabled
+	using folded = basic_inplace_string<15, char, case_insensitive_traits>;
+	EXPECT_TRUE(folded("AAPL") == folded("aapl"));
+	static_assert(!std::is_default_constructible<std::hash<folded>>::value, "disabled hash");
+	static_assert(!std::is_copy_constructible<std::hash<folded>>::value, "disabled hash");
+	static_assert(std::is_default_constructible<std::hash<inplace_string<15>>>::value, "enabled hash");
+	static_assert(std::is_default_constructible<std::hash<cached_hash_inplace_string<15>>>::value, "enabled hash");
+}
+
+// Strings of 0 to N characters over a small alphabet, with long common prefixes and many duplicates
+template <typename String>
+static std::vector<String> make_sort_keys(std::size_t count)
+{
+	using char_type = typename String::value_type;
+
+	std::vector<String> keys;
+	unsigned seed = 7;
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		seed = seed * 1103515245u + 12345u;
+		String key;
+		if (i % 3 == 0)
+			key.append(String::max_size() / 2, static_cast<char_type>('x'));
+		for (std::size_t j = (seed >> 16) % (String::max_size() - key.size() + 1); j != 0; --j)
+		{
+			seed = seed * 1103515245u + 12345u;
+			key.push_back(static_cast<char_type>((seed >> 16) % 4 == 0 ? 0xe9 : 'a' + (seed >> 16) % 3));
+		}
+		keys.push_back(key);
+	}
+
+	return keys;
+}
+
+template <typename String>
+static void check_sort()
+{
+	for (const std::size_t count : {0, 1, 2, 31, 33, 1000, 20000})
+	{
+		auto keys = make_sort_keys<String>(count);
+		auto expected = keys;
+		std::sort(expected.begin(), expected.end());
+
+		auto sorted = keys;
+		inplace_string_sort(sorted.begin(), sorted.end());
+		EXPECT_EQ(expected, sorted);
+
+		sorted = keys;
+		inplace_string_stable_sort(sorted.data(), sorted.data() + sorted.size());
+		EXPECT_EQ(expected, sorted);
+	}
+}
+
+TEST(inplace_string_algorithm, sort)
+{
+	check_sort<inplace_string<1>>();
+	check_sort<inplace_string<7>>();
+	check_sort<inplace_string<31>>();
+	check_sort<basic_inplace_string<255, unsigned char>>();
+	check_sort<cached_hash_inplace_string<15>>();
+	check_sort<zero_padded_inplace_string<15>>();
+	check_sort<inplace_u16string<15>>();
+}
+
+TEST(inplace_string_algorithm, sort_by_key)
+{
+	struct record
+	{
+		inplace_string<15> symbol;
+		std::size_t sequence;
+	};
+
+	const auto symbols = make_sort_keys<inplace_string<15>>(5000);
+	std::vector<record> records;
+	for (std::size_t i = 0; i < symbols.size(); ++i)
+		records.push_back({symbols[i], i});
+
+	const auto key = [](const record& r) -> const inplace_string<15>& { return r.symbol; };
+	const auto less = [](const record& lhs, const record& rhs) { return lhs.symbol < rhs.symbol; };
+
+	auto expected = records;
+	std::stable_sort(expected.begin(), expected.end(), less);
+
+	auto sorted = records;
+	inplace_string_stable_sort(sorted.begin(), sorted.end(), key);
+	for (std::size_t i = 0; i < sorted.size(); ++i)
+	{
+		EXPECT_EQ(expected[i].symbol, sorted[i].symbol);
+		EXPECT_EQ(expected[i].sequence, sorted[i].sequence);
+	}
+
+	sorted = records;
+	inplace_string_sort(sorted.begin(), sorted.end(), key);
+	EXPECT_TRUE(std::is_sorted(sorted.begin(), sorted.end(), less));
+	EXPECT_TRUE(std::is_permutation(sorted.begin(), sorted.end(), records.begin(),
+		[](const record& lhs, const record& rhs) { return lhs.sequence == rhs.sequence && lhs.symbol == rhs.symbol; }));
+}
+
+template <typename String>
+static void check_parallel_sort(std::size_t count)
+{
+	const auto keys = make_sort_keys<String>(count);
+	auto expected = keys;
+	std::sort(expected.begin(), expected.end());
+
+	for (const unsigned threads : {0u, 1u, 3u, 8u})
+	{
+		auto sorted = keys;
+		inplace_string_parallel_sort(threads, sorted.begin(), sorted.end());
+		EXPECT_EQ(expected, sorted);
+	}
+}
+
+TEST(inplace_string_algorithm, parallel_sort)
+{
+	check_parallel_sort<inplace_string<7>>(0);
+	check_parallel_sort<inplace_string<7>>(1000);
+	check_parallel_sort<inplace_string<7>>(200000);
+	check_parallel_sort<inplace_string<31>>(200000);
+	check_parallel_sort<inplace_u16string<15>>(100000);
+
+	// Common prefix first, then one bucket larger than a thread's share
+	std::vector<inplace_string<15>> ids;
+	for (std::size_t i = 0; i < 100000; ++i)
+		ids.push_back(inplace_string<15>("ORDER-" + std::to_string(i % 7 == 0 ? i : 500000 + i % 1000)));
+	auto expected = ids;
+	std::sort(expected.begin(), expected.end());
+	inplace_string_parallel_sort(4, ids.begin(), ids.end());
+	EXPECT_EQ(expected, ids);
+}
+
+TEST(inplace_string_algorithm, parallel_sort_by_key)
+{
+	struct record
+	{
+		inplace_string<15> symbol;
+		std::size_t sequence;
+	};
+
+	const auto symbols = make_sort_keys<inplace_string<15>>(100000);
+	std::vector<record> records;
+	for (std::size_t i = 0; i < symbols.size(); ++i)
+		records.push_back({symbols[i], i});
+
+	auto expected = records;
+	std::stable_sort(expected.begin(), expected.end(), [](const record& lhs, const record& rhs) { return lhs.symbol < rhs.symbol; });
+
+	inplace_string_parallel_sort(4, records.begin(), records.end(), [](const record& r) -> const inplace_string<15>& { return r.symbol; });
+	for (std::size_t i = 0; i < records.size(); ++i)
+	{
+		EXPECT_EQ(expected[i].symbol, records[i].symbol);
+		EXPECT_EQ(expected[i].sequence, records[i].sequence);
+	}
+}
+
+TEST(inplace_string_algorithm, parallel_unique_count)
+{
+	for (const std::size_t count : {0, 1, 1000, 200000})
+	{
+		auto keys = make_sort_keys<inplace_string<7>>(count);
+		std::sort(keys.begin(), keys.end());
+
+		std::vector<std::pair<inplace_string<7>, std::size_t>> expected_counts;
+		for (const auto& key : keys)
+		{
+			if (expected_counts.empty() || expected_counts.back().first != key)
+				expected_counts.emplace_back(key, 0);
+			++expected_counts.back().second;
+		}
+
+		auto expected = keys;
+		expected.erase(std::unique(expected.begin(), expected.end()), expected.end());
+
+		for (const unsigned threads : {1u, 3u, 8u})
+		{
+			std::vector<std::pair<inplace_string<7>, std::size_t>> counts;
+			inplace_string_parallel_count_by_key(threads, keys.begin(), keys.end(), std::back_inserter(counts));
+			EXPECT_EQ(expected_counts, counts);
+
+			auto unique = keys;
+			unique.erase(inplace_string_parallel_unique(threads, unique.begin(), unique.end()), unique.end());
+			EXPECT_EQ(expected, unique);
+		}
+	}
+
+	// One key spanning every chunk
+	std::vector<inplace_string<7>> same(100000, "AAPL");
+	same.push_back("MSFT");
+	std::vector<std::pair<inplace_string<7>, std::size_t>> counts;
+	inplace_string_parallel_count_by_key(4, same.begin(), same.end(), std::back_inserter(counts));
+	ASSERT_EQ(2u, counts.size());
+	EXPECT_EQ(100000u, counts[0].second);
+	same.erase(inplace_string_parallel_unique(4, same.begin(), same.end()), same.end());
+	EXPECT_EQ((std::vector<inplace_string<7>>{"AAPL", "MSFT"}), same);
+
+	// Records are never move-assigned to themselves: with no duplicates before a chunk, it stays in place
+	struct record
+	{
+		inplace_string<7> symbol;
+		std::string payload;
+		int* self_moves;
+
+		record(const std::string& s, int* counter) : symbol(s), payload(s), self_moves(counter) {}
+		record(record&&) = default;
+		record& operator=(record&& other)
+		{
+			*self_moves += this == &other;
+			symbol = other.symbol;
+			payload = std::move(other.payload);
+			return *this;
+		}
+	};
+	const auto symbol_of = [](const record& r) -> const inplace_string<7>& { return r.symbol; };
+
+	int self_moves = 0;
+	std::vector<record> records;
+	for (std::size_t i = 0; i != 100000; ++i)
+		records.emplace_back(std::to_string(1000000 + (i < 50000 ? i : 50000 + (i - 50000) / 2)).substr(1), &self_moves);
+	records.erase(inplace_string_parallel_unique(4, records.begin(), records.end(), symbol_of), records.end());
+	ASSERT_EQ(75000u, records.size());
+	EXPECT_EQ("049999", records[49999].payload);
+	EXPECT_EQ("050000", records[50000].payload);
+	EXPECT_EQ("074999", records.back().payload);
+	EXPECT_EQ(0, self_moves);
+}
+
+TEST(inplace_stringbuf, ostringstream)
+{
+	inplace_ostringstream<31> os;
+	os << "NEW " << inplace_string<7>("AAPL") << " qty=" << 100 << " px=" << std::fixed << std::setprecision(2) << 187.25;
+	EXPECT_TRUE(os.good());
+	EXPECT_EQ("NEW AAPL qty=100 px=187.25", os.view());
+	EXPECT_EQ(inplace_string<31>("NEW AAPL qty=100 px=187.25"), os.str());
+	EXPECT_EQ(26u, os.str().size());
+
+	// Output is appended to the initial contents
+	inplace_ostringstream<15> prefixed(inplace_string<15>("ORD-"));
+	prefixed << std::setw(6) << std::setfill('0') << 42;
+	EXPECT_EQ("ORD-000042", prefixed.view());
+	prefixed.put('-').write("XNAS", 4);
+	EXPECT_EQ("ORD-000042-XNAS", prefixed.view());
+	prefixed.str("ID-");
+	prefixed << 7;
+	EXPECT_EQ("ID-7", prefixed.str());
+
+	// Default policy: the write that does not fit is dropped and the stream goes bad
+	inplace_ostringstream<7> full;
+	full << "1234" << "5678";
+	EXPECT_TRUE(full.bad());
+	EXPECT_EQ("1234", full.view());
+	full.clear();
+	full << "567" << 'x';
+	EXPECT_TRUE(full.bad());
+	EXPECT_EQ("1234567", full.str());
+
+	full.clear();
+	full.exceptions(std::ios_base::badbit);
+	EXPECT_THROW(full << 8, std::ios_base::failure);
+
+	// Truncating policy: the characters that fit are kept and the stream stays good
+	inplace_ostringstream<7, inplace_string_truncating_policy> truncated;
+	truncated << "1234" << 5678 << 'x' << "yz";
+	EXPECT_TRUE(truncated.good());
+	EXPECT_EQ("1234567", truncated.str());
+
+	inplace_ostringstream<7, inplace_string_saturating_policy> saturated;
+	saturated << "12345";
+	EXPECT_FALSE(saturated.str().overflowed());
+	saturated << "678";
+	EXPECT_TRUE(saturated.good());
+	EXPECT_EQ("1234567", saturated.str());
+	EXPECT_TRUE(saturated.str().overflowed());
+
+	// Zero padding holds in the copies
+	basic_inplace_ostringstream<15, char, std::char_traits<char>, inplace_string_zero_padded_policy> padded;
+	padded << "abcdef";
+	padded.str("ab");
+	padded << 'c';
+	EXPECT_EQ(zero_padded_inplace_string<15>("abc"), padded.str());
+
+	inplace_wostringstream<15> wos;
+	wos << L"qty=" << 25;
+	EXPECT_EQ(L"qty=25", wos.str());
+}
+
+TEST(inplace_stringbuf, istringstream)
+{
+	inplace_istringstream<31> is("AAPL 100 187.25\nXNAS");
+	inplace_string<7> symbol;
+	int qty = 0;
+	double px = 0;
+	is >> symbol >> qty >> px;
+	EXPECT_TRUE(is.good());
+	EXPECT_EQ("AAPL", symbol);
+	EXPECT_EQ(100, qty);
+	EXPECT_EQ(187.25, px);
+
+	is.ignore();
+	std::string venue;
+	std::getline(is, venue);
+	EXPECT_EQ("XNAS", venue);
+	EXPECT_TRUE(is.eof());
+	EXPECT_EQ("AAPL 100 187.25\nXNAS", is.view());
+
+	// Reading back what was written through the same buffer
+	inplace_stringbuf<15> buf;
+	std::ostream os(&buf);
+	std::istream in(&buf);
+	os << 12 << ' ';
+	int a = 0, b = 0;
+	in >> a;
+	EXPECT_EQ(12, a);
+	os << 34;
+	in >> b;
+	EXPECT_EQ(34, b);
+	EXPECT_EQ("12 34", buf.view());
+
+	inplace_wistringstream<15> wis(L"wide 42");
+	std::wstring word;
+	int n = 0;
+	wis >> word >> n;
+	EXPECT_EQ(L"wide", word);
+	EXPECT_EQ(42, n);
+}
+
+TEST(inplace_string, concatenation)
+{
+	const inplace_string<7> symbol("AAPL"), venue("XNAS"), empty;
+
+	const inplace_string<19> id = "ORD-" + symbol + '-' + venue;
+	EXPECT_EQ("ORD-AAPL-XNAS", id);
+	EXPECT_EQ(13u, id.size());
+	static_assert(decltype("ORD-" + symbol + '-' + venue)::capacity == 19, "capacities add up");
+	static_assert(std::is_same<decltype((symbol + venue).str()), inplace_string<14>>::value, "capacities add up");
+
+	EXPECT_EQ("AAPLXNAS", (symbol + venue).str());
+	EXPECT_EQ("AAPL", (symbol + empty).str());
+	EXPECT_EQ("AAPL", (empty + symbol).str());
+	EXPECT_EQ("", (empty + empty).str());
+	EXPECT_EQ("AAPL!", (symbol + '!').str());
+	EXPECT_EQ("$AAPL", ('$' + symbol).str());
+	EXPECT_EQ("AAPL", (symbol + "").str());
+	EXPECT_EQ("AAPL-XNAS", (symbol + ('-' + venue)).str());
+
+	// An array operand is a string up to its first null character, the rest of a buffer is not part of it
+	char buf[8] = "ab";
+	EXPECT_EQ(3u, (inplace_string<7>("x") + buf).str().size());
+	EXPECT_EQ("xab", (inplace_string<7>("x") + buf).str());
+	EXPECT_EQ("abx", (buf + inplace_string<7>("x")).str());
+	static_assert(decltype(inplace_string<7>("x") + buf)::capacity == 14, "the capacity is that of the array");
+	const char unterminated[4] = {'a', 'b', 'c', 'd'};
+	EXPECT_EQ("xabc", (inplace_string<7>("x") + unterminated).str());
+	EXPECT_EQ("AAPLXNASAAPLXNAS", ((symbol + venue) + (symbol + venue)).str());
+
+	// Into a larger string, and by assignment
+	inplace_string<31> larger = symbol + venue;
+	EXPECT_EQ("AAPLXNAS", larger);
+	larger = venue + ':' + symbol;
+	EXPECT_EQ("XNAS:AAPL", larger);
+
+	// Full pieces: the result is full too
+	const inplace_string<3> full("abc");
+	const inplace_string<6> both = full + full;
+	EXPECT_EQ("abcabc", both);
+	EXPECT_EQ(both.max_size(), both.size());
+
+	// Padding follows the policy of the string built
+	zero_padded_inplace_string<31> padded("garbage after the end");
+	padded = symbol + venue;
+	EXPECT_EQ("AAPLXNAS", padded);
+	EXPECT_TRUE(is_zero_padded(padded));
+	EXPECT_EQ(zero_padded_inplace_string<31>("AAPLXNAS"), padded);
+
+	EXPECT_EQ(u"wide string", (inplace_u16string<4>(u"wide") + u' ' + inplace_u16string<6>(u"string")).str());
+}
+
+// The remaining size is stored in a char, negative past 127
+TEST(inplace_string, empty_large)
+{
+	inplace_string<200> s;
+	EXPECT_TRUE(s.empty());
+	s.append(150, 'a');
+	EXPECT_FALSE(s.empty());
+	EXPECT_EQ(150u, s.size());
+}
+
+#if INPLACE_STRING_HAS_CONSTEXPR
+// Evaluated at compile time: a failure is a compile error. Strings are built in constexpr functions or
+// variables, as GCC rejects some pointer comparisons into temporaries of a static_assert.
+namespace constexpr_test
+{
+
+constexpr inplace_string<15> fx_pair()
+{
+	inplace_string<15> s("EUR");
+	s.append("/USD");
+	s.insert(0, "FX:");
+	s.replace(3, 3, "GBP");
+	s.erase(0, 3);
+	return s;
+}
+
+constexpr inplace_string<15> pair = fx_pair();
+static_assert(pair == "GBP/USD");
+static_assert(pair.size() == 7 && !pair.empty());
+static_assert(pair.compare("GBP/USE") < 0 && pair.compare(inplace_string<15>("GBP/USD")) == 0);
+static_assert(pair < inplace_string<15>("GBP/USE") && pair != inplace_string<15>("GBP"));
+static_assert(pair.find('/') == 3 && pair.find("USD") == 4 && pair.find("JPY") == inplace_string<15>::npos);
+static_assert(pair.rfind('D') == 6 && pair.rfind("S") == 5);
+static_assert(pair.find_first_of("/U") == 3 && pair.find_first_not_of("GBP") == 3);
+static_assert(pair.find_last_of("GB") == 1 && pair.find_last_not_of("DSU") == 3);
+static_assert(pair.substr(4) == "USD" && pair.substr(0, 3) == inplace_string<15>("GBP"));
+static_assert(pair.front() == 'G' && pair.back() == 'D' && pair[3] == '/');
+
+constexpr inplace_string<7> built(std::size_t which)
+{
+	switch (which)
+	{
+	case 0: return inplace_string<7>(3, 'x');
+	case 1: return inplace_string<7>("abcdef", 4);
+	case 2: return inplace_string<7>(std::string_view("view"));
+	case 3: return inplace_string<7>({'i', 'l'});
+	default: return inplace_string<7>();
+	}
+}
+
+constexpr inplace_string<7> built0 = built(0), built1 = built(1), built2 = built(2), built3 = built(3), built4 = built(4);
+static_assert(built0 == "xxx" && built1 == "abcd" && built2 == "view" && built3 == "il" && built4.empty());
+
+constexpr inplace_string<7> mutated()
+{
+	inplace_string<7> a("abc"), b("de");
+	a.swap(b);
+	a.push_back('f');
+	a.resize(5, 'g');
+	a.insert(a.begin(), 'z');
+	a.replace(a.begin(), a.begin() + 1, "yy");
+	a.erase(a.end() - 1);
+	a.pop_back();
+	return a;
+}
+
+constexpr inplace_string<7> mutated_string = mutated();
+static_assert(mutated_string == "yydef");
+
+constexpr inplace_string<7> filled()
+{
+	inplace_string<7> a("ab");
+	a.resize_and_overwrite(4, [](char* buf, std::size_t) { buf[2] = 'c'; return 3; });
+	const auto span = a.prepare_append();
+	span.data[0] = 'd';
+	a.commit_append(1);
+	return a;
+}
+
+static_assert(filled() == "abcd");
+
+// Above 255 characters, the size is in a trailer
+constexpr inplace_string<320> long_line = inplace_string<300>(280, '=') + inplace_string<7>("|10=042");
+static_assert(long_line.size() == 287 && long_line.find('|') == 280);
+
+constexpr inplace_string<19> order_id = "ORD-" + inplace_string<7>("AAPL") + '-' + inplace_string<7>("XNAS");
+static_assert(order_id == "ORD-AAPL-XNAS" && order_id.max_size() == 19);
+
+// A lookup table built by the compiler
+constexpr std::array<zero_padded_inplace_string<7>, 3> venues = {{"XNAS", "XNYS", "BATS"}};
+static_assert(venues[2] == zero_padded_inplace_string<7>("BATS"));
+
+constexpr inplace_u16string<7> wide = u"wide";
+static_assert(wide.find(u'd') == 2 && wide.compare(u"wider") < 0);
+
+}
+
+TEST(inplace_string, constexpr)
+{
+	EXPECT_EQ(constexpr_test::fx_pair(), constexpr_test::pair);
+	EXPECT_EQ(constexpr_test::mutated(), constexpr_test::mutated_string);
+	EXPECT_EQ("XNYS", constexpr_test::venues[1]);
+}
+#endif